@@ -5,25 +5,6 @@ namespace scottz0r
 {
 namespace gps
 {
-
-    /// @brief Returns true if the given bit flag is set in integral type x.
-    template <typename _T, typename _F> inline bool is_flag_set(_T x, _F flag)
-    {
-        return (x & (_T)flag) > 0;
-    }
-
-    /// @brief Set the given bit flag on the integral type x.
-    template <typename _T, typename _F> inline _T set_flag(_T x, _F flag)
-    {
-        return x | (_T)flag;
-    }
-
-    /// @brief Clear the given bit flag on the integral type x.
-    template <typename _T, typename _F> inline _T clear_flag(_T x, _F flag)
-    {
-        return x & (~((_T)flag));
-    }
-
     namespace _detail
     {
         /// @brief Convert a base 16 ASCII character into an char/integer.
@@ -47,6 +28,40 @@ namespace gps
             }
         }
 
+        /// @brief Convert the two character talker prefix of an NMEA address field into a Talker.
+        Talker parse_talker(char first, char second)
+        {
+            if (first == 'G')
+            {
+                switch (second)
+                {
+                case 'P':
+                    return Talker::GPS;
+                case 'L':
+                    return Talker::GLONASS;
+                case 'A':
+                    return Talker::Galileo;
+                case 'B':
+                    return Talker::BeiDou;
+                case 'Q':
+                    return Talker::QZSS;
+                case 'I':
+                    return Talker::NavIC;
+                case 'N':
+                    return Talker::GNSS;
+                default:
+                    return Talker::Unknown;
+                }
+            }
+
+            if (first == 'B' && second == 'D')
+            {
+                return Talker::BeiDou;
+            }
+
+            return Talker::Unknown;
+        }
+
         /// @brief Checks string equality with character arrays. Behavior is undefined is character array is not null
         /// terminated.Returns false if either input is null.
         bool string_equals(const char *lhs, const char *rhs)
@@ -170,6 +185,195 @@ namespace gps
             return result;
         }
 
+        /// @brief Converts an ASCII character array into a double. Digits are collected into an integer mantissa and
+        /// scaled by a single division, so up to 15 significant digits convert without accumulated rounding. Behavior
+        /// is undefined is character array is not null terminated.
+        double string_to_double(const char *val)
+        {
+            if (!val)
+            {
+                return 0.0;
+            }
+
+            double mantissa = 0.0;
+            double scale = 1.0;
+            bool found_dot = false;
+            bool is_negative = false;
+
+            // Handle negative and plus signs.
+            if (*val == '-' || *val == '+')
+            {
+                is_negative = *val == '-';
+                ++val;
+            }
+
+            while (*val != 0)
+            {
+                if (is_digit(*val))
+                {
+                    mantissa *= 10.0;
+                    mantissa += to_digit(*val);
+
+                    if (found_dot)
+                    {
+                        scale *= 10.0;
+                    }
+                }
+                else if (*val == '.' && !found_dot)
+                {
+                    found_dot = true;
+                }
+                else
+                {
+                    break;
+                }
+                ++val;
+            }
+
+            double result = mantissa / scale;
+            return is_negative ? -result : result;
+        }
+
+        /// @brief Converts an ASCII decimal number into a fixed point integer scaled by 10^decimals, without using
+        /// floating point math. Extra fractional digits are truncated. Behavior is undefined is character array is not
+        /// null terminated.
+        ///
+        /// @param val Null terminated number, such as "054.70".
+        /// @param decimals Number of fractional digits kept in the result.
+        long string_to_fixed(const char *val, unsigned char decimals)
+        {
+            if (!val)
+            {
+                return 0;
+            }
+
+            long result = 0;
+            bool found_dot = false;
+            bool is_negative = false;
+
+            // Handle negative and plus signs.
+            if (*val == '-' || *val == '+')
+            {
+                is_negative = *val == '-';
+                ++val;
+            }
+
+            while (*val != 0)
+            {
+                if (is_digit(*val))
+                {
+                    if (found_dot)
+                    {
+                        if (decimals == 0)
+                        {
+                            break;
+                        }
+                        --decimals;
+                    }
+
+                    result *= 10;
+                    result += to_digit(*val);
+                }
+                else if (*val == '.' && !found_dot)
+                {
+                    found_dot = true;
+                }
+                else
+                {
+                    break;
+                }
+                ++val;
+            }
+
+            // Scale up for any fractional digits not present in the input.
+            while (decimals > 0)
+            {
+                --decimals;
+                result *= 10;
+            }
+
+            if (is_negative)
+            {
+                result *= -1;
+            }
+
+            return result;
+        }
+
+        /// @brief Parse a NMEA ddmmyy date string into a packed date. Returns 0 if the field is not a date.
+        unsigned short parse_date(const char *val, size_type size)
+        {
+            // Six digits plus null terminator.
+            if (size < 7)
+            {
+                return 0;
+            }
+
+            for (size_type i = 0; i < 6; ++i)
+            {
+                if (!is_digit(val[i]))
+                {
+                    return 0;
+                }
+            }
+
+            unsigned day = to_digit(val[0]) * 10 + to_digit(val[1]);
+            unsigned month = to_digit(val[2]) * 10 + to_digit(val[3]);
+            unsigned year = to_digit(val[4]) * 10 + to_digit(val[5]);
+
+            return pack_date(2000 + year, month, day);
+        }
+
+        /// @brief Parse a NMEA hhmmss.sss time string into milliseconds since midnight. Digits are at fixed positions,
+        /// so each one is converted directly. Zero to three fractional digits are accepted; more are truncated. Returns
+        /// 0 if the field is not a time.
+        uint32_t parse_time_ms(const char *val, size_type size)
+        {
+            // Six digits plus null terminator.
+            if (size < 7 || !is_digit(val[0]) || !is_digit(val[1]) || !is_digit(val[2]) || !is_digit(val[3]) ||
+                !is_digit(val[4]) || !is_digit(val[5]))
+            {
+                return 0;
+            }
+
+            uint32_t hours = to_digit(val[0]) * 10 + to_digit(val[1]);
+            uint32_t minutes = to_digit(val[2]) * 10 + to_digit(val[3]);
+            uint32_t seconds = to_digit(val[4]) * 10 + to_digit(val[5]);
+            uint32_t millis = 0;
+
+            // Fraction. The buffer is null terminated, so each check stops at the end of the field.
+            if (val[6] == '.' && is_digit(val[7]))
+            {
+                millis = to_digit(val[7]) * 100;
+                if (is_digit(val[8]))
+                {
+                    millis += to_digit(val[8]) * 10;
+                    if (is_digit(val[9]))
+                    {
+                        millis += to_digit(val[9]);
+                    }
+                }
+            }
+
+            return ((hours * 60 + minutes) * 60 + seconds) * 1000 + millis;
+        }
+
+        /// @brief Count the set bits in a byte array.
+        size_type count_bits(const unsigned char *bits, size_type size)
+        {
+            size_type count = 0;
+            for (size_type i = 0; i < size; ++i)
+            {
+                unsigned char b = bits[i];
+                while (b)
+                {
+                    b &= b - 1;
+                    ++count;
+                }
+            }
+            return count;
+        }
+
         /// @brief Parse a NMEA latitude string.
         float parse_latitude(const char *val, size_type size)
         {
@@ -210,242 +414,104 @@ namespace gps
             degrees += (minutes / 60.0f);
             return degrees;
         }
-    } // namespace _detail
-
-    using namespace scottz0r::gps::_detail;
-
-    /// @brief Initialize the class instance, initializing all class members to the default state. The class will be
-    /// ready to process NMEA messages after initialization.
-    MicroGps::MicroGps()
-        : m_state_bit_flags(0), m_checksum(0), m_field_num(0), m_message_type(MessageType::Unknown), m_position({})
-    {
-    }
 
-    /// @brief Process a character in an NMEA message.
-    ///
-    /// The message_type() method must be used to determine the last message processed. The bad() method should be
-    /// checked to ensure the last processed message is valid and contained a valid checksum.
-    ///
-    /// @param c Character to process.
-    /// @return True is a message is ready. False if a message is still being processed.
-    bool MicroGps::process(char c)
-    {
-        // Start of sentence. Reset collection state.
-        if (c == '$')
+        /// @brief Parse a NMEA latitude string with double precision.
+        double parse_latitude_double(const char *val, size_type size)
         {
-            m_buffer.clear();
-            m_checksum = 0;
-            m_state_bit_flags = 0;
-            m_field_num = 0;
-            m_state_bit_flags = set_flag(m_state_bit_flags, StateBits::CollectBit);
-            m_message_type = MessageType::Unknown;
-            return false;
-        }
-
-        // If not in a collection state, then do not attempt to process.
-        if (!is_flag_set(m_state_bit_flags, StateBits::CollectBit))
-        {
-            return false;
-        }
+            if (size < 2)
+            {
+                return 0.0;
+            }
 
-        // Don't process if in a bad state.
-        if (is_flag_set(m_state_bit_flags, StateBits::BadBit))
-        {
-            return false;
-        }
+            char deg_buffer[3];
+            deg_buffer[0] = val[0];
+            deg_buffer[1] = val[1];
+            deg_buffer[2] = 0;
 
-        // Do not process if has a message identifier and message is unknown.
-        if (m_field_num > 1 && m_message_type == MessageType::Unknown)
-        {
-            return false;
+            return string_to_double(deg_buffer) + string_to_double(val + 2) / 60.0;
         }
 
-        switch (c)
+        /// @brief Parse a NMEA longitude string with double precision.
+        double parse_longitude_double(const char *val, size_type size)
         {
-        case '$':
-            // Code coverage exclusion: This case is already handled.
-            return false;
-
-        case ',':
-            // field separator. Used in checksum.
-            m_checksum ^= c;
-
-            // If buffer cannot be terminated set bad state and do not process.
-            if (!m_buffer.append(0))
-            {
-                m_state_bit_flags = set_flag(m_state_bit_flags, StateBits::BadBit);
-                return false;
-            }
-
-            process_field();
-            ++m_field_num;
-            m_buffer.clear();
-            return false;
-
-        case '*':
-            // Checksum indicator. End current field.
-            if (!m_buffer.append(0))
+            if (size < 3)
             {
-                m_state_bit_flags = set_flag(m_state_bit_flags, StateBits::BadBit);
-                return false;
+                return 0.0;
             }
 
-            process_field();
-            ++m_field_num;
-            m_buffer.clear();
-
-            // Set to checksum collecting state.
-            m_state_bit_flags = set_flag(m_state_bit_flags, StateBits::ChecksumBit);
-            return false;
-
-        case '\r':
-            // Do nothing on carriage return. Newline is the real message terminator for this logic.
-            return false;
+            char deg_buffer[4];
+            deg_buffer[0] = val[0];
+            deg_buffer[1] = val[1];
+            deg_buffer[2] = val[2];
+            deg_buffer[3] = 0;
 
-        case '\n':
-            // End of message. Turn off collection state.
-            m_state_bit_flags = clear_flag(m_state_bit_flags, StateBits::CollectBit);
+            return string_to_double(deg_buffer) + string_to_double(val + 3) / 60.0;
+        }
 
-            // If there is a checksum, then need to do stuff here.
-            if (is_flag_set(m_state_bit_flags, StateBits::ChecksumBit))
+        /// @brief Parse a NMEA latitude or longitude string into degrees scaled by 10^7, using only integer math.
+        /// Minutes are kept to 5 decimals and rounded to the nearest 1e-7 degree.
+        ///
+        /// @param val Null terminated field, such as "3854.8732".
+        /// @param size Size of the field including the terminator.
+        /// @param degree_digits 2 for latitude, 3 for longitude.
+        long parse_coordinate_fixed(const char *val, size_type size, size_type degree_digits)
+        {
+            if (size <= degree_digits)
             {
-                // Do not need to null terminate for checksum.
-                process_checksum();
-
-                // Return indicator that message is ready.
-                return true;
+                return 0;
             }
 
-            // No checksum. This is a failure condition.
-            m_state_bit_flags = set_flag(m_state_bit_flags, StateBits::BadBit);
-            return false;
-
-        default:
-            // Collect character if in bounds. Don't add to checksum if it's the checksum field.
-            if (!is_flag_set(m_state_bit_flags, StateBits::ChecksumBit))
+            long degrees = 0;
+            for (size_type i = 0; i < degree_digits; ++i)
             {
-                m_checksum ^= c;
+                degrees = degrees * 10 + to_digit(val[i]);
             }
 
-            // If buffer is full, set to bad state.
-            if (!m_buffer.append(c))
-            {
-                m_state_bit_flags = set_flag(m_state_bit_flags, StateBits::BadBit);
-            }
+            // Minutes scaled by 10^5. Degrees * 10^7 = minutes * 10^5 * 100 / 60.
+            long minutes = string_to_fixed(val + degree_digits, 5);
 
-            return false;
+            return degrees * 10000000L + (minutes * 10 + 3) / 6;
         }
-    }
+    } // namespace _detail
+
+    using namespace scottz0r::gps::_detail;
 
-    /// @brief Process a field, which is contained in the field buffer. Fields will be null terminated. The first
-    /// field is always used as a message identifier, which drives m_message_type.
-    void MicroGps::process_field()
+    /// @brief Convert a packed date and a time of day into milliseconds since the Unix epoch (UTC), so fixes from
+    /// different days can be sorted and joined with integer math.
+    ///
+    /// @param date Date from pack_date().
+    /// @param time_ms Milliseconds since midnight.
+    /// @return Milliseconds since 1970-01-01, or 0 if the date is 0 (unknown).
+    uint64_t utc_epoch_ms(unsigned short date, uint32_t time_ms)
     {
-        if (m_field_num == 0)
+        if (date == 0)
         {
-            if (string_equals(m_buffer.get(), "GPGGA"))
-            {
-                m_message_type = MessageType::GPGGA;
-            }
-            else
-            {
-                m_message_type = MessageType::Unknown;
-            }
+            return 0;
         }
 
-        switch (m_message_type)
-        {
-        case MessageType::GPGGA:
-            process_gpgga_fields();
-            break;
-        default:
-            // Do nothing.
-            break;
-        }
-    }
+        // Days before each month in a non leap year.
+        static const unsigned short days_before_month[] = {0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
 
-    /// @brief Process GPGGA message fields.
-    void MicroGps::process_gpgga_fields()
-    {
-        switch (m_field_num)
-        {
-        case 0:
-            // Reset GPS data on first message.
-            m_position = {};
-            break;
-        case 1:
-            // Time
-            m_position.timestamp = (unsigned)string_to_int(m_buffer.get());
-            break;
-        case 2: {
-            // Latitude
-            m_position.latitude = parse_latitude(m_buffer.get(), m_buffer.size());
-            break;
-        }
-        case 3:
-            // Latitude North/South
-            if (m_buffer.at(0) == 'S')
-            {
-                m_position.latitude *= -1;
-            }
-            break;
-        case 4:
-            // Longitude East/West
-            m_position.longitude = parse_longitude(m_buffer.get(), m_buffer.size());
-            break;
-        case 5:
-            if (m_buffer.at(0) == 'W')
-            {
-                m_position.longitude *= -1;
-            }
-            break;
-        case 6:
-            // Fix Quality
-            m_position.fix_quality = (unsigned char)string_to_int(m_buffer.get());
-            break;
-        case 7:
-            // Number of satellites
-            m_position.number_satellites = (unsigned char)string_to_int(m_buffer.get());
-            break;
-        case 8:
-            // HDOP
-            m_position.horizontal_dilution = string_to_float(m_buffer.get());
-            break;
-        case 9:
-            // Altitude
-            m_position.altitude_msl = string_to_float(m_buffer.get());
-            break;
-        case 11:
-            // Geoid Adjustment to WGS-84
-            m_position.geoid_height = string_to_float(m_buffer.get());
-            break;
-        case 10:
-        case 12:
-        case 13:
-        case 14:
-            break; // Ignore these fields.
-        default:
-            // Set bad to indicate unexpected message format.
-            m_state_bit_flags = set_flag(m_state_bit_flags, StateBits::BadBit);
-        }
-    }
+        unsigned year = date_year(date);
+        unsigned month = date_month(date);
+        unsigned day = date_day(date);
 
-    /// @brief Process the checksum. Sets the bad bit if the computed checksum does not match the message checksum.
-    /// Assumes message checksum is only 2 hex characters.
-    void MicroGps::process_checksum()
-    {
-        if (m_buffer.size() > 2)
+        if (month < 1 || month > 12 || day < 1)
         {
-            set_flag(m_state_bit_flags, StateBits::BadBit);
-            return;
+            return 0;
         }
 
-        char msg_checksum = (from_hex(m_buffer.at(0)) << 4) | from_hex(m_buffer.at(1));
+        // Packed years are 2000 to 2127, where 2100 is the only year divisible by 4 that is not a leap year.
+        bool is_leap = (year % 4) == 0 && year != 2100;
+        unsigned long leap_days = (year - 1997) / 4 - (year > 2100 ? 1 : 0);
 
-        if (msg_checksum != m_checksum)
-        {
-            m_state_bit_flags = set_flag(m_state_bit_flags, StateBits::BadBit);
-        }
+        unsigned long days = 365UL * (year - 2000) + leap_days + days_before_month[month] + (is_leap && month > 2) +
+                             day - 1;
+
+        // 2000-01-01 is 10957 days after 1970-01-01.
+        days += 10957;
+
+        return (uint64_t)days * 86400000ULL + time_ms;
     }
 } // namespace gps
 } // namespace scottz0r
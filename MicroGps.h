@@ -1,26 +1,43 @@
 /// @file MicroGps definition module.
 ///
-/// This module defines the MicroGps class, which processes NMEA GPS messages with low overhead.
+/// This module defines the BasicMicroGps class template, which processes NMEA GPS messages with low overhead, and the
+/// MicroGps class used by the rest of the library. A policy selects the footprint and performance tier of a parser.
 #ifndef _SCOTTZ0R_NANO_GPS_INCLUDE_GUARD
 #define _SCOTTZ0R_NANO_GPS_INCLUDE_GUARD
 
+#include "MicroGpsSatellites.h"
 #include "MicroGpsTypes.h"
+#include <stdint.h>
 
 namespace scottz0r
 {
 namespace gps
 {
-    /// Holds data from GPGGA sentences.
-    struct GpsPosition
+    /// @brief Supported message types that MicroGps can process.
+    enum class MessageType : unsigned char
     {
-        unsigned timestamp;
-        unsigned char fix_quality;
-        unsigned char number_satellites;
-        float latitude;
-        float longitude;
-        float horizontal_dilution;
-        float altitude_msl;
-        float geoid_height;
+        GGA,
+        RMC,
+        GSV,
+        GSA,
+        PmtkAck,
+        Unknown,
+        GPGGA = GGA ///< Name used before sentence matching became talker agnostic.
+    };
+
+    /// @brief Get a bit mask with a single bit set for the given message type. Used to build sets of message types.
+    constexpr unsigned message_bit(MessageType type)
+    {
+        return 1u << (unsigned)type;
+    }
+
+    /// @brief Sentence counters kept by parsers with statistics enabled in their policy.
+    struct GpsStats
+    {
+        unsigned long sentences;       ///< Sentences returned by process(), good or bad.
+        unsigned long checksum_errors; ///< Sentences with a missing or mismatched checksum.
+        unsigned long format_errors;   ///< Sentences with too many fields or a field too long for the buffer.
+        unsigned long unknown;         ///< Sentences skipped because the type is unknown or not enabled.
     };
 
     /// @brief Detail implementations. Do not used. Exposed for test coverage.
@@ -90,6 +107,30 @@ namespace gps
             size_type m_size;
         };
 
+        /// @brief Returns true if the given bit flag is set in integral type x.
+        template <typename _T, typename _F> inline bool is_flag_set(_T x, _F flag)
+        {
+            return (x & (_T)flag) > 0;
+        }
+
+        /// @brief Set the given bit flag on the integral type x.
+        template <typename _T, typename _F> inline _T set_flag(_T x, _F flag)
+        {
+            return x | (_T)flag;
+        }
+
+        /// @brief Clear the given bit flag on the integral type x.
+        template <typename _T, typename _F> inline _T clear_flag(_T x, _F flag)
+        {
+            return x & (~((_T)flag));
+        }
+
+        /// @brief Returns true if the message type is in a set of message_bit() values.
+        constexpr bool has_message(unsigned messages, MessageType type)
+        {
+            return (messages & message_bit(type)) != 0;
+        }
+
         /// @brief Tests if given ASCII character is a digit.
         inline bool is_digit(char c)
         {
@@ -109,48 +150,543 @@ namespace gps
 
         char from_hex(char c);
 
+        Talker parse_talker(char first, char second);
+
         bool string_equals(const char *lhs, const char *rhs);
 
         int string_to_int(const char *val);
 
         float string_to_float(const char *val);
 
+        double string_to_double(const char *val);
+
+        long string_to_fixed(const char *val, unsigned char decimals);
+
+        unsigned short parse_date(const char *val, size_type size);
+
+        uint32_t parse_time_ms(const char *val, size_type size);
+
+        size_type count_bits(const unsigned char *bits, size_type size);
+
         float parse_latitude(const char *val, size_type size);
 
         float parse_longitude(const char *val, size_type size);
+
+        double parse_latitude_double(const char *val, size_type size);
+
+        double parse_longitude_double(const char *val, size_type size);
+
+        long parse_coordinate_fixed(const char *val, size_type size, size_type degree_digits);
+
+        /// @brief Tag selecting the overload for an enabled or disabled message type, so that code writing a disabled
+        /// record is never instantiated.
+        template <bool _Enabled> struct EnabledTag
+        {
+        };
+
+        /// @brief Storage for a record that is decoded by a parser. Used as a base class so that the disabled
+        /// specialization takes no space.
+        template <bool _Enabled, typename _T> class GpsRecord
+        {
+        public:
+            GpsRecord() : m_record()
+            {
+            }
+
+            inline _T &get()
+            {
+                return m_record;
+            }
+
+            inline const _T &get() const
+            {
+                return m_record;
+            }
+
+            inline void set(const _T &record)
+            {
+                m_record = record;
+            }
+
+        private:
+            _T m_record;
+        };
+
+        /// @brief Record of a message type that is not enabled. Reads return a value initialized record that cannot be
+        /// written, and set() does nothing.
+        template <typename _T> class GpsRecord<false, _T>
+        {
+        public:
+            inline const _T &get() const
+            {
+                static const _T record{};
+                return record;
+            }
+
+            inline void set(const _T &)
+            {
+            }
+        };
+
+        /// @brief Sentence counters. Used as a base class so that the disabled specialization takes no space and the
+        /// counting calls compile to nothing.
+        template <bool _Enabled> class GpsStatsCounter
+        {
+        public:
+            GpsStatsCounter() : m_stats()
+            {
+            }
+
+            /// @brief Get the sentence counters.
+            inline const GpsStats &stats() const
+            {
+                return m_stats;
+            }
+
+            /// @brief Reset all sentence counters to zero.
+            inline void reset_stats()
+            {
+                m_stats = {};
+            }
+
+        protected:
+            inline void count_sentence()
+            {
+                ++m_stats.sentences;
+            }
+
+            inline void count_checksum_error()
+            {
+                ++m_stats.checksum_errors;
+            }
+
+            inline void count_format_error()
+            {
+                ++m_stats.format_errors;
+            }
+
+            inline void count_unknown()
+            {
+                ++m_stats.unknown;
+            }
+
+        private:
+            GpsStats m_stats;
+        };
+
+        /// @brief Disabled sentence counters. stats() always reports zero.
+        template <> class GpsStatsCounter<false>
+        {
+        public:
+            inline const GpsStats &stats() const
+            {
+                static const GpsStats empty{};
+                return empty;
+            }
+
+            inline void reset_stats()
+            {
+            }
+
+        protected:
+            inline void count_sentence()
+            {
+            }
+
+            inline void count_checksum_error()
+            {
+            }
+
+            inline void count_format_error()
+            {
+            }
+
+            inline void count_unknown()
+            {
+            }
+        };
     } // namespace _detail
 
-    /// @brief NMEA GPS message processing class for embedded systems.
+    /// @brief Numeric representation with single precision floats. Resolution is about 1 meter at 100 degrees of
+    /// longitude. This is the representation of MicroGps.
+    struct FloatNumeric
+    {
+        using coordinate_type = float; ///< Degrees.
+        using value_type = float;      ///< Dilution, meters.
+
+        static inline coordinate_type latitude(const char *val, size_type size)
+        {
+            return _detail::parse_latitude(val, size);
+        }
+
+        static inline coordinate_type longitude(const char *val, size_type size)
+        {
+            return _detail::parse_longitude(val, size);
+        }
+
+        static inline value_type value(const char *val)
+        {
+            return _detail::string_to_float(val);
+        }
+    };
+
+    /// @brief Numeric representation with double precision floats, for targets with hardware double support. Note that
+    /// double is the same as float on AVR.
+    struct DoubleNumeric
+    {
+        using coordinate_type = double; ///< Degrees.
+        using value_type = double;      ///< Dilution, meters.
+
+        static inline coordinate_type latitude(const char *val, size_type size)
+        {
+            return _detail::parse_latitude_double(val, size);
+        }
+
+        static inline coordinate_type longitude(const char *val, size_type size)
+        {
+            return _detail::parse_longitude_double(val, size);
+        }
+
+        static inline value_type value(const char *val)
+        {
+            return _detail::string_to_double(val);
+        }
+    };
+
+    /// @brief Numeric representation with fixed point integers, for targets without a floating point unit. Nothing is
+    /// rounded through a float, so coordinates keep the full resolution of the sentence (1e-7 degrees is about 1 cm).
+    struct FixedNumeric
+    {
+        using coordinate_type = int32_t; ///< Degrees scaled by coordinate_scale.
+        using value_type = int32_t;      ///< Dilution and meters scaled by value_scale.
+
+        static constexpr int32_t coordinate_scale = 10000000;
+        static constexpr int32_t value_scale = 1000;
+
+        static inline coordinate_type latitude(const char *val, size_type size)
+        {
+            return (coordinate_type)_detail::parse_coordinate_fixed(val, size, 2);
+        }
+
+        static inline coordinate_type longitude(const char *val, size_type size)
+        {
+            return (coordinate_type)_detail::parse_coordinate_fixed(val, size, 3);
+        }
+
+        static inline value_type value(const char *val)
+        {
+            return (value_type)_detail::string_to_fixed(val, 3);
+        }
+    };
+
+    /// @brief Fields of a position record that can be missing from a sentence.
+    enum class PositionField : unsigned char
+    {
+        Time,
+        Latitude,
+        Longitude,
+        FixQuality,
+        Satellites,
+        Dilution,
+        Altitude,
+        GeoidHeight
+    };
+
+    /// @brief Get a bit mask with a single bit set for the given position field. Used to build sets of fields.
+    constexpr unsigned char position_field_bit(PositionField field)
+    {
+        return (unsigned char)(1u << (unsigned)field);
+    }
+
+    /// Holds data from GGA sentences, in the representation of a numeric policy.
+    template <typename _Numeric> struct BasicGpsPosition
+    {
+        unsigned timestamp; ///< UTC time as the integer hhmmss. Fractional seconds are truncated.
+        uint32_t time_ms;   ///< UTC time in milliseconds since midnight, including fractional seconds.
+        Talker talker;
+        unsigned char fix_quality;
+        unsigned char number_satellites;
+        unsigned char fields; ///< Set of position_field_bit() values for the fields that were not empty.
+        typename _Numeric::coordinate_type latitude;
+        typename _Numeric::coordinate_type longitude;
+        typename _Numeric::value_type horizontal_dilution;
+        typename _Numeric::value_type altitude_msl;
+        typename _Numeric::value_type geoid_height;
+    };
+
+    /// @brief Returns true if a field of a position record was not empty in its sentence.
+    template <typename _Numeric>
+    inline bool has_field(const BasicGpsPosition<_Numeric> &position, PositionField field)
+    {
+        return (position.fields & position_field_bit(field)) != 0;
+    }
+
+    /// Holds data from GGA sentences.
+    using GpsPosition = BasicGpsPosition<FloatNumeric>;
+
+    /// Holds data from GGA sentences, with fixed point coordinates and values. See FixedNumeric.
+    using FixedGpsPosition = BasicGpsPosition<FixedNumeric>;
+
+    /// @brief Holds data from RMC sentences, in the representation of a numeric policy. Speed and course are fixed
+    /// point integers so they can be decoded without floating point math, and the date is packed with pack_date().
+    template <typename _Numeric> struct BasicGpsNavigation
+    {
+        unsigned timestamp; ///< UTC time as the integer hhmmss. Fractional seconds are truncated.
+        uint32_t time_ms;   ///< UTC time in milliseconds since midnight, including fractional seconds.
+        Talker talker;
+        bool valid; ///< Status field was 'A' (data valid).
+        unsigned short date;
+        unsigned short speed_knots; ///< Speed over ground in hundredths of a knot.
+        unsigned short course;      ///< Course over ground in hundredths of a degree true.
+        typename _Numeric::coordinate_type latitude;
+        typename _Numeric::coordinate_type longitude;
+    };
+
+    /// Holds data from RMC sentences.
+    using GpsNavigation = BasicGpsNavigation<FloatNumeric>;
+
+    /// Holds data from RMC sentences, with fixed point coordinates. See FixedNumeric.
+    using FixedGpsNavigation = BasicGpsNavigation<FixedNumeric>;
+
+    /// @brief Holds data from GSA sentences. Dilutions are fixed point in hundredths. Satellites used in the solution
+    /// are a 256 bit set indexed by PRN, so quality checks are bitwise tests rather than searches.
+    struct GpsSolution
+    {
+        char mode;              ///< 'A' automatic or 'M' manual 2D/3D selection.
+        unsigned char fix_type; ///< 1 = no fix, 2 = 2D, 3 = 3D.
+        unsigned short pdop;
+        unsigned short hdop;
+        unsigned short vdop;
+        /// Bit (prn % 8) of byte (prn / 8) is set if the PRN is used. PRNs are kept as sent: NMEA 4.10 receivers
+        /// number Galileo and BeiDou satellites from 1 with a system ID, so in GN sentences they share bits with GPS.
+        /// PRNs above 255 are not recorded.
+        unsigned char active[32];
+    };
+
+    /// @brief Result of a receiver configuration command, as reported by an acknowledge message.
+    enum class AckStatus : unsigned char
+    {
+        Invalid,
+        Unsupported,
+        Failed,
+        Succeeded
+    };
+
+    /// @brief Holds data from acknowledge messages (PMTK001, or UBX ACK-ACK/ACK-NAK in MicroUbx).
+    struct GpsAck
+    {
+        unsigned short command; ///< PMTK command number, or UBX class << 8 | message ID.
+        AckStatus status;
+    };
+
+    /// @brief Returns true if the PRN is set in the active satellite set of a solution.
+    inline bool is_prn_active(const GpsSolution &solution, unsigned char prn)
+    {
+        return (solution.active[prn >> 3] >> (prn & 0x07)) & 0x01;
+    }
+
+    /// @brief Get the number of satellites used in a solution.
+    inline size_type active_count(const GpsSolution &solution)
+    {
+        return _detail::count_bits(solution.active, sizeof(solution.active));
+    }
+
+    /// @brief Pack a calendar date into 16 bits: 7 bits of years since 2000, 4 bits of month and 5 bits of day. Packed
+    /// dates sort in calendar order. Zero is used for "no date".
+    constexpr unsigned short pack_date(unsigned year, unsigned month, unsigned day)
+    {
+        return (unsigned short)(((year - 2000) << 9) | (month << 5) | day);
+    }
+
+    /// @brief Get the year (2000 to 2127) of a packed date.
+    constexpr unsigned date_year(unsigned short date)
+    {
+        return 2000 + (date >> 9);
+    }
+
+    /// @brief Get the month (1 to 12) of a packed date.
+    constexpr unsigned date_month(unsigned short date)
+    {
+        return (date >> 5) & 0x0F;
+    }
+
+    /// @brief Get the day of month (1 to 31) of a packed date.
+    constexpr unsigned date_day(unsigned short date)
+    {
+        return date & 0x1F;
+    }
+
+    uint64_t utc_epoch_ms(unsigned short date, uint32_t time_ms);
+
+    /// @brief Default policy. Selects the behavior of MicroGps.
+    ///
+    /// Policies are customized by deriving from one of the tiers and hiding members, for example
+    /// `struct MyPolicy : MicroGpsPolicy { static constexpr bool enable_stats = true; };`.
+    struct MicroGpsPolicy
+    {
+        /// Size of the field buffer, including the terminator. Longer fields set the bad bit.
+        static constexpr size_type buffer_capacity = 32;
+
+        /// Representation of coordinates and decimal values. FloatNumeric, DoubleNumeric or FixedNumeric.
+        using numeric_type = FloatNumeric;
+
+        /// Set of message_bit() values to decode. Other sentences are skipped like unknown sentences, and the code
+        /// and records for them are left out.
+        static constexpr unsigned messages = message_bit(MessageType::GGA) | message_bit(MessageType::RMC) |
+                                             message_bit(MessageType::GSV) | message_bit(MessageType::GSA) |
+                                             message_bit(MessageType::PmtkAck);
+
+        /// Keep the sentence counters returned by stats().
+        static constexpr bool enable_stats = false;
+
+        /// Reject sentences with a missing or mismatched checksum. When false the checksum is not computed, and
+        /// sentences without one are accepted.
+        static constexpr bool enforce_checksum = true;
+    };
+
+    /// @brief Smallest tier: fixed point GGA positions only, for 8-bit targets without a floating point unit.
+    struct MicroGpsMinimalPolicy : MicroGpsPolicy
+    {
+        static constexpr size_type buffer_capacity = 16;
+        using numeric_type = FixedNumeric;
+        static constexpr unsigned messages = message_bit(MessageType::GGA);
+    };
+
+    /// @brief Largest tier: double precision values and sentence counters, for 32-bit targets with an FPU.
+    struct MicroGpsFullPolicy : MicroGpsPolicy
+    {
+        using numeric_type = DoubleNumeric;
+        static constexpr bool enable_stats = true;
+    };
+
+    namespace _detail
+    {
+        /// @brief Record storage selected by a MicroGps policy.
+        template <typename _Policy> struct GpsRecords
+        {
+            using position_type = BasicGpsPosition<typename _Policy::numeric_type>;
+            using navigation_type = BasicGpsNavigation<typename _Policy::numeric_type>;
+
+            using position = GpsRecord<has_message(_Policy::messages, MessageType::GGA), position_type>;
+            using navigation = GpsRecord<has_message(_Policy::messages, MessageType::RMC), navigation_type>;
+            using solution = GpsRecord<has_message(_Policy::messages, MessageType::GSA), GpsSolution>;
+            using ack = GpsRecord<has_message(_Policy::messages, MessageType::PmtkAck), GpsAck>;
+            using satellites = GpsRecord<has_message(_Policy::messages, MessageType::GSV), GpsSatelliteTable *>;
+        };
+    } // namespace _detail
+
+    /// @brief NMEA GPS message processing class template for embedded systems.
     ///
     /// This class holds and manages the state required for collecting and processing NMEA strings. This class is
     /// intended to be used in embedded systems where resources are limited. Messages are collected and processed
-    /// one character at a time.
-    class MicroGps
+    /// one character at a time. The policy (see MicroGpsPolicy) selects the buffer size, numeric representation,
+    /// decoded messages, statistics and checksum enforcement; everything it disables is left out at compile time.
+    template <typename _Policy>
+    class BasicMicroGps : public _detail::GpsStatsCounter<_Policy::enable_stats>,
+                          private _detail::GpsRecords<_Policy>::position,
+                          private _detail::GpsRecords<_Policy>::navigation,
+                          private _detail::GpsRecords<_Policy>::solution,
+                          private _detail::GpsRecords<_Policy>::ack,
+                          private _detail::GpsRecords<_Policy>::satellites
     {
         enum class StateBits : unsigned char
         {
             ChecksumBit = 0x01,
             BadBit = 0x02,
-            CollectBit = 0x04
+            CollectBit = 0x04,
+            CompleteBit = 0x10,
+            TimeBit = 0x20 ///< The sentence had a time field that was not empty.
         };
 
+        using PositionRecord = typename _detail::GpsRecords<_Policy>::position;
+        using NavigationRecord = typename _detail::GpsRecords<_Policy>::navigation;
+        using SolutionRecord = typename _detail::GpsRecords<_Policy>::solution;
+        using AckRecord = typename _detail::GpsRecords<_Policy>::ack;
+        using SatellitesRecord = typename _detail::GpsRecords<_Policy>::satellites;
+
     public:
-        /// @brief Supported message types that this class can process.
-        enum class MessageType : unsigned char
+        using policy_type = _Policy;
+        using numeric_type = typename _Policy::numeric_type;
+        using position_type = typename _detail::GpsRecords<_Policy>::position_type;
+        using navigation_type = typename _detail::GpsRecords<_Policy>::navigation_type;
+        using MessageType = gps::MessageType;
+
+        /// @brief Get a bit mask with a single bit set for the given message type. Used to build sets of message types.
+        static constexpr unsigned message_bit(MessageType type)
         {
-            GPGGA,
-            Unknown
-        };
+            return gps::message_bit(type);
+        }
+
+        /// @brief Returns true if the policy enables decoding of the message type.
+        static constexpr bool is_enabled(MessageType type)
+        {
+            return _detail::has_message(_Policy::messages, type);
+        }
 
-        MicroGps();
+        BasicMicroGps();
 
         bool process(char c);
 
-        /// @brief Get the GPS position data. Data will be valid after a GPGGA message has been parsed successfully
-        /// up to the start of the next GPGGA message.
-        inline const GpsPosition &position_data()
+        size_type process_until_complete(const char *data, size_type size);
+
+        /// @brief Get the GPS position data. Data will be valid after a GGA message has been parsed successfully
+        /// up to the start of the next GGA message.
+        inline const position_type &position_data() const
+        {
+            return PositionRecord::get();
+        }
+
+        /// @brief Get the navigation data. Data will be valid after a RMC message has been parsed successfully up to
+        /// the start of the next RMC message.
+        inline const navigation_type &navigation_data() const
         {
-            return m_position;
+            return NavigationRecord::get();
+        }
+
+        /// @brief Get the solution data. Data will be valid after a GSA message has been parsed successfully. Multi
+        /// constellation receivers send one GSA per constellation; the GSA messages of an epoch are merged into one
+        /// active satellite set. A new set starts at the first GSA after a GGA or RMC, or at a GSA whose constellation
+        /// is not after the last one merged. GN sentences name their constellation only after their satellites, so
+        /// without GGA or RMC the first cycle of GN sentences is merged with the second.
+        inline const GpsSolution &solution_data() const
+        {
+            return SolutionRecord::get();
+        }
+
+        /// @brief Get the acknowledge data. Data will be valid after a PMTK001 message has been parsed successfully.
+        inline const GpsAck &ack_data() const
+        {
+            return AckRecord::get();
+        }
+
+        /// @brief Get the set of message_bit() values this instance decodes. Receiver output can be limited to this set
+        /// with the encoders in MicroGpsConfig.h.
+        inline unsigned decoded_messages() const
+        {
+            unsigned messages = _Policy::messages & ~message_bit(MessageType::GSV);
+            if (SatellitesRecord::get())
+            {
+                messages |= message_bit(MessageType::GSV);
+            }
+            return messages;
+        }
+
+        /// @brief Attach a satellite table to subscribe to GSV sentences. GSV sentences are skipped like unknown
+        /// sentences while no table is attached (the default), or if the policy does not enable GSV.
+        ///
+        /// @param table Table to fill, or nullptr to unsubscribe. Must outlive this instance. A GSV sentence being
+        /// collected is dropped.
+        inline void set_satellite_table(GpsSatelliteTable *table)
+        {
+            if (is_enabled(MessageType::GSV))
+            {
+                if (m_message_type == MessageType::GSV &&
+                    _detail::is_flag_set(m_state_bit_flags, StateBits::CollectBit))
+                {
+                    m_state_bit_flags = _detail::set_flag(m_state_bit_flags, StateBits::BadBit);
+                }
+                SatellitesRecord::set(table);
+            }
         }
 
         /// @brief Returns true if the bad bit is set. This indicates that the last message parse is invalid.
@@ -165,27 +701,782 @@ namespace gps
             return !bad();
         }
 
+        /// @brief Returns true if the last byte given to process_until_complete() completed a sentence. Also true after
+        /// process() returns true, up to the start of the next sentence.
+        inline bool complete() const
+        {
+            return m_state_bit_flags & (unsigned char)StateBits::CompleteBit;
+        }
+
+        /// @brief Returns true if the last GGA or RMC sentence had a time. Receivers without a fix send empty time
+        /// fields, which parse as midnight.
+        inline bool has_time() const
+        {
+            return m_state_bit_flags & (unsigned char)StateBits::TimeBit;
+        }
+
         /// @brief Get the last parsed message type.
         inline MessageType message_type() const
         {
             return m_message_type;
         }
 
+        /// @brief Get the talker of the last parsed message.
+        inline Talker talker() const
+        {
+            return m_talker;
+        }
+
     private:
+        static MessageType parse_formatter(const char *formatter);
+
+        /// @brief Returns true if the current sentence is being collected. Other bytes are skipped up to a '$'.
+        inline bool is_collecting() const
+        {
+            return (m_state_bit_flags & ((unsigned char)StateBits::CollectBit | (unsigned char)StateBits::BadBit)) ==
+                       (unsigned char)StateBits::CollectBit &&
+                   !(m_field_num > 1 && m_message_type == MessageType::Unknown);
+        }
+
+        inline position_type &position()
+        {
+            return PositionRecord::get();
+        }
+
+        inline navigation_type &navigation()
+        {
+            return NavigationRecord::get();
+        }
+
+        inline GpsSolution &solution()
+        {
+            return SolutionRecord::get();
+        }
+
+        inline GpsAck &ack()
+        {
+            return AckRecord::get();
+        }
+
+        inline GpsSatelliteTable *satellites()
+        {
+            return SatellitesRecord::get();
+        }
+
+        /// @brief Get the bit of a position field if the current field is not empty, otherwise 0.
+        inline unsigned char present(PositionField field) const
+        {
+            return m_buffer.at(0) != 0 ? position_field_bit(field) : 0;
+        }
+
+        void set_bad_format();
+
+        bool end_sentence();
+
         void process_field();
 
         void process_checksum();
 
-        void process_gpgga_fields();
+        void process_gga_fields(_detail::EnabledTag<true>);
+
+        inline void process_gga_fields(_detail::EnabledTag<false>)
+        {
+        }
+
+        void process_rmc_fields(_detail::EnabledTag<true>);
 
-        _detail::GpsBuffer<32> m_buffer;
+        inline void process_rmc_fields(_detail::EnabledTag<false>)
+        {
+        }
+
+        void process_gsv_fields(_detail::EnabledTag<true>);
+
+        inline void process_gsv_fields(_detail::EnabledTag<false>)
+        {
+        }
+
+        void process_gsa_fields(_detail::EnabledTag<true>);
+
+        inline void process_gsa_fields(_detail::EnabledTag<false>)
+        {
+        }
+
+        /// @brief Record the constellation of the GSA being merged. The solution is complete after the last
+        /// constellation of the receiver's cycle, so the next GSA starts a new one.
+        inline void set_solution_system(unsigned char system)
+        {
+            unsigned char cycle_end = m_solution_system >> 4;
+            m_solution_system = (unsigned char)((m_solution_system & 0xF0) | (system == cycle_end ? 0 : system));
+        }
+
+        void process_pmtk_ack_fields(_detail::EnabledTag<true>);
+
+        inline void process_pmtk_ack_fields(_detail::EnabledTag<false>)
+        {
+        }
+
+        _detail::GpsBuffer<_Policy::buffer_capacity> m_buffer;
         char m_checksum;
         unsigned char m_field_num;
         MessageType m_message_type;
-        GpsPosition m_position;
+        Talker m_talker;
         unsigned char m_state_bit_flags; // Booleans, combined to save space.
+        unsigned char m_solution_system; // Constellation of the last GSA merged (low nibble, 0 starts a new solution)
+                                         // and of the last GSA in the receiver's cycle (high nibble, 0 if unknown).
     };
 
+    /// @brief NMEA GPS message processing class for embedded systems, with the default policy.
+    using MicroGps = BasicMicroGps<MicroGpsPolicy>;
+
+    /// @brief Initialize the class instance, initializing all class members to the default state. The class will be
+    /// ready to process NMEA messages after initialization.
+    template <typename _Policy>
+    BasicMicroGps<_Policy>::BasicMicroGps()
+        : m_checksum(0), m_field_num(0), m_message_type(MessageType::Unknown), m_talker(Talker::Unknown),
+          m_state_bit_flags(0), m_solution_system(0)
+    {
+    }
+
+    /// @brief Process a character in an NMEA message.
+    ///
+    /// The message_type() method must be used to determine the last message processed. The bad() method should be
+    /// checked to ensure the last processed message is valid and contained a valid checksum.
+    ///
+    /// @param c Character to process.
+    /// @return True is a message is ready. False if a message is still being processed.
+    template <typename _Policy> bool BasicMicroGps<_Policy>::process(char c)
+    {
+        // Start of sentence. Reset collection state.
+        if (c == '$')
+        {
+            // A GGA or RMC starts the next epoch, and a bad GSA leaves the solution incomplete. Either way the next GSA
+            // starts a new solution.
+            if (m_message_type == MessageType::GGA || m_message_type == MessageType::RMC ||
+                (m_message_type == MessageType::GSA &&
+                 (!good() || _detail::is_flag_set(m_state_bit_flags, StateBits::CollectBit))))
+            {
+                m_solution_system &= 0xF0;
+            }
+
+            m_buffer.clear();
+            m_checksum = 0;
+            m_state_bit_flags = 0;
+            m_field_num = 0;
+            m_state_bit_flags = _detail::set_flag(m_state_bit_flags, StateBits::CollectBit);
+            m_message_type = MessageType::Unknown;
+            m_talker = Talker::Unknown;
+            return false;
+        }
+
+        // If not in a collection state, then do not attempt to process.
+        if (!_detail::is_flag_set(m_state_bit_flags, StateBits::CollectBit))
+        {
+            return false;
+        }
+
+        // Don't process if in a bad state.
+        if (_detail::is_flag_set(m_state_bit_flags, StateBits::BadBit))
+        {
+            return false;
+        }
+
+        // Do not process if has a message identifier and message is unknown.
+        if (m_field_num > 1 && m_message_type == MessageType::Unknown)
+        {
+            return false;
+        }
+
+        switch (c)
+        {
+        case '$':
+            // Code coverage exclusion: This case is already handled.
+            return false;
+
+        case ',':
+            // field separator. Used in checksum.
+            if (_Policy::enforce_checksum)
+            {
+                m_checksum ^= c;
+            }
+
+            // If buffer cannot be terminated set bad state and do not process.
+            if (!m_buffer.append(0))
+            {
+                set_bad_format();
+                return false;
+            }
+
+            process_field();
+            ++m_field_num;
+            m_buffer.clear();
+            return false;
+
+        case '*':
+            // Checksum indicator. End current field.
+            if (!m_buffer.append(0))
+            {
+                set_bad_format();
+                return false;
+            }
+
+            process_field();
+            ++m_field_num;
+            m_buffer.clear();
+
+            // Set to checksum collecting state.
+            m_state_bit_flags = _detail::set_flag(m_state_bit_flags, StateBits::ChecksumBit);
+            return false;
+
+        case '\r':
+            // Do nothing on carriage return. Newline is the real message terminator for this logic.
+            return false;
+
+        case '\n':
+            // End of message. Turn off collection state.
+            m_state_bit_flags = _detail::clear_flag(m_state_bit_flags, StateBits::CollectBit);
+
+            // If there is a checksum, then need to do stuff here.
+            if (_detail::is_flag_set(m_state_bit_flags, StateBits::ChecksumBit))
+            {
+                // Do not need to null terminate for checksum.
+                if (_Policy::enforce_checksum)
+                {
+                    process_checksum();
+                }
+
+                return end_sentence();
+            }
+
+            if (!_Policy::enforce_checksum)
+            {
+                // No checksum is accepted. The newline ends the last field.
+                if (!m_buffer.append(0))
+                {
+                    set_bad_format();
+                    return false;
+                }
+
+                process_field();
+                return end_sentence();
+            }
+
+            // No checksum. This is a failure condition.
+            m_state_bit_flags = _detail::set_flag(m_state_bit_flags, StateBits::BadBit);
+            this->count_checksum_error();
+            return false;
+
+        default:
+            // Collect character if in bounds. Don't add to checksum if it's the checksum field.
+            if (_Policy::enforce_checksum && !_detail::is_flag_set(m_state_bit_flags, StateBits::ChecksumBit))
+            {
+                m_checksum ^= c;
+            }
+
+            // If buffer is full, set to bad state.
+            if (!m_buffer.append(c))
+            {
+                set_bad_format();
+            }
+
+            return false;
+        }
+    }
+
+    /// @brief Process characters until a sentence is complete or the input is exhausted. The caller handles the
+    /// sentence and then resumes at the returned offset, so the per byte loop stays inside the parser. Bytes between
+    /// sentences, and the rest of skipped or bad sentences, are scanned for the next '$' without running the state
+    /// machine.
+    ///
+    /// @param data Characters to process.
+    /// @param size Number of characters in data.
+    /// @return Number of characters consumed. A sentence is ready if complete() is true, which is the case whenever the
+    /// return is less than size.
+    template <typename _Policy>
+    size_type BasicMicroGps<_Policy>::process_until_complete(const char *data, size_type size)
+    {
+        m_state_bit_flags = _detail::clear_flag(m_state_bit_flags, StateBits::CompleteBit);
+
+        size_type i = 0;
+        while (i < size)
+        {
+            if (!is_collecting())
+            {
+                while (i < size && data[i] != '$')
+                {
+                    ++i;
+                }
+
+                if (i == size)
+                {
+                    break;
+                }
+            }
+
+            if (process(data[i++]))
+            {
+                return i;
+            }
+        }
+
+        return size;
+    }
+
+    /// @brief Map a three character sentence formatter (the address field after the talker) to a message type.
+    /// Message types that are not enabled by the policy map to Unknown.
+    template <typename _Policy>
+    typename BasicMicroGps<_Policy>::MessageType BasicMicroGps<_Policy>::parse_formatter(const char *formatter)
+    {
+        switch (formatter[0])
+        {
+        case 'G':
+            if (is_enabled(MessageType::GGA) && formatter[1] == 'G' && formatter[2] == 'A')
+            {
+                return MessageType::GGA;
+            }
+            if (is_enabled(MessageType::GSV) && formatter[1] == 'S' && formatter[2] == 'V')
+            {
+                return MessageType::GSV;
+            }
+            if (is_enabled(MessageType::GSA) && formatter[1] == 'S' && formatter[2] == 'A')
+            {
+                return MessageType::GSA;
+            }
+            break;
+        case 'R':
+            if (is_enabled(MessageType::RMC) && formatter[1] == 'M' && formatter[2] == 'C')
+            {
+                return MessageType::RMC;
+            }
+            break;
+        default:
+            break;
+        }
+
+        return MessageType::Unknown;
+    }
+
+    /// @brief Set the bad bit for a sentence that does not have the expected format.
+    template <typename _Policy> void BasicMicroGps<_Policy>::set_bad_format()
+    {
+        m_state_bit_flags = _detail::set_flag(m_state_bit_flags, StateBits::BadBit);
+        this->count_format_error();
+    }
+
+    /// @brief Finish a sentence that was collected up to its newline.
+    ///
+    /// @return Always true, to be returned by process().
+    template <typename _Policy> bool BasicMicroGps<_Policy>::end_sentence()
+    {
+        // Multi-part satellite data is only published once the part is known to be good.
+        if (is_enabled(MessageType::GSV) && m_message_type == MessageType::GSV && satellites())
+        {
+            satellites()->end_part(good());
+        }
+
+        m_state_bit_flags = _detail::set_flag(m_state_bit_flags, StateBits::CompleteBit);
+        this->count_sentence();
+
+        // Return indicator that message is ready.
+        return true;
+    }
+
+    /// @brief Process a field, which is contained in the field buffer. Fields will be null terminated. The first
+    /// field is always used as a message identifier, which drives m_message_type and m_talker.
+    template <typename _Policy> void BasicMicroGps<_Policy>::process_field()
+    {
+        if (m_field_num == 0)
+        {
+            // Address field is a two character talker followed by a three character formatter (5 characters plus the
+            // terminator). Only the formatter selects the message type, so every constellation shares one code path.
+            if (m_buffer.size() == 6)
+            {
+                m_talker = _detail::parse_talker(m_buffer.at(0), m_buffer.at(1));
+                m_message_type = parse_formatter(m_buffer.get() + 2);
+
+                // Unsubscribed sentences take the same early exit as unknown ones.
+                if (m_message_type == MessageType::GSV && !satellites())
+                {
+                    m_message_type = MessageType::Unknown;
+                }
+            }
+            else if (is_enabled(MessageType::PmtkAck) && m_buffer.size() == 8 &&
+                     _detail::string_equals(m_buffer.get(), "PMTK001"))
+            {
+                // Proprietary MediaTek acknowledge. No talker.
+                m_talker = Talker::Unknown;
+                m_message_type = MessageType::PmtkAck;
+            }
+            else
+            {
+                m_message_type = MessageType::Unknown;
+            }
+
+            if (m_message_type == MessageType::Unknown)
+            {
+                this->count_unknown();
+            }
+        }
+
+        // Each case selects its overload by policy so that disabled message types are compiled out.
+        switch (m_message_type)
+        {
+        case MessageType::GGA:
+            process_gga_fields(_detail::EnabledTag<is_enabled(MessageType::GGA)>());
+            break;
+        case MessageType::RMC:
+            process_rmc_fields(_detail::EnabledTag<is_enabled(MessageType::RMC)>());
+            break;
+        case MessageType::GSV:
+            process_gsv_fields(_detail::EnabledTag<is_enabled(MessageType::GSV)>());
+            break;
+        case MessageType::GSA:
+            process_gsa_fields(_detail::EnabledTag<is_enabled(MessageType::GSA)>());
+            break;
+        case MessageType::PmtkAck:
+            process_pmtk_ack_fields(_detail::EnabledTag<is_enabled(MessageType::PmtkAck)>());
+            break;
+        default:
+            // Do nothing.
+            break;
+        }
+    }
+
+    /// @brief Process GGA message fields.
+    template <typename _Policy> void BasicMicroGps<_Policy>::process_gga_fields(_detail::EnabledTag<true>)
+    {
+        position_type &position = this->position();
+
+        switch (m_field_num)
+        {
+        case 0:
+            // Reset GPS data on first message.
+            position = {};
+            position.talker = m_talker;
+            break;
+        case 1:
+            // Time
+            position.timestamp = (unsigned)_detail::string_to_int(m_buffer.get());
+            position.time_ms = _detail::parse_time_ms(m_buffer.get(), m_buffer.size());
+            position.fields |= present(PositionField::Time);
+            if (m_buffer.at(0) != 0)
+            {
+                m_state_bit_flags = _detail::set_flag(m_state_bit_flags, StateBits::TimeBit);
+            }
+            break;
+        case 2: {
+            // Latitude
+            position.latitude = numeric_type::latitude(m_buffer.get(), m_buffer.size());
+            position.fields |= present(PositionField::Latitude);
+            break;
+        }
+        case 3:
+            // Latitude North/South
+            if (m_buffer.at(0) == 'S')
+            {
+                position.latitude = -position.latitude;
+            }
+            break;
+        case 4:
+            // Longitude East/West
+            position.longitude = numeric_type::longitude(m_buffer.get(), m_buffer.size());
+            position.fields |= present(PositionField::Longitude);
+            break;
+        case 5:
+            if (m_buffer.at(0) == 'W')
+            {
+                position.longitude = -position.longitude;
+            }
+            break;
+        case 6:
+            // Fix Quality
+            position.fix_quality = (unsigned char)_detail::string_to_int(m_buffer.get());
+            position.fields |= present(PositionField::FixQuality);
+            break;
+        case 7:
+            // Number of satellites
+            position.number_satellites = (unsigned char)_detail::string_to_int(m_buffer.get());
+            position.fields |= present(PositionField::Satellites);
+            break;
+        case 8:
+            // HDOP
+            position.horizontal_dilution = numeric_type::value(m_buffer.get());
+            position.fields |= present(PositionField::Dilution);
+            break;
+        case 9:
+            // Altitude
+            position.altitude_msl = numeric_type::value(m_buffer.get());
+            position.fields |= present(PositionField::Altitude);
+            break;
+        case 11:
+            // Geoid Adjustment to WGS-84
+            position.geoid_height = numeric_type::value(m_buffer.get());
+            position.fields |= present(PositionField::GeoidHeight);
+            break;
+        case 10:
+        case 12:
+        case 13:
+        case 14:
+            break; // Ignore these fields.
+        default:
+            // Set bad to indicate unexpected message format.
+            set_bad_format();
+        }
+    }
+
+    /// @brief Process RMC message fields.
+    template <typename _Policy> void BasicMicroGps<_Policy>::process_rmc_fields(_detail::EnabledTag<true>)
+    {
+        navigation_type &navigation = this->navigation();
+
+        switch (m_field_num)
+        {
+        case 0:
+            // Reset navigation data on first message.
+            navigation = {};
+            navigation.talker = m_talker;
+            break;
+        case 1:
+            // Time
+            navigation.timestamp = (unsigned)_detail::string_to_int(m_buffer.get());
+            navigation.time_ms = _detail::parse_time_ms(m_buffer.get(), m_buffer.size());
+            if (m_buffer.at(0) != 0)
+            {
+                m_state_bit_flags = _detail::set_flag(m_state_bit_flags, StateBits::TimeBit);
+            }
+            break;
+        case 2:
+            // Status, A = valid, V = warning.
+            navigation.valid = m_buffer.at(0) == 'A';
+            break;
+        case 3:
+            // Latitude
+            navigation.latitude = numeric_type::latitude(m_buffer.get(), m_buffer.size());
+            break;
+        case 4:
+            // Latitude North/South
+            if (m_buffer.at(0) == 'S')
+            {
+                navigation.latitude = -navigation.latitude;
+            }
+            break;
+        case 5:
+            // Longitude
+            navigation.longitude = numeric_type::longitude(m_buffer.get(), m_buffer.size());
+            break;
+        case 6:
+            // Longitude East/West
+            if (m_buffer.at(0) == 'W')
+            {
+                navigation.longitude = -navigation.longitude;
+            }
+            break;
+        case 7:
+            // Speed over ground, knots.
+            navigation.speed_knots = (unsigned short)_detail::string_to_fixed(m_buffer.get(), 2);
+            break;
+        case 8:
+            // Course over ground, degrees true.
+            navigation.course = (unsigned short)_detail::string_to_fixed(m_buffer.get(), 2);
+            break;
+        case 9:
+            // Date, ddmmyy.
+            navigation.date = _detail::parse_date(m_buffer.get(), m_buffer.size());
+            break;
+        case 10:
+        case 11:
+        case 12:
+        case 13:
+            break; // Ignore magnetic variation, mode and navigational status.
+        default:
+            // Set bad to indicate unexpected message format.
+            set_bad_format();
+        }
+    }
+
+    /// @brief Process GSV message fields into the attached satellite table. Fields after the first three are groups of
+    /// PRN, elevation, azimuth and SNR for up to four satellites, optionally followed by a signal ID (NMEA 4.10).
+    template <typename _Policy> void BasicMicroGps<_Policy>::process_gsv_fields(_detail::EnabledTag<true>)
+    {
+        GpsSatelliteTable *satellites = this->satellites();
+
+        switch (m_field_num)
+        {
+        case 0:
+        case 3:
+            break; // Ignore address and satellites in view.
+        case 1:
+            // Total number of parts in the cycle.
+            satellites->begin_part(m_talker, (unsigned char)_detail::string_to_int(m_buffer.get()));
+            break;
+        case 2:
+            // Number of this part.
+            satellites->set_part_number((unsigned char)_detail::string_to_int(m_buffer.get()));
+            break;
+        default:
+            if (m_field_num > 20)
+            {
+                // Set bad to indicate unexpected message format.
+                set_bad_format();
+                break;
+            }
+
+            int value = _detail::string_to_int(m_buffer.get());
+            if (value < 0)
+            {
+                value = 0;
+            }
+
+            switch ((m_field_num - 4) % 4)
+            {
+            case 0:
+                // PRN, or the signal ID when it is the last field.
+                satellites->set_prn((unsigned char)value);
+                break;
+            case 1:
+                satellites->set_elevation((unsigned char)value);
+                break;
+            case 2:
+                satellites->set_azimuth((unsigned short)value);
+                break;
+            default:
+                satellites->commit_row((unsigned char)value);
+                break;
+            }
+        }
+    }
+
+    /// @brief Process GSA message fields.
+    template <typename _Policy> void BasicMicroGps<_Policy>::process_gsa_fields(_detail::EnabledTag<true>)
+    {
+        GpsSolution &solution = this->solution();
+
+        switch (m_field_num)
+        {
+        case 0: {
+            // Receivers send one GSA per constellation in system ID order, so a constellation at or before the last one
+            // merged starts the next cycle. GN sentences name their constellation in field 18 instead.
+            unsigned char last = m_solution_system & 0x0F;
+            unsigned char system = m_talker != Talker::GNSS ? (unsigned char)m_talker : 0;
+            if (system != 0 && system <= last && last != 0x0F)
+            {
+                m_solution_system = (unsigned char)(last << 4);
+                last = 0;
+            }
+
+            if (last == 0)
+            {
+                solution = {};
+                m_solution_system = (unsigned char)((m_solution_system & 0xF0) | 0x0F);
+            }
+            if (system != 0)
+            {
+                set_solution_system(system);
+            }
+            break;
+        }
+        case 1:
+            // Mode, A = automatic, M = manual.
+            solution.mode = m_buffer.at(0);
+            break;
+        case 2:
+            // Fix type
+            solution.fix_type = (unsigned char)_detail::string_to_int(m_buffer.get());
+            break;
+        case 15:
+            // PDOP
+            solution.pdop = (unsigned short)_detail::string_to_fixed(m_buffer.get(), 2);
+            break;
+        case 16:
+            // HDOP
+            solution.hdop = (unsigned short)_detail::string_to_fixed(m_buffer.get(), 2);
+            break;
+        case 17:
+            // VDOP
+            solution.vdop = (unsigned short)_detail::string_to_fixed(m_buffer.get(), 2);
+            break;
+        case 18:
+            // System ID, 1 = GPS to 6 = NavIC as in Talker.
+            if (m_talker == Talker::GNSS)
+            {
+                int system = _detail::string_to_int(m_buffer.get());
+                if (system > 0 && system < 0x0F)
+                {
+                    // This GN sentence started the next cycle, but its satellites are already merged. Learn the last
+                    // constellation of the cycle so later cycles start on time.
+                    unsigned char last = m_solution_system & 0x0F;
+                    if (last != 0x0F && system <= last)
+                    {
+                        m_solution_system = (unsigned char)((last << 4) | last);
+                    }
+                    set_solution_system((unsigned char)system);
+                }
+            }
+            break;
+        default:
+            if (m_field_num > 18)
+            {
+                // Set bad to indicate unexpected message format.
+                set_bad_format();
+            }
+            else if (m_buffer.at(0) != 0)
+            {
+                // Fields 3 to 14 are satellites used in the solution.
+                int prn = _detail::string_to_int(m_buffer.get());
+                if (prn > 0 && prn < 256)
+                {
+                    solution.active[prn >> 3] |= (unsigned char)(1 << (prn & 0x07));
+                }
+            }
+        }
+    }
+
+    /// @brief Process PMTK001 acknowledge message fields.
+    template <typename _Policy> void BasicMicroGps<_Policy>::process_pmtk_ack_fields(_detail::EnabledTag<true>)
+    {
+        GpsAck &ack = this->ack();
+
+        switch (m_field_num)
+        {
+        case 0:
+            // Reset acknowledge data on first message.
+            ack = {};
+            break;
+        case 1:
+            // Command being acknowledged.
+            ack.command = (unsigned short)_detail::string_to_int(m_buffer.get());
+            break;
+        case 2: {
+            // Flag, 0 = invalid, 1 = unsupported, 2 = failed, 3 = succeeded.
+            int flag = _detail::string_to_int(m_buffer.get());
+            ack.status = (flag >= 0 && flag <= 3) ? (AckStatus)flag : AckStatus::Invalid;
+            break;
+        }
+        default:
+            // Set bad to indicate unexpected message format.
+            set_bad_format();
+        }
+    }
+
+    /// @brief Process the checksum. Sets the bad bit if the computed checksum does not match the message checksum.
+    /// Assumes message checksum is only 2 hex characters.
+    template <typename _Policy> void BasicMicroGps<_Policy>::process_checksum()
+    {
+        if (m_buffer.size() > 2)
+        {
+            m_state_bit_flags = _detail::set_flag(m_state_bit_flags, StateBits::BadBit);
+            this->count_checksum_error();
+            return;
+        }
+
+        char msg_checksum = (_detail::from_hex(m_buffer.at(0)) << 4) | _detail::from_hex(m_buffer.at(1));
+
+        if (msg_checksum != m_checksum)
+        {
+            m_state_bit_flags = _detail::set_flag(m_state_bit_flags, StateBits::BadBit);
+            this->count_checksum_error();
+        }
+    }
+
 } // namespace gps
 } // namespace scottz0r
 
@@ -0,0 +1,213 @@
+/// @file MicroGps batch module.
+///
+/// This module defines a fixed capacity, column oriented batch of position records for analytics, so vectorized code
+/// can consume parser output without transposing records.
+#ifndef _SCOTTZ0R_GPS_BATCH_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_BATCH_INCLUDE_GUARD
+
+#include "MicroGps.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Alignment of each column of a batch, in bytes. One cache line, which also covers the widest vector registers.
+    constexpr size_type batch_alignment = 64;
+
+    /// Number of columns in a position batch, one per PositionField.
+    constexpr size_type batch_columns = 8;
+
+    /// @brief Fixed capacity structure of arrays of position records.
+    ///
+    /// Each field of the position record is a separate array aligned to batch_alignment. Empty fields are recorded in
+    /// a validity bitmap per column (bit i % 8 of byte i / 8), and read as zero in the value column. Nothing is
+    /// allocated; the batch is filled with append() or fill_batch() and reused after clear(). The batch is over
+    /// aligned, so before C++17 it must be a static or automatic variable rather than allocated with new.
+    ///
+    /// @tparam _Capacity Maximum number of records.
+    /// @tparam _Numeric Representation of coordinates and values, which must match the parser policy.
+    template <size_type _Capacity, typename _Numeric = FloatNumeric> class BasicGpsPositionBatch
+    {
+        static_assert(_Capacity > 0, "Batch capacity must not be zero");
+
+    public:
+        using coordinate_type = typename _Numeric::coordinate_type;
+        using value_type = typename _Numeric::value_type;
+        using position_type = BasicGpsPosition<_Numeric>;
+
+        /// Number of bytes in the validity bitmap of a column.
+        static constexpr size_type bitmap_size = (_Capacity + 7) / 8;
+
+        BasicGpsPositionBatch() : m_size(0), m_valid()
+        {
+        }
+
+        /// @brief Append a record to the end of the batch.
+        ///
+        /// @return False if the batch is full.
+        bool append(const position_type &position)
+        {
+            if (m_size == _Capacity)
+            {
+                return false;
+            }
+
+            size_type i = m_size;
+            m_time_ms[i] = position.time_ms;
+            m_latitude[i] = position.latitude;
+            m_longitude[i] = position.longitude;
+            m_fix_quality[i] = position.fix_quality;
+            m_number_satellites[i] = position.number_satellites;
+            m_horizontal_dilution[i] = position.horizontal_dilution;
+            m_altitude_msl[i] = position.altitude_msl;
+            m_geoid_height[i] = position.geoid_height;
+
+            // Bitmaps are cleared by clear(), so only set bits need to be written.
+            unsigned char bit = (unsigned char)(1 << (i & 0x07));
+            for (size_type column = 0; column < batch_columns; ++column)
+            {
+                if (position.fields & (1 << column))
+                {
+                    m_valid[column][i >> 3] |= bit;
+                }
+            }
+
+            ++m_size;
+            return true;
+        }
+
+        /// @brief Remove all records and reset the validity bitmaps.
+        void clear()
+        {
+            for (size_type column = 0; column < batch_columns; ++column)
+            {
+                for (size_type i = 0; i < (m_size + 7) / 8; ++i)
+                {
+                    m_valid[column][i] = 0;
+                }
+            }
+            m_size = 0;
+        }
+
+        /// @brief Get the number of records in the batch.
+        inline size_type size() const
+        {
+            return m_size;
+        }
+
+        /// @brief Get the maximum number of records in the batch.
+        constexpr size_type capacity() const
+        {
+            return _Capacity;
+        }
+
+        /// @brief Returns true if no more records can be appended.
+        inline bool full() const
+        {
+            return m_size == _Capacity;
+        }
+
+        /// @brief Returns true if the field of the record at index was not empty.
+        inline bool is_valid(PositionField field, size_type index) const
+        {
+            return (m_valid[(size_type)field][index >> 3] >> (index & 0x07)) & 0x01;
+        }
+
+        /// @brief Get the validity bitmap of a column. Bit (i % 8) of byte (i / 8) is set if record i has the field.
+        inline const unsigned char *validity(PositionField field) const
+        {
+            return m_valid[(size_type)field];
+        }
+
+        /// @brief Get the UTC time of day column, in milliseconds since midnight.
+        inline const uint32_t *time_ms() const
+        {
+            return m_time_ms;
+        }
+
+        /// @brief Get the latitude column.
+        inline const coordinate_type *latitude() const
+        {
+            return m_latitude;
+        }
+
+        /// @brief Get the longitude column.
+        inline const coordinate_type *longitude() const
+        {
+            return m_longitude;
+        }
+
+        /// @brief Get the fix quality column.
+        inline const unsigned char *fix_quality() const
+        {
+            return m_fix_quality;
+        }
+
+        /// @brief Get the number of satellites column.
+        inline const unsigned char *number_satellites() const
+        {
+            return m_number_satellites;
+        }
+
+        /// @brief Get the horizontal dilution column.
+        inline const value_type *horizontal_dilution() const
+        {
+            return m_horizontal_dilution;
+        }
+
+        /// @brief Get the altitude above mean sea level column.
+        inline const value_type *altitude_msl() const
+        {
+            return m_altitude_msl;
+        }
+
+        /// @brief Get the geoid height column.
+        inline const value_type *geoid_height() const
+        {
+            return m_geoid_height;
+        }
+
+    private:
+        alignas(batch_alignment) uint32_t m_time_ms[_Capacity];
+        alignas(batch_alignment) coordinate_type m_latitude[_Capacity];
+        alignas(batch_alignment) coordinate_type m_longitude[_Capacity];
+        alignas(batch_alignment) value_type m_horizontal_dilution[_Capacity];
+        alignas(batch_alignment) value_type m_altitude_msl[_Capacity];
+        alignas(batch_alignment) value_type m_geoid_height[_Capacity];
+        alignas(batch_alignment) unsigned char m_fix_quality[_Capacity];
+        alignas(batch_alignment) unsigned char m_number_satellites[_Capacity];
+        size_type m_size;
+        unsigned char m_valid[batch_columns][bitmap_size];
+    };
+
+    /// Position batch with the representation of MicroGps.
+    template <size_type _Capacity> using GpsPositionBatch = BasicGpsPositionBatch<_Capacity, FloatNumeric>;
+
+    /// @brief Parse NMEA data into a batch, appending the position of every good GGA sentence until the data runs out
+    /// or the batch is full. The caller consumes a full batch, clears it and resumes at the returned offset.
+    ///
+    /// @param batch Batch to append to.
+    /// @param gps Parser. Its state carries over between calls, so a sentence can be split across blocks.
+    /// @param data NMEA data.
+    /// @param size Number of characters in data.
+    /// @return Number of characters consumed.
+    template <size_type _Capacity, typename _Policy>
+    size_type fill_batch(BasicGpsPositionBatch<_Capacity, typename _Policy::numeric_type> &batch,
+                         BasicMicroGps<_Policy> &gps, const char *data, size_type size)
+    {
+        size_type offset = 0;
+        while (offset < size && !batch.full())
+        {
+            offset += gps.process_until_complete(data + offset, size - offset);
+            if (gps.complete() && gps.good() && gps.message_type() == MessageType::GGA)
+            {
+                batch.append(gps.position_data());
+            }
+        }
+        return offset;
+    }
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_BATCH_INCLUDE_GUARD
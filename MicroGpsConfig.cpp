@@ -0,0 +1,210 @@
+/// @file Receiver configuration command implementation.
+#include "MicroGpsConfig.h"
+#include "MicroGpsFormat.h"
+#include "MicroUbx.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    using MessageType = MicroGps::MessageType;
+
+    /// UBX class of configuration messages, with the CFG-MSG and CFG-RATE IDs.
+    static constexpr unsigned char ubx_class_cfg = 0x06;
+    static constexpr unsigned char ubx_id_cfg_msg = 0x01;
+    static constexpr unsigned char ubx_id_cfg_rate = 0x08;
+
+    /// UBX class of standard NMEA messages, for CFG-MSG.
+    static constexpr unsigned char ubx_class_nmea = 0xF0;
+
+    /// @brief Append an unsigned decimal number to dst. Assumes dst is large enough (10 characters).
+    ///
+    /// @return A pointer to the next char in dst after formatted characters.
+    static char *append_unsigned(char *dst, unsigned long value)
+    {
+        char digits[10];
+        unsigned char count = 0;
+
+        do
+        {
+            digits[count] = (char)('0' + value % 10);
+            ++count;
+            value /= 10;
+        } while (value > 0 && count < sizeof(digits));
+
+        while (count > 0)
+        {
+            --count;
+            *dst = digits[count];
+            ++dst;
+        }
+
+        return dst;
+    }
+
+    /// @brief Encode a PMTK314 (set NMEA output) sentence that enables exactly the given message types.
+    ///
+    /// @param messages Set of MicroGps::message_bit() values, such as MicroGps::decoded_messages(). GGA, RMC, GSA and
+    /// GSV are supported; GLL, VTG and the rest are always turned off.
+    /// @param rate Output every rate fixes, 1 to 5.
+    /// @param dst Destination character buffer, at least 52 characters.
+    /// @param dst_size Size of destination buffer.
+    /// @return Number of characters written, not counting the null terminator, or 0 on failure.
+    size_type encode_pmtk_output(unsigned messages, unsigned char rate, char *dst, size_type dst_size)
+    {
+        if (rate > 5)
+        {
+            return 0;
+        }
+
+        // Field order: GLL, RMC, VTG, GGA, GSA, GSV, then 13 fields this library never decodes.
+        const MessageType field_types[] = {MessageType::Unknown, MessageType::RMC, MessageType::Unknown,
+                                           MessageType::GGA,     MessageType::GSA, MessageType::GSV};
+
+        char body[48] = "PMTK314";
+        char *p_body = body + 7;
+
+        for (size_type i = 0; i < 19; ++i)
+        {
+            bool enabled = i < sizeof(field_types) / sizeof(field_types[0]) &&
+                           field_types[i] != MessageType::Unknown &&
+                           (messages & MicroGps::message_bit(field_types[i]));
+
+            *p_body = ',';
+            ++p_body;
+            *p_body = enabled ? (char)('0' + rate) : '0';
+            ++p_body;
+        }
+        *p_body = 0;
+
+        return format_nmea_sentence(body, dst, dst_size);
+    }
+
+    /// @brief Encode a PMTK220 (set position fix interval) sentence.
+    ///
+    /// @param interval_ms Time between fixes, 100 to 10000 milliseconds.
+    /// @param dst Destination character buffer.
+    /// @param dst_size Size of destination buffer.
+    /// @return Number of characters written, not counting the null terminator, or 0 on failure.
+    size_type encode_pmtk_fix_interval(unsigned long interval_ms, char *dst, size_type dst_size)
+    {
+        if (interval_ms < 100 || interval_ms > 10000)
+        {
+            return 0;
+        }
+
+        char body[16] = "PMTK220,";
+        char *p_body = append_unsigned(body + 8, interval_ms);
+        *p_body = 0;
+
+        return format_nmea_sentence(body, dst, dst_size);
+    }
+
+    /// @brief Encode a UBX frame: sync characters, header, payload and checksum.
+    ///
+    /// @param msg_class Message class.
+    /// @param msg_id Message ID.
+    /// @param payload Payload bytes, may be nullptr if payload_size is 0.
+    /// @param payload_size Number of payload bytes.
+    /// @param dst Destination buffer, at least payload_size + 8 bytes.
+    /// @param dst_size Size of destination buffer.
+    /// @return Number of bytes written, or 0 on failure.
+    size_type encode_ubx_frame(unsigned char msg_class, unsigned char msg_id, const char *payload,
+                               size_type payload_size, char *dst, size_type dst_size)
+    {
+        if (!dst || dst_size < payload_size + 8 || payload_size > ubx_max_length || (payload_size > 0 && !payload))
+        {
+            return 0;
+        }
+
+        dst[0] = (char)ubx_sync_1;
+        dst[1] = (char)ubx_sync_2;
+        dst[2] = (char)msg_class;
+        dst[3] = (char)msg_id;
+        dst[4] = (char)(payload_size & 0xFF);
+        dst[5] = (char)(payload_size >> 8);
+
+        for (size_type i = 0; i < payload_size; ++i)
+        {
+            dst[6 + i] = payload[i];
+        }
+
+        // Checksum covers everything after the sync characters.
+        unsigned char ck_a = 0;
+        unsigned char ck_b = 0;
+        for (size_type i = 2; i < payload_size + 6; ++i)
+        {
+            _detail::ubx_checksum_add((unsigned char)dst[i], ck_a, ck_b);
+        }
+
+        dst[payload_size + 6] = (char)ck_a;
+        dst[payload_size + 7] = (char)ck_b;
+
+        return payload_size + 8;
+    }
+
+    /// @brief Encode a UBX CFG-MSG command, setting the output rate of one message on the current port.
+    ///
+    /// @param msg_class Class of the configured message.
+    /// @param msg_id ID of the configured message.
+    /// @param rate Output every rate navigation solutions, 0 to disable.
+    /// @param dst Destination buffer, at least 11 bytes.
+    /// @param dst_size Size of destination buffer.
+    /// @return Number of bytes written, or 0 on failure.
+    size_type encode_ubx_cfg_msg(unsigned char msg_class, unsigned char msg_id, unsigned char rate, char *dst,
+                                 size_type dst_size)
+    {
+        const char payload[] = {(char)msg_class, (char)msg_id, (char)rate};
+        return encode_ubx_frame(ubx_class_cfg, ubx_id_cfg_msg, payload, sizeof(payload), dst, dst_size);
+    }
+
+    /// @brief Encode a UBX CFG-RATE command.
+    ///
+    /// @param measurement_ms Time between measurements in milliseconds.
+    /// @param navigation_rate Measurements per navigation solution.
+    /// @param time_ref Time reference, 0 = UTC, 1 = GPS.
+    /// @param dst Destination buffer, at least 14 bytes.
+    /// @param dst_size Size of destination buffer.
+    /// @return Number of bytes written, or 0 on failure.
+    size_type encode_ubx_cfg_rate(uint16_t measurement_ms, uint16_t navigation_rate, uint16_t time_ref, char *dst,
+                                  size_type dst_size)
+    {
+        const char payload[] = {(char)(measurement_ms & 0xFF),  (char)(measurement_ms >> 8),
+                                (char)(navigation_rate & 0xFF), (char)(navigation_rate >> 8),
+                                (char)(time_ref & 0xFF),        (char)(time_ref >> 8)};
+        return encode_ubx_frame(ubx_class_cfg, ubx_id_cfg_rate, payload, sizeof(payload), dst, dst_size);
+    }
+
+    /// @brief Encode UBX CFG-MSG commands for the standard NMEA messages (GGA, GLL, GSA, GSV, RMC and VTG), enabling
+    /// exactly the given message types and disabling the rest.
+    ///
+    /// @param messages Set of MicroGps::message_bit() values, such as MicroGps::decoded_messages().
+    /// @param rate Output rate of enabled messages.
+    /// @param dst Destination buffer, at least 66 bytes (6 commands of 11 bytes).
+    /// @param dst_size Size of destination buffer.
+    /// @return Number of bytes written, or 0 on failure.
+    size_type encode_ubx_nmea_output(unsigned messages, unsigned char rate, char *dst, size_type dst_size)
+    {
+        // UBX message IDs in class 0xF0 and the matching MicroGps type.
+        const unsigned char ids[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05};
+        const MessageType types[] = {MessageType::GGA, MessageType::Unknown, MessageType::GSA,
+                                     MessageType::GSV, MessageType::RMC,     MessageType::Unknown};
+
+        size_type count = sizeof(ids) / sizeof(ids[0]);
+        if (!dst || dst_size < count * 11)
+        {
+            return 0;
+        }
+
+        size_type size = 0;
+        for (size_type i = 0; i < count; ++i)
+        {
+            bool enabled = types[i] != MessageType::Unknown && (messages & MicroGps::message_bit(types[i]));
+            size += encode_ubx_cfg_msg(ubx_class_nmea, ids[i], enabled ? rate : 0, dst + size, dst_size - size);
+        }
+
+        return size;
+    }
+
+} // namespace gps
+} // namespace scottz0r
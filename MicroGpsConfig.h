@@ -0,0 +1,35 @@
+/// @file Receiver configuration command definitions.
+///
+/// This module defines encoders for receiver configuration commands, so receivers can be told to only send the
+/// sentences that will be decoded. All encoders write into a caller supplied buffer and return the number of bytes
+/// written, or 0 if the buffer is too small.
+#ifndef _SCOTTZ0R_GPS_CONFIG_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_CONFIG_INCLUDE_GUARD
+
+#include "MicroGps.h"
+#include "MicroGpsTypes.h"
+#include <stdint.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    size_type encode_pmtk_output(unsigned messages, unsigned char rate, char *dst, size_type dst_size);
+
+    size_type encode_pmtk_fix_interval(unsigned long interval_ms, char *dst, size_type dst_size);
+
+    size_type encode_ubx_frame(unsigned char msg_class, unsigned char msg_id, const char *payload,
+                               size_type payload_size, char *dst, size_type dst_size);
+
+    size_type encode_ubx_cfg_msg(unsigned char msg_class, unsigned char msg_id, unsigned char rate, char *dst,
+                                 size_type dst_size);
+
+    size_type encode_ubx_cfg_rate(uint16_t measurement_ms, uint16_t navigation_rate, uint16_t time_ref, char *dst,
+                                  size_type dst_size);
+
+    size_type encode_ubx_nmea_output(unsigned messages, unsigned char rate, char *dst, size_type dst_size);
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_CONFIG_INCLUDE_GUARD
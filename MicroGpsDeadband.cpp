@@ -0,0 +1,62 @@
+/// @file Deadband filter implementation.
+#include "MicroGpsDeadband.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Both coordinates, which together make a usable position.
+    static constexpr unsigned char coordinate_fields =
+        position_field_bit(PositionField::Latitude) | position_field_bit(PositionField::Longitude);
+
+    /// @brief Initialize the filter. The first fix is always forwarded.
+    ///
+    /// @param distance_m Movement from the last forwarded fix, in meters, above which a fix is forwarded.
+    /// @param heartbeat_ms Longest time between forwarded fixes, or 0 to forward on change only.
+    GpsDeadbandFilter::GpsDeadbandFilter(float distance_m, unsigned long heartbeat_ms)
+        : m_last({}), m_distance_squared(distance_m * distance_m), m_heartbeat_ms(heartbeat_ms), m_last_ms(0),
+          m_suppressed(0), m_started(false)
+    {
+    }
+
+    /// @brief Filter a fix.
+    ///
+    /// @param position Fix to filter.
+    /// @param now_ms Current time in milliseconds, used for the heartbeat. May wrap.
+    /// @return True if the fix should be forwarded. It is then available from last().
+    bool GpsDeadbandFilter::update(const GpsPosition &position, unsigned long now_ms)
+    {
+        bool has_coordinates = (position.fields & coordinate_fields) == coordinate_fields;
+        bool forward = !m_started || position.fix_quality != m_last.fix_quality ||
+                       position.number_satellites != m_last.number_satellites ||
+                       (position.fields & coordinate_fields) != (m_last.fields & coordinate_fields) ||
+                       (m_heartbeat_ms != 0 && now_ms - m_last_ms >= m_heartbeat_ms) ||
+                       (has_coordinates &&
+                        m_frame.distance_squared(position.latitude, position.longitude) > m_distance_squared);
+
+        if (!forward)
+        {
+            ++m_suppressed;
+            return false;
+        }
+
+        m_last = position;
+        m_last_ms = now_ms;
+        m_started = true;
+        if (has_coordinates)
+        {
+            m_frame.reset(position.latitude, position.longitude);
+        }
+        return true;
+    }
+
+    /// @brief Forget the last forwarded fix, so the next fix is forwarded.
+    void GpsDeadbandFilter::reset()
+    {
+        m_last = {};
+        m_suppressed = 0;
+        m_started = false;
+    }
+
+} // namespace gps
+} // namespace scottz0r
@@ -0,0 +1,55 @@
+/// @file Deadband filter definition module.
+///
+/// This module defines the GpsDeadbandFilter class, which drops fixes that repeat the last forwarded fix, so a
+/// stationary receiver does not fill storage and links with identical records.
+#ifndef _SCOTTZ0R_GPS_DEADBAND_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_DEADBAND_INCLUDE_GUARD
+
+#include "MicroGps.h"
+#include "MicroGpsGeo.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// @brief Streaming filter that forwards a fix only when it differs from the last forwarded fix.
+    ///
+    /// A fix is forwarded if it is the first, if it moved more than the distance threshold from the last forwarded
+    /// fix, if its fix quality, satellite count or set of present coordinates changed, or if the heartbeat interval
+    /// has passed since the last forwarded fix. Distances are measured in a GpsLocalFrame at the last forwarded fix,
+    /// so filtering a fix takes no trigonometry.
+    class GpsDeadbandFilter
+    {
+    public:
+        GpsDeadbandFilter(float distance_m = 5, unsigned long heartbeat_ms = 60000);
+
+        bool update(const GpsPosition &position, unsigned long now_ms);
+
+        void reset();
+
+        /// @brief Get the last forwarded fix. Valid after update() returned true once.
+        inline const GpsPosition &last() const
+        {
+            return m_last;
+        }
+
+        /// @brief Get the number of fixes dropped since construction or reset().
+        inline unsigned long suppressed() const
+        {
+            return m_suppressed;
+        }
+
+    private:
+        GpsLocalFrame m_frame;
+        GpsPosition m_last;
+        float m_distance_squared;
+        unsigned long m_heartbeat_ms;
+        unsigned long m_last_ms;
+        unsigned long m_suppressed;
+        bool m_started;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_DEADBAND_INCLUDE_GUARD
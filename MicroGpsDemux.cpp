@@ -0,0 +1,298 @@
+/// @file Frame demultiplexer implementation.
+#include "MicroGpsDemux.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Longest NMEA sentence accepted. The standard limit is 82 characters, some receivers exceed it.
+    static constexpr uint16_t nmea_max_length = 128;
+
+    /// Bytes of RTCM3 framing around the payload: preamble, two length bytes and three CRC bytes.
+    static constexpr uint16_t rtcm3_overhead = 6;
+
+    /// Bytes of UBX framing around the payload: two sync, class, ID, two length bytes and two checksum bytes.
+    static constexpr uint16_t ubx_overhead = 8;
+
+    namespace _detail
+    {
+        /// @brief Add a byte to a running CRC-24Q (Qualcomm, polynomial 0x1864CFB) as used by RTCM3. Bitwise to avoid a
+        /// 1 KB table on small devices. A frame followed by its CRC sums to 0.
+        uint32_t crc24q_update(uint32_t crc, unsigned char byte)
+        {
+            crc ^= (uint32_t)byte << 16;
+            for (unsigned char i = 0; i < 8; ++i)
+            {
+                crc <<= 1;
+                if (crc & 0x1000000)
+                {
+                    crc ^= 0x1864CFB;
+                }
+            }
+
+            return crc & 0xFFFFFF;
+        }
+
+        /// @brief Compute the CRC-24Q of a block of bytes.
+        uint32_t crc24q(const char *data, size_type size)
+        {
+            uint32_t crc = 0;
+            for (size_type i = 0; i < size; ++i)
+            {
+                crc = crc24q_update(crc, (unsigned char)data[i]);
+            }
+
+            return crc;
+        }
+    } // namespace _detail
+
+    using namespace scottz0r::gps::_detail;
+
+    /// @brief Initialize the demultiplexer. Frames without a parser are skipped.
+    ///
+    /// @param nmea Parser for NMEA sentences, or nullptr. Must outlive this instance.
+    /// @param ubx Parser for UBX messages, or nullptr. Must outlive this instance.
+    GpsFrameDemux::GpsFrameDemux(MicroGps *nmea, MicroUbx *ubx)
+        : m_nmea(nmea), m_ubx(ubx), m_handler(nullptr), m_context(nullptr), m_buffer(nullptr), m_buffer_size(0),
+          m_crc(0), m_length(0), m_count(0), m_state(State::Idle), m_frame_type(FrameType::Unknown), m_bad(false)
+    {
+    }
+
+    /// @brief Set where RTCM3 frames are forwarded. Frames that do not fit the buffer are validated but only forwarded
+    /// when process_until_complete() finds them whole in its input. A frame is at most 1029 bytes.
+    ///
+    /// @param handler Function called with each valid frame, or nullptr.
+    /// @param context Passed to the handler.
+    /// @param buffer Storage for frames split across calls, or nullptr.
+    /// @param buffer_size Size of buffer.
+    void GpsFrameDemux::set_rtcm_handler(FrameHandler handler, void *context, char *buffer, size_type buffer_size)
+    {
+        m_handler = handler;
+        m_context = context;
+        m_buffer = buffer;
+        m_buffer_size = buffer ? buffer_size : 0;
+    }
+
+    /// @brief Process a byte of the stream.
+    ///
+    /// @param c Byte to process.
+    /// @return True if a frame completed. Use frame_type() and good(), and the parser for NMEA and UBX data.
+    bool GpsFrameDemux::process(char c)
+    {
+        switch (m_state)
+        {
+        case State::Nmea:
+            return process_nmea(c);
+
+        case State::UbxSync:
+            if ((unsigned char)c == ubx_sync_2)
+            {
+                if (m_ubx)
+                {
+                    m_ubx->process(c);
+                }
+                m_count = 2;
+                m_state = State::Ubx;
+                return false;
+            }
+
+            // Lone 0xB5. Classify this byte again.
+            m_state = State::Idle;
+            return process_idle(c);
+
+        case State::Ubx:
+            return process_ubx(c);
+
+        case State::Rtcm:
+            return process_rtcm(c);
+
+        default:
+            return process_idle(c);
+        }
+    }
+
+    /// @brief Process bytes until a frame completes or the input is exhausted. The caller handles the frame and then
+    /// resumes at the returned offset. RTCM3 frames found whole in the input are checked and forwarded in place.
+    ///
+    /// @param data Bytes to process.
+    /// @param size Number of bytes in data.
+    /// @return Number of bytes consumed. A frame is complete whenever the return is less than size, or if process()
+    /// returned true for the last consumed byte.
+    size_type GpsFrameDemux::process_until_complete(const char *data, size_type size)
+    {
+        size_type i = 0;
+        while (i < size)
+        {
+            if (m_state == State::Idle && (unsigned char)data[i] == rtcm3_preamble && size - i >= 3 &&
+                ((unsigned char)data[i + 1] & 0xFC) == 0)
+            {
+                size_type length =
+                    rtcm3_overhead + ((((unsigned char)data[i + 1] & 0x03) << 8) | (unsigned char)data[i + 2]);
+
+                if (size - i >= length)
+                {
+                    m_frame_type = FrameType::Rtcm3;
+                    m_bad = crc24q(data + i, length) != 0;
+                    if (!m_bad && m_handler)
+                    {
+                        m_handler(data + i, length, m_context);
+                    }
+                    return i + length;
+                }
+            }
+
+            if (process(data[i]))
+            {
+                return i + 1;
+            }
+            ++i;
+        }
+
+        return size;
+    }
+
+    /// @brief Classify the first byte of a frame.
+    bool GpsFrameDemux::process_idle(char c)
+    {
+        switch ((unsigned char)c)
+        {
+        case '$':
+            m_state = State::Nmea;
+            return process_nmea(c);
+
+        case ubx_sync_1:
+            if (m_ubx)
+            {
+                m_ubx->process(c);
+            }
+            m_state = State::UbxSync;
+            return false;
+
+        case rtcm3_preamble:
+            m_state = State::Rtcm;
+            m_count = 0;
+            m_crc = 0;
+            return process_rtcm(c);
+
+        default:
+            // Not part of any frame.
+            return false;
+        }
+    }
+
+    /// @brief Route a NMEA byte. Bytes that cannot appear in a sentence end it and are classified again.
+    bool GpsFrameDemux::process_nmea(char c)
+    {
+        unsigned char b = (unsigned char)c;
+
+        if (c == '$')
+        {
+            m_count = 0;
+        }
+
+        ++m_count;
+        if (b >= 0x80 || (b < 0x20 && c != '\r' && c != '\n') || m_count > nmea_max_length)
+        {
+            m_state = State::Idle;
+            return process_idle(c);
+        }
+
+        bool result = m_nmea ? m_nmea->process(c) : false;
+
+        if (c == '\n')
+        {
+            m_state = State::Idle;
+        }
+
+        if (result)
+        {
+            m_frame_type = FrameType::Nmea;
+            m_bad = m_nmea->bad();
+        }
+
+        return result;
+    }
+
+    /// @brief Route a UBX byte, tracking the frame length from the header.
+    bool GpsFrameDemux::process_ubx(char c)
+    {
+        unsigned char b = (unsigned char)c;
+        bool result = m_ubx ? m_ubx->process(c) : false;
+
+        ++m_count;
+        if (m_count == 5)
+        {
+            m_length = b;
+        }
+        else if (m_count == 6)
+        {
+            m_length |= (uint16_t)(b << 8);
+            if (m_length > ubx_max_length)
+            {
+                // False sync in other data.
+                m_state = State::Idle;
+                return false;
+            }
+            m_length += ubx_overhead;
+        }
+        else if (m_count > 6 && m_count == m_length)
+        {
+            m_state = State::Idle;
+            if (result)
+            {
+                m_frame_type = FrameType::Ubx;
+                m_bad = m_ubx->bad();
+            }
+            return result;
+        }
+
+        return false;
+    }
+
+    /// @brief Collect a RTCM3 byte into the buffer and CRC, forwarding the frame when complete.
+    bool GpsFrameDemux::process_rtcm(char c)
+    {
+        unsigned char b = (unsigned char)c;
+
+        if (m_count == 1)
+        {
+            // Six reserved bits must be zero, otherwise 0xD3 was just a data byte.
+            if (b & 0xFC)
+            {
+                m_state = State::Idle;
+                return process_idle(c);
+            }
+            m_length = (uint16_t)((b & 0x03) << 8);
+        }
+        else if (m_count == 2)
+        {
+            m_length = rtcm3_overhead + (m_length | b);
+        }
+
+        if (m_count < m_buffer_size)
+        {
+            m_buffer[m_count] = c;
+        }
+
+        m_crc = crc24q_update(m_crc, b);
+        ++m_count;
+
+        if (m_count < 3 || m_count < m_length)
+        {
+            return false;
+        }
+
+        m_state = State::Idle;
+        m_frame_type = FrameType::Rtcm3;
+        m_bad = m_crc != 0;
+
+        if (!m_bad && m_handler && m_length <= m_buffer_size)
+        {
+            m_handler(m_buffer, m_length, m_context);
+        }
+
+        return true;
+    }
+
+} // namespace gps
+} // namespace scottz0r
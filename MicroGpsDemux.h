@@ -0,0 +1,111 @@
+/// @file Frame demultiplexer definition module.
+///
+/// This module defines the GpsFrameDemux class, which splits a serial stream carrying interleaved NMEA, UBX and RTCM3
+/// frames and routes each frame to its parser.
+#ifndef _SCOTTZ0R_GPS_DEMUX_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_DEMUX_INCLUDE_GUARD
+
+#include "MicroGps.h"
+#include "MicroGpsTypes.h"
+#include "MicroUbx.h"
+#include <stdint.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// RTCM3 preamble byte.
+    constexpr unsigned char rtcm3_preamble = 0xD3;
+
+    /// @brief Detail implementations. Do not used. Exposed for test coverage.
+    namespace _detail
+    {
+        uint32_t crc24q_update(uint32_t crc, unsigned char byte);
+
+        uint32_t crc24q(const char *data, size_type size);
+    } // namespace _detail
+
+    /// @brief Splits a byte stream into NMEA, UBX and RTCM3 frames and routes each frame.
+    ///
+    /// Frames are classified by their first bytes: '$' for NMEA, 0xB5 0x62 for UBX and 0xD3 for RTCM3. NMEA bytes are
+    /// passed to a MicroGps and UBX bytes to a MicroUbx as they arrive, so those frames are never copied, and binary
+    /// frames never reach the NMEA parser. RTCM3 frames are length and CRC-24Q checked, then forwarded untouched to a
+    /// handler. RTCM3 bytes are copied once, into the caller's buffer, unless process_until_complete() finds the whole
+    /// frame in its input, in which case the handler gets a pointer into the input.
+    class GpsFrameDemux
+    {
+        enum class State : unsigned char
+        {
+            Idle,
+            Nmea,
+            UbxSync,
+            Ubx,
+            Rtcm
+        };
+
+    public:
+        /// @brief Frame types the demultiplexer recognizes.
+        enum class FrameType : unsigned char
+        {
+            Nmea,
+            Ubx,
+            Rtcm3,
+            Unknown
+        };
+
+        /// @brief Receives a validated RTCM3 frame, including preamble, header and CRC.
+        using FrameHandler = void (*)(const char *data, size_type size, void *context);
+
+        GpsFrameDemux(MicroGps *nmea, MicroUbx *ubx);
+
+        void set_rtcm_handler(FrameHandler handler, void *context, char *buffer, size_type buffer_size);
+
+        bool process(char c);
+
+        size_type process_until_complete(const char *data, size_type size);
+
+        /// @brief Get the type of the last completed frame.
+        inline FrameType frame_type() const
+        {
+            return m_frame_type;
+        }
+
+        /// @brief Returns true if the last completed frame is invalid. For NMEA and UBX this is the parser's result.
+        inline bool bad() const
+        {
+            return m_bad;
+        }
+
+        /// @brief Returns true if the last completed frame was valid.
+        inline bool good() const
+        {
+            return !bad();
+        }
+
+    private:
+        bool process_idle(char c);
+
+        bool process_nmea(char c);
+
+        bool process_ubx(char c);
+
+        bool process_rtcm(char c);
+
+        MicroGps *m_nmea;
+        MicroUbx *m_ubx;
+        FrameHandler m_handler;
+        void *m_context;
+        char *m_buffer;
+        size_type m_buffer_size;
+        uint32_t m_crc;
+        uint16_t m_length; // Total frame length, once known.
+        uint16_t m_count;  // Bytes of the current frame seen so far.
+        State m_state;
+        FrameType m_frame_type;
+        bool m_bad;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_DEMUX_INCLUDE_GUARD
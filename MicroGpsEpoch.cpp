@@ -0,0 +1,178 @@
+/// @file Epoch assembly implementation.
+#include "MicroGpsEpoch.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// @brief Initialize the assembler with no open epoch.
+    ///
+    /// @param required Set of MicroGps::message_bit() values that complete an epoch.
+    /// @param timeout_ms Age at which poll() emits an incomplete epoch.
+    GpsEpochAssembler::GpsEpochAssembler(unsigned required, unsigned long timeout_ms)
+        : m_epoch({}), m_pending({}), m_required(required), m_timeout_ms(timeout_ms), m_opened_ms(0),
+          m_state_bit_flags(0)
+    {
+    }
+
+    /// @brief Merge the last message parsed by gps into the epoch being assembled. Call after MicroGps::process()
+    /// returns true. Bad and unsupported messages are ignored.
+    ///
+    /// @param gps Parser holding a completed message.
+    /// @param now_ms Current time in milliseconds, used for the timeout.
+    /// @return True if an epoch was emitted and is available from epoch().
+    bool GpsEpochAssembler::update(const MicroGps &gps, unsigned long now_ms)
+    {
+        if (gps.bad())
+        {
+            return false;
+        }
+
+        uint32_t time_ms;
+        bool timed = gps.has_time();
+        switch (gps.message_type())
+        {
+        case MicroGps::MessageType::GGA:
+            time_ms = gps.position_data().time_ms;
+            break;
+        case MicroGps::MessageType::RMC:
+            time_ms = gps.navigation_data().time_ms;
+            break;
+        case MicroGps::MessageType::GSA:
+            // Untimed. Belongs to the open epoch, or is a straggler of the one already emitted.
+            if (!(m_state_bit_flags & (unsigned char)StateBits::OpenBit))
+            {
+                return false;
+            }
+            time_ms = m_pending.time_ms;
+            timed = !(m_state_bit_flags & (unsigned char)StateBits::UntimedBit);
+            break;
+        default:
+            return false;
+        }
+
+        bool emitted = false;
+        unsigned sentence = MicroGps::message_bit(gps.message_type());
+
+        if (m_state_bit_flags & (unsigned char)StateBits::OpenBit)
+        {
+            // A new timestamp is an epoch boundary. Without times, a repeated message type is the boundary instead.
+            bool boundary;
+            if (m_state_bit_flags & (unsigned char)StateBits::UntimedBit)
+            {
+                boundary = timed || (m_pending.sentences & sentence);
+            }
+            else
+            {
+                boundary = !timed || time_ms != m_pending.time_ms;
+            }
+
+            // Emit what was collected and start over with this message.
+            if (boundary)
+            {
+                emit();
+                emitted = true;
+                open(time_ms, now_ms, timed);
+            }
+        }
+        else
+        {
+            // Drop stragglers for an epoch that was already emitted. Untimed sentences cannot be matched to one.
+            if (timed && (m_state_bit_flags & (unsigned char)StateBits::EmittedBit) && time_ms == m_epoch.time_ms)
+            {
+                return false;
+            }
+
+            open(time_ms, now_ms, timed);
+        }
+
+        switch (gps.message_type())
+        {
+        case MicroGps::MessageType::GGA:
+            m_pending.position = gps.position_data();
+            break;
+        case MicroGps::MessageType::RMC:
+            m_pending.navigation = gps.navigation_data();
+            break;
+        case MicroGps::MessageType::GSA:
+            m_pending.solution = gps.solution_data();
+            break;
+        default:
+            break;
+        }
+        m_pending.sentences |= sentence;
+
+        if ((m_pending.sentences & m_required) == m_required)
+        {
+            if (emitted)
+            {
+                // Only one epoch can be handed out per call. The next update() or poll() emits this one.
+                m_state_bit_flags |= (unsigned char)StateBits::ReadyBit;
+            }
+            else
+            {
+                emit();
+                emitted = true;
+            }
+        }
+
+        return emitted;
+    }
+
+    /// @brief Emit the open epoch if it is complete and waiting, or if it is older than the timeout. Should be called
+    /// periodically, such as once per loop.
+    ///
+    /// @param now_ms Current time in milliseconds.
+    /// @return True if an epoch was emitted and is available from epoch().
+    bool GpsEpochAssembler::poll(unsigned long now_ms)
+    {
+        if (!(m_state_bit_flags & (unsigned char)StateBits::OpenBit))
+        {
+            return false;
+        }
+
+        // Subtraction handles wrap around of the millisecond counter.
+        if ((m_state_bit_flags & (unsigned char)StateBits::ReadyBit) || now_ms - m_opened_ms >= m_timeout_ms)
+        {
+            emit();
+            return true;
+        }
+
+        return false;
+    }
+
+    /// @brief Start assembling a new epoch.
+    void GpsEpochAssembler::open(uint32_t time_ms, unsigned long now_ms, bool timed)
+    {
+        m_pending = {};
+        m_pending.time_ms = time_ms;
+        m_opened_ms = now_ms;
+        m_state_bit_flags |= (unsigned char)StateBits::OpenBit;
+        if (timed)
+        {
+            m_state_bit_flags &= ~(unsigned char)StateBits::UntimedBit;
+        }
+        else
+        {
+            m_state_bit_flags |= (unsigned char)StateBits::UntimedBit;
+        }
+    }
+
+    /// @brief Publish the pending epoch and close it.
+    void GpsEpochAssembler::emit()
+    {
+        m_epoch = m_pending;
+        m_state_bit_flags &= ~((unsigned char)StateBits::OpenBit | (unsigned char)StateBits::ReadyBit);
+        if (m_state_bit_flags & (unsigned char)StateBits::UntimedBit)
+        {
+            // No sentence can be a straggler of an untimed epoch.
+            m_state_bit_flags &= ~(unsigned char)StateBits::EmittedBit;
+        }
+        else
+        {
+            m_state_bit_flags |= (unsigned char)StateBits::EmittedBit;
+        }
+    }
+
+} // namespace gps
+} // namespace scottz0r
@@ -0,0 +1,84 @@
+/// @file Epoch assembly definition module.
+///
+/// This module defines the GpsEpochAssembler class, which merges the sentences a receiver emits for one fix into a
+/// single record.
+#ifndef _SCOTTZ0R_GPS_EPOCH_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_EPOCH_INCLUDE_GUARD
+
+#include "MicroGps.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// @brief Holds the merged data of all sentences sharing one timestamp.
+    struct GpsEpoch
+    {
+        uint32_t time_ms;   ///< UTC milliseconds since midnight shared by the merged sentences.
+        unsigned sentences; ///< MicroGps::message_bit() of every message merged into this record.
+        GpsPosition position;
+        GpsNavigation navigation;
+        GpsSolution solution;
+    };
+
+    /// @brief Merges sentences parsed by MicroGps into one GpsEpoch record per fix.
+    ///
+    /// Sentences are grouped by millisecond timestamp, so receivers faster than 1 Hz get one epoch per fix. An epoch is
+    /// emitted exactly once: when every required message type has been merged, when a sentence with a different
+    /// timestamp arrives, or when poll() finds it older than the timeout.
+    /// Late sentences for an epoch that was already emitted are dropped. GSA has no timestamp, so it is merged into the
+    /// open epoch, or dropped as late if no epoch is open; include GSA in the required set to wait for it. Storage is
+    /// two fixed records, so the emitted epoch stays readable while the next one is assembled.
+    ///
+    /// Receivers without a fix send GGA and RMC with an empty time (MicroGps::has_time() is false). Such sentences are
+    /// never dropped as late. They end an open timed epoch and are grouped together until a message type repeats, and
+    /// their epochs have a time_ms of 0.
+    class GpsEpochAssembler
+    {
+        enum class StateBits : unsigned char
+        {
+            OpenBit = 0x01,
+            ReadyBit = 0x02,
+            EmittedBit = 0x04,
+            UntimedBit = 0x08 ///< The open epoch is made of sentences without a time.
+        };
+
+    public:
+        GpsEpochAssembler(unsigned required = MicroGps::message_bit(MicroGps::MessageType::GGA) |
+                                              MicroGps::message_bit(MicroGps::MessageType::RMC),
+                          unsigned long timeout_ms = 1000);
+
+        bool update(const MicroGps &gps, unsigned long now_ms);
+
+        bool poll(unsigned long now_ms);
+
+        /// @brief Get the last emitted epoch. Valid after update() or poll() returns true, up to the next time either
+        /// returns true.
+        inline const GpsEpoch &epoch() const
+        {
+            return m_epoch;
+        }
+
+        /// @brief Returns true if an epoch is being assembled.
+        inline bool pending() const
+        {
+            return m_state_bit_flags & (unsigned char)StateBits::OpenBit;
+        }
+
+    private:
+        void open(uint32_t time_ms, unsigned long now_ms, bool timed);
+
+        void emit();
+
+        GpsEpoch m_epoch;
+        GpsEpoch m_pending;
+        unsigned m_required;
+        unsigned long m_timeout_ms;
+        unsigned long m_opened_ms;
+        unsigned char m_state_bit_flags; // Booleans, combined to save space.
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_EPOCH_INCLUDE_GUARD
@@ -128,6 +128,77 @@ namespace gps
         return true;
     }
 
+    /// @brief Compute the NMEA checksum of a sentence body: the XOR of every character between '$' and '*'.
+    ///
+    /// @param body Sentence body, without '$' or '*'.
+    /// @param size Number of characters in body.
+    /// @return The checksum.
+    char nmea_checksum(const char *body, size_type size)
+    {
+        char checksum = 0;
+        for (size_type i = 0; i < size; ++i)
+        {
+            checksum ^= body[i];
+        }
+
+        return checksum;
+    }
+
+    /// @brief Format a complete NMEA sentence, "$<body>*HH\r\n", from a null terminated body such as "PMTK220,1000".
+    /// The result is null terminated.
+    ///
+    /// @param body Null terminated sentence body, without '$' or '*'.
+    /// @param dst Destination character buffer.
+    /// @param dst_size Size of destination buffer.
+    /// @return Number of characters written, not counting the null terminator, or 0 if the buffer is too small.
+    size_type format_nmea_sentence(const char *body, char *dst, size_type dst_size)
+    {
+        if (!body || !dst)
+        {
+            return 0;
+        }
+
+        size_type body_size = 0;
+        while (body[body_size] != 0)
+        {
+            ++body_size;
+        }
+
+        // '$', body, '*', two hex digits, CR, LF and null terminator.
+        if (dst_size < body_size + 7)
+        {
+            return 0;
+        }
+
+        static const char hex_digits[] = "0123456789ABCDEF";
+
+        char *p_dst = dst;
+        *p_dst = '$';
+        ++p_dst;
+
+        for (size_type i = 0; i < body_size; ++i)
+        {
+            *p_dst = body[i];
+            ++p_dst;
+        }
+
+        unsigned char checksum = (unsigned char)nmea_checksum(body, body_size);
+
+        *p_dst = '*';
+        ++p_dst;
+        *p_dst = hex_digits[checksum >> 4];
+        ++p_dst;
+        *p_dst = hex_digits[checksum & 0x0F];
+        ++p_dst;
+        *p_dst = '\r';
+        ++p_dst;
+        *p_dst = '\n';
+        ++p_dst;
+        *p_dst = 0;
+
+        return (size_type)(p_dst - dst);
+    }
+
     /// @brief Format the MM.MMMM part of latitude or longitude. Does very explicit formatting and assumes destination
     /// is large enough.
     ///
@@ -12,6 +12,10 @@ namespace gps
 
     bool format_lon_ddmm(float deg, char *dst, size_type dst_size);
 
+    char nmea_checksum(const char *body, size_type size);
+
+    size_type format_nmea_sentence(const char *body, char *dst, size_type dst_size);
+
 } // namespace gps
 } // namespace scottz0r
 
@@ -0,0 +1,113 @@
+/// @file MicroGps geometry module.
+///
+/// This module defines a local equirectangular frame for short distances between fixes. Longitude is scaled by the
+/// cosine of a reference latitude, which is cached, so measuring a distance costs a few multiplications instead of
+/// per-fix trigonometry. Over a few kilometers the distance error is well below GPS noise; it grows with the distance
+/// between the fixes and the reference.
+#ifndef _SCOTTZ0R_GPS_GEO_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_GEO_INCLUDE_GUARD
+
+#include "MicroGpsTypes.h"
+#include <math.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Mean Earth radius (IUGG), in meters.
+    constexpr double earth_radius_m = 6371008.8;
+
+    /// Degrees to radians.
+    constexpr double radians_per_degree = 3.14159265358979323846 / 180.0;
+
+    /// Length of one degree of latitude on the mean sphere, in meters.
+    constexpr float meters_per_degree = (float)(earth_radius_m * radians_per_degree);
+
+    /// A reference latitude that moves less than this (degrees) keeps its cached cosine. The relative error in east
+    /// distances is then below 2e-4.
+    constexpr float local_frame_tolerance = 0.01f;
+
+    /// @brief Local east/north frame in meters around a reference point.
+    class GpsLocalFrame
+    {
+    public:
+        /// @brief Create a frame at latitude and longitude zero.
+        GpsLocalFrame() : m_latitude(0), m_longitude(0), m_scale_latitude(0), m_east_scale(meters_per_degree)
+        {
+        }
+
+        /// @brief Move the reference point. The cosine is only recomputed if the latitude moved more than
+        /// local_frame_tolerance since it was last computed.
+        ///
+        /// @param latitude Reference latitude in degrees.
+        /// @param longitude Reference longitude in degrees.
+        inline void reset(float latitude, float longitude)
+        {
+            if (fabsf(latitude - m_scale_latitude) > local_frame_tolerance)
+            {
+                m_scale_latitude = latitude;
+                m_east_scale = meters_per_degree * cosf(latitude * (float)radians_per_degree);
+            }
+            m_latitude = latitude;
+            m_longitude = longitude;
+        }
+
+        /// @brief Get the east offset of a longitude from the reference, in meters. Wraps across +-180 degrees.
+        inline float east(float longitude) const
+        {
+            float delta = longitude - m_longitude;
+            if (delta > 180)
+            {
+                delta -= 360;
+            }
+            else if (delta < -180)
+            {
+                delta += 360;
+            }
+            return delta * m_east_scale;
+        }
+
+        /// @brief Get the north offset of a latitude from the reference, in meters.
+        inline float north(float latitude) const
+        {
+            return (latitude - m_latitude) * meters_per_degree;
+        }
+
+        /// @brief Get the squared distance of a point from the reference, in square meters. Compare against a squared
+        /// threshold to avoid the square root.
+        inline float distance_squared(float latitude, float longitude) const
+        {
+            float e = east(longitude);
+            float n = north(latitude);
+            return e * e + n * n;
+        }
+
+        /// @brief Get the distance of a point from the reference, in meters.
+        inline float distance(float latitude, float longitude) const
+        {
+            return sqrtf(distance_squared(latitude, longitude));
+        }
+
+        /// @brief Get the reference latitude in degrees.
+        inline float latitude() const
+        {
+            return m_latitude;
+        }
+
+        /// @brief Get the reference longitude in degrees.
+        inline float longitude() const
+        {
+            return m_longitude;
+        }
+
+    private:
+        float m_latitude;
+        float m_longitude;
+        float m_scale_latitude; ///< Latitude the cached scale was computed at.
+        float m_east_scale;     ///< meters_per_degree * cos(m_scale_latitude).
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_GEO_INCLUDE_GUARD
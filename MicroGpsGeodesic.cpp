@@ -0,0 +1,287 @@
+/// @file MicroGps geodesic kernels implementation.
+#include "MicroGpsGeodesic.h"
+#include <stdint.h>
+#include <string.h>
+
+// Lets the compiler vectorize without checking whether outputs overlap inputs.
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define _SCOTTZ0R_GPS_RESTRICT __restrict
+#else
+#define _SCOTTZ0R_GPS_RESTRICT
+#endif
+
+namespace scottz0r
+{
+namespace gps
+{
+    static constexpr float pi_f = 3.14159265358979323846f;
+    static constexpr float radians_f = (float)radians_per_degree;
+    static constexpr float degrees_f = (float)(1 / radians_per_degree);
+
+    /// @brief Round to the nearest integer, for |x| below 2^22 in float or 2^51 in double. Adding and removing 1.5
+    /// times 2^23 (or 2^52) pushes the fraction out of the mantissa; unlike rint() this needs no SSE4.1. -ffast-math
+    /// would fold it away, and so is not supported for this file.
+    template <typename T> static inline T round_nearest(T x)
+    {
+        const T magic = sizeof(T) > sizeof(float) ? (T)6755399441055744.0 : (T)12582912.0f;
+        return (x + magic) - magic;
+    }
+
+    /// @brief Wrap a longitude difference in degrees to [-180, 180].
+    template <typename T> static inline T wrap_degrees(T delta)
+    {
+        return delta - 360 * round_nearest(delta * (T)(1.0 / 360));
+    }
+
+    /// @brief Rounding error of the float sum of a and b, so that a + b == sum + error exactly (Knuth's two sum).
+    static inline float sum_error(float a, float b, float sum)
+    {
+        float a_part = sum - b;
+        float b_part = sum - a_part;
+        return (a - a_part) + (b - b_part);
+    }
+
+    /// @brief Difference of two longitudes in degrees, wrapped to [-180, 180]. Across the antimeridian the raw
+    /// difference is near 360 and loses meters of its low bits in float; they are added back after the wrap.
+    static inline float longitude_difference(float to, float from)
+    {
+        float delta = to - from;
+        return wrap_degrees(delta) + sum_error(to, -from, delta);
+    }
+
+    /// @brief Sine and cosine of an angle in degrees, |x| < 2^22. The angle is reduced to [-45, 45] degrees in
+    /// degrees, which is exact, so that cos(89.99) keeps its relative precision, and the quadrant selects and signs
+    /// the Cephes sinf/cosf minimax polynomials. Error is within a few float ulps.
+    ///
+    /// @param degrees Angle, in degrees.
+    /// @param sine Sine of the angle.
+    /// @param cosine Cosine of the angle.
+    /// @param low Small correction added to the angle after the reduction, such as the rounding error of degrees.
+    static inline void sincos_degrees(float degrees, float &sine, float &cosine, float low = 0)
+    {
+        float k = round_nearest(degrees * (1.0f / 90));
+        int quadrant = (int)k;
+        float r = ((degrees - k * 90) + low) * radians_f;
+
+        float r2 = r * r;
+        float s = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+        float c = 1.0f - 0.5f * r2 +
+                  r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+        float sine_r = (quadrant & 1) ? c : s;
+        float cosine_r = (quadrant & 1) ? s : c;
+        sine = (quadrant & 2) ? -sine_r : sine_r;
+        cosine = ((quadrant + 1) & 2) ? -cosine_r : cosine_r;
+    }
+
+    /// @brief Arc tangent of y / x in radians, in the quadrant of (x, y). The ratio is folded to [0, tan(pi/8)] and
+    /// the Cephes atanf polynomial applied, so small angles keep their relative precision.
+    static inline float fast_atan2(float y, float x)
+    {
+        float ax = fabsf(x);
+        float ay = fabsf(y);
+        float high = ax > ay ? ax : ay;
+        float low = ax > ay ? ay : ax;
+        float t = low / (high > 0 ? high : 1.0f);
+
+        bool folded = t > 0.414213562f;
+        float z = folded ? (t - 1) / (t + 1) : t;
+        float z2 = z * z;
+        float a = z + z * z2 *
+                          (((8.05374449538e-2f * z2 - 1.38776856032e-1f) * z2 + 1.99777106478e-1f) * z2 -
+                           3.33329491539e-1f);
+
+        a = folded ? a + pi_f / 4 : a;
+        a = ay > ax ? pi_f / 2 - a : a;
+        a = x < 0 ? pi_f - a : a;
+        return y < 0 ? -a : a;
+    }
+
+    /// @brief Square root of x >= 0 by three Newton steps on the reciprocal square root from a bit level first guess.
+    /// sqrtf() would be one instruction, but its errno handling stops vectorization unless -fno-math-errno is set.
+    static inline float fast_sqrt(float x)
+    {
+        uint32_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        bits = 0x5F375A86 - (bits >> 1);
+        float y;
+        memcpy(&y, &bits, sizeof(y));
+
+        float half = 0.5f * x;
+        y = y * (1.5f - half * y * y);
+        y = y * (1.5f - half * y * y);
+        y = y * (1.5f - half * y * y);
+        return x * y;
+    }
+
+    /// @brief Sine and cosine of x in radians, |x| <= pi, in double precision. The Taylor series to x^13 and x^14 is
+    /// evaluated at x / 4, within 2e-14 of the truth, and the double angle formulas applied twice.
+    static inline void series_sincos(double x, double &sine, double &cosine)
+    {
+        double q = x * 0.25;
+        double q2 = q * q;
+        double s = q * (1 + q2 * (-1.0 / 6 +
+                                  q2 * (1.0 / 120 +
+                                        q2 * (-1.0 / 5040 +
+                                              q2 * (1.0 / 362880 +
+                                                    q2 * (-1.0 / 39916800 + q2 * (1.0 / 6227020800)))))));
+        double c = 1 + q2 * (-1.0 / 2 +
+                             q2 * (1.0 / 24 +
+                                   q2 * (-1.0 / 720 +
+                                         q2 * (1.0 / 40320 +
+                                               q2 * (-1.0 / 3628800 +
+                                                     q2 * (1.0 / 479001600 + q2 * (-1.0 / 87178291200)))))));
+
+        double s2 = 2 * s * c;
+        double c2 = 1 - 2 * s * s;
+        sine = 2 * s2 * c2;
+        cosine = 1 - 2 * s2 * s2;
+    }
+
+    /// @brief Great circle distance between pairs of points on the mean sphere, by the haversine formula.
+    ///
+    /// For the distances between consecutive fixes of a column, pass the column as point 1 and the column plus one
+    /// as point 2, with a count one less than the column.
+    ///
+    /// @param latitude1 Latitudes of the first points, in degrees.
+    /// @param longitude1 Longitudes of the first points, in degrees.
+    /// @param latitude2 Latitudes of the second points, in degrees.
+    /// @param longitude2 Longitudes of the second points, in degrees.
+    /// @param distance_m Distances, in meters. Must not overlap the inputs.
+    /// @param count Number of pairs.
+    void haversine_distance(const float *_SCOTTZ0R_GPS_RESTRICT latitude1,
+                            const float *_SCOTTZ0R_GPS_RESTRICT longitude1,
+                            const float *_SCOTTZ0R_GPS_RESTRICT latitude2,
+                            const float *_SCOTTZ0R_GPS_RESTRICT longitude2, float *_SCOTTZ0R_GPS_RESTRICT distance_m,
+                            size_type count)
+    {
+        for (size_type i = 0; i < count; ++i)
+        {
+            float sin_half_north, cos_half_north, sin_half_east, cos_half_east, sin_middle, cos_middle;
+            sincos_degrees((latitude2[i] - latitude1[i]) * 0.5f, sin_half_north, cos_half_north);
+            sincos_degrees(longitude_difference(longitude2[i], longitude1[i]) * 0.5f, sin_half_east, cos_half_east);
+            float latitude_sum = latitude1[i] + latitude2[i];
+            sincos_degrees(latitude_sum * 0.5f, sin_middle, cos_middle,
+                           sum_error(latitude1[i], latitude2[i], latitude_sum) * 0.5f);
+
+            // sin^2 and cos^2 of half the central angle as sums of squares, so neither cancels: the usual 1 - h loses
+            // all precision for nearly antipodal points.
+            float north_weight = cos_half_east * cos_half_east;
+            float east_weight = sin_half_east * sin_half_east;
+            float h = sin_half_north * sin_half_north * north_weight + cos_middle * cos_middle * east_weight;
+            float rest = cos_half_north * cos_half_north * north_weight + sin_middle * sin_middle * east_weight;
+            distance_m[i] = (float)(2 * earth_radius_m) * fast_atan2(fast_sqrt(h), fast_sqrt(rest));
+        }
+    }
+
+    /// @brief Initial bearing of the great circle from the first to the second point of each pair.
+    ///
+    /// The north component uses sin(dlat) + sin(lat1) cos(lat2) 2 sin^2(dlon / 2) instead of the textbook
+    /// cos(lat1) sin(lat2) - sin(lat1) cos(lat2) cos(dlon), which cancels for nearby points.
+    ///
+    /// @param bearing Bearings in degrees clockwise from north, in [0, 360). 0 for identical points. Must not overlap
+    /// the inputs.
+    /// @see haversine_distance() for the other parameters.
+    void initial_bearing(const float *_SCOTTZ0R_GPS_RESTRICT latitude1, const float *_SCOTTZ0R_GPS_RESTRICT longitude1,
+                         const float *_SCOTTZ0R_GPS_RESTRICT latitude2, const float *_SCOTTZ0R_GPS_RESTRICT longitude2,
+                         float *_SCOTTZ0R_GPS_RESTRICT bearing, size_type count)
+    {
+        for (size_type i = 0; i < count; ++i)
+        {
+            float sin_latitude1, cos_latitude2, sin_north, sin_east, sin_half_east, unused;
+            sincos_degrees(latitude1[i], sin_latitude1, unused);
+            sincos_degrees(latitude2[i], unused, cos_latitude2);
+            sincos_degrees(latitude2[i] - latitude1[i], sin_north, unused);
+
+            float east = longitude_difference(longitude2[i], longitude1[i]);
+            sincos_degrees(east, sin_east, unused);
+            sincos_degrees(east * 0.5f, sin_half_east, unused);
+
+            float y = sin_east * cos_latitude2;
+            float x = sin_north + sin_latitude1 * cos_latitude2 * 2 * sin_half_east * sin_half_east;
+            float degrees = fast_atan2(y, x) * degrees_f;
+            degrees = degrees < 0 ? degrees + 360 : degrees;
+            bearing[i] = degrees < 360 ? degrees : 0; // -1e-6 rounds up to 360.
+        }
+    }
+
+    /// @brief Set up a frame at a reference point.
+    ///
+    /// @param latitude Reference latitude, in degrees.
+    /// @param longitude Reference longitude, in degrees.
+    /// @param height Reference height above the ellipsoid, in meters.
+    GpsEnuFrame::GpsEnuFrame(double latitude, double longitude, double height)
+        : m_latitude(latitude), m_longitude(longitude), m_sin_latitude(sin(latitude * radians_per_degree)),
+          m_cos_latitude(cos(latitude * radians_per_degree))
+    {
+        m_radius_ratio = 1 / sqrt(1 - wgs84_e2 * m_sin_latitude * m_sin_latitude);
+        double radius = wgs84_a * m_radius_ratio;
+        m_x = (radius + height) * m_cos_latitude;
+        m_z = (radius * (1 - wgs84_e2) + height) * m_sin_latitude;
+    }
+
+    /// @brief Project points into the frame.
+    ///
+    /// @param latitude Latitudes, in degrees.
+    /// @param longitude Longitudes, in degrees.
+    /// @param height Heights above the ellipsoid (altitude_msl + geoid_height), in meters, or nullptr for points at
+    /// zero height.
+    /// @param east East offsets from the reference, in meters.
+    /// @param north North offsets, in meters.
+    /// @param up Up offsets, in meters.
+    /// @param count Number of points.
+    void GpsEnuFrame::project(const float *_SCOTTZ0R_GPS_RESTRICT latitude,
+                              const float *_SCOTTZ0R_GPS_RESTRICT longitude,
+                              const float *_SCOTTZ0R_GPS_RESTRICT height, float *_SCOTTZ0R_GPS_RESTRICT east,
+                              float *_SCOTTZ0R_GPS_RESTRICT north, float *_SCOTTZ0R_GPS_RESTRICT up,
+                              size_type count) const
+    {
+        // Separate loops, so neither tests the height pointer per point.
+        if (height)
+        {
+            for (size_type i = 0; i < count; ++i)
+            {
+                project_point(latitude[i], longitude[i], height[i], east[i], north[i], up[i]);
+            }
+        }
+        else
+        {
+            for (size_type i = 0; i < count; ++i)
+            {
+                project_point(latitude[i], longitude[i], 0, east[i], north[i], up[i]);
+            }
+        }
+    }
+
+    /// @brief Project one point into the frame.
+    inline void GpsEnuFrame::project_point(double latitude, double longitude, double height, float &east,
+                                           float &north, float &up) const
+    {
+        double sin_north, cos_north, sin_east, cos_east;
+        series_sincos((latitude - m_latitude) * radians_per_degree, sin_north, cos_north);
+        series_sincos(wrap_degrees(longitude - m_longitude) * radians_per_degree, sin_east, cos_east);
+
+        double sin_latitude = m_sin_latitude * cos_north + m_cos_latitude * sin_north;
+        double cos_latitude = m_cos_latitude * cos_north - m_sin_latitude * sin_north;
+
+        // 1 / sqrt(1 - e^2 sin^2) by Newton's method from the reference value: within 0.4% to start, and each step
+        // squares the relative error.
+        double half = 0.5 * (1 - wgs84_e2 * sin_latitude * sin_latitude);
+        double ratio = m_radius_ratio;
+        ratio = ratio * (1.5 - half * ratio * ratio);
+        ratio = ratio * (1.5 - half * ratio * ratio);
+        ratio = ratio * (1.5 - half * ratio * ratio);
+
+        // Earth centered coordinates, with the x axis through the reference meridian.
+        double radius = wgs84_a * ratio;
+        double polar = (radius + height) * cos_latitude;
+        double dx = polar * cos_east - m_x;
+        double dz = (radius * (1 - wgs84_e2) + height) * sin_latitude - m_z;
+
+        east = (float)(polar * sin_east);
+        north = (float)(m_cos_latitude * dz - m_sin_latitude * dx);
+        up = (float)(m_cos_latitude * dx + m_sin_latitude * dz);
+    }
+
+} // namespace gps
+} // namespace scottz0r
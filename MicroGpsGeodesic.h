@@ -0,0 +1,74 @@
+/// @file MicroGps geodesic kernels module.
+///
+/// This module defines batch kernels over columns of coordinates, such as the columns of a GpsPositionBatch:
+/// haversine distance, initial bearing and projection into a local east/north/up frame. The loops call no library
+/// functions; sine, cosine, arctangent and square root are polynomial and Newton approximations written as straight
+/// line code with selects, which optimizing compilers vectorize (SSE, AVX or NEON as the target allows). Clang does so
+/// at -O2; GCC needs -O3 and -fno-trapping-math, or AVX-512, to turn the selects into vector blends.
+///
+/// Error bounds, measured against double precision libm on the same float inputs:
+/// - haversine_distance(): relative error below 1e-6 on the mean sphere (earth_radius_m), including nearly antipodal
+///   points. The sphere itself is up to 0.5% off the WGS84 ellipsoid.
+/// - initial_bearing(): error below 1e-4 degrees for points up to 19000 km apart and away from the poles (latitudes
+///   within 89.99 degrees). Toward the antipode and the poles the bearing is ill conditioned and the error grows.
+/// - GpsEnuFrame::project(): under a millimeter anywhere on Earth before the output is rounded to float.
+///
+/// Limits of these bounds:
+/// - The project() bound and the double path of round_nearest() assume a 64 bit double. On AVR double is 32 bits, so
+///   Earth sized coordinates cancel in float and the east/north/up error is of the order of a meter.
+/// - Only the test build adds -fno-trapping-math, for MicroGpsGeodesic.cpp. Without it GCC keeps the selects as
+///   branches and the loops run scalar; add the flag for that file in your own build to get the vector blends.
+#ifndef _SCOTTZ0R_GPS_GEODESIC_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_GEODESIC_INCLUDE_GUARD
+
+#include "MicroGpsGeo.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// WGS84 semi-major axis, in meters.
+    constexpr double wgs84_a = 6378137.0;
+
+    /// WGS84 flattening.
+    constexpr double wgs84_f = 1 / 298.257223563;
+
+    /// WGS84 first eccentricity squared.
+    constexpr double wgs84_e2 = wgs84_f * (2 - wgs84_f);
+
+    void haversine_distance(const float *latitude1, const float *longitude1, const float *latitude2,
+                            const float *longitude2, float *distance_m, size_type count);
+
+    void initial_bearing(const float *latitude1, const float *longitude1, const float *latitude2,
+                         const float *longitude2, float *bearing, size_type count);
+
+    /// @brief Local east/north/up frame tangent to the WGS84 ellipsoid at a reference point.
+    ///
+    /// The trigonometry of the reference is computed once. Points are projected through their latitude and
+    /// longitude differences from the reference, so the per point work is two short series, a few Newton steps and
+    /// arithmetic, in double precision to avoid cancellation between Earth sized coordinates.
+    class GpsEnuFrame
+    {
+    public:
+        GpsEnuFrame(double latitude, double longitude, double height = 0);
+
+        void project(const float *latitude, const float *longitude, const float *height, float *east, float *north,
+                     float *up, size_type count) const;
+
+    private:
+        void project_point(double latitude, double longitude, double height, float &east, float &north,
+                           float &up) const;
+
+        double m_latitude;
+        double m_longitude;
+        double m_sin_latitude;
+        double m_cos_latitude;
+        double m_x;            ///< Reference distance from the polar axis, in meters.
+        double m_z;            ///< Reference distance from the equatorial plane, in meters.
+        double m_radius_ratio; ///< Prime vertical radius of curvature of the reference over wgs84_a.
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_GEODESIC_INCLUDE_GUARD
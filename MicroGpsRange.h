@@ -0,0 +1,159 @@
+/// @file MicroGps range module.
+///
+/// This module adapts MicroGps to a lazy forward range over a block of NMEA data, so logs can be consumed with range
+/// based for loops and standard algorithms.
+#ifndef _SCOTTZ0R_GPS_RANGE_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_RANGE_INCLUDE_GUARD
+
+#include "MicroGps.h"
+#include <stddef.h>
+
+// Iterator tags are only available where the standard library is (not on AVR).
+#if defined(__has_include)
+#if __has_include(<iterator>)
+#include <iterator>
+#define _SCOTTZ0R_GPS_HAS_ITERATOR_TAGS
+#endif
+#endif
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// @brief Forward iterator over the good GGA records in a block of NMEA data.
+    ///
+    /// Each iterator owns a parser, so copies advance independently and a range can be walked more than once. Sentences
+    /// are parsed as the iterator is incremented; nothing is allocated or buffered.
+    template <typename _Policy> class BasicGpsPositionIterator
+    {
+    public:
+        using value_type = typename BasicMicroGps<_Policy>::position_type;
+        using difference_type = ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+#ifdef _SCOTTZ0R_GPS_HAS_ITERATOR_TAGS
+        using iterator_category = std::forward_iterator_tag;
+#endif
+
+        /// @brief Create an end iterator.
+        BasicGpsPositionIterator() : m_next(nullptr), m_end(nullptr)
+        {
+        }
+
+        /// @brief Create an iterator at the first good GGA record in the data, or an end iterator if there is none.
+        ///
+        /// @param data NMEA data.
+        /// @param size Number of characters in data.
+        BasicGpsPositionIterator(const char *data, size_type size) : m_next(data), m_end(data + size)
+        {
+            advance();
+        }
+
+        inline reference operator*() const
+        {
+            return m_gps.position_data();
+        }
+
+        inline pointer operator->() const
+        {
+            return &m_gps.position_data();
+        }
+
+        inline BasicGpsPositionIterator &operator++()
+        {
+            advance();
+            return *this;
+        }
+
+        inline BasicGpsPositionIterator operator++(int)
+        {
+            BasicGpsPositionIterator previous = *this;
+            advance();
+            return previous;
+        }
+
+        /// @brief Iterators are equal if they stopped at the same place in the data. Only iterators over the same data
+        /// can be compared.
+        inline bool operator==(const BasicGpsPositionIterator &other) const
+        {
+            return m_next == other.m_next;
+        }
+
+        inline bool operator!=(const BasicGpsPositionIterator &other) const
+        {
+            return m_next != other.m_next;
+        }
+
+    private:
+        /// @brief Parse up to the end of the next good GGA sentence. Becomes an end iterator when the data runs out.
+        void advance()
+        {
+            while (m_next)
+            {
+                if (m_next == m_end)
+                {
+                    m_next = nullptr;
+                    return;
+                }
+
+                m_next += m_gps.process_until_complete(m_next, (size_type)(m_end - m_next));
+                if (m_gps.complete() && m_gps.good() && m_gps.message_type() == MessageType::GGA)
+                {
+                    return;
+                }
+            }
+        }
+
+        BasicMicroGps<_Policy> m_gps;
+        const char *m_next; // One past the last parsed character, or nullptr at the end.
+        const char *m_end;
+    };
+
+    /// @brief Lazy forward range over the good GGA records in a block of NMEA data. See parse().
+    template <typename _Policy> class BasicGpsPositionRange
+    {
+    public:
+        using iterator = BasicGpsPositionIterator<_Policy>;
+        using const_iterator = iterator;
+
+        BasicGpsPositionRange(const char *data, size_type size) : m_data(data), m_size(size)
+        {
+        }
+
+        /// @brief Get an iterator at the first good GGA record. Parses up to the end of that sentence.
+        inline iterator begin() const
+        {
+            return iterator(m_data, m_size);
+        }
+
+        inline iterator end() const
+        {
+            return iterator();
+        }
+
+    private:
+        const char *m_data;
+        size_type m_size;
+    };
+
+    /// Range over the good GGA records in a block of NMEA data, decoded with the default policy.
+    using GpsPositionRange = BasicGpsPositionRange<MicroGpsPolicy>;
+
+    /// @brief Get a lazy range over the good GGA records in a block of NMEA data, such as a log file in memory.
+    ///
+    /// `for (const GpsPosition &p : parse(buffer, size))` parses one sentence per iteration. Sentences that are not
+    /// GGA, are incomplete or are bad are skipped.
+    ///
+    /// @tparam _Policy MicroGps policy, which selects the record type (see MicroGpsPolicy).
+    /// @param data NMEA data. Must outlive the range and its iterators.
+    /// @param size Number of characters in data.
+    template <typename _Policy = MicroGpsPolicy>
+    inline BasicGpsPositionRange<_Policy> parse(const char *data, size_type size)
+    {
+        return BasicGpsPositionRange<_Policy>(data, size);
+    }
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_RANGE_INCLUDE_GUARD
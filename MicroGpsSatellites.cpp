@@ -0,0 +1,118 @@
+/// @file Satellite table implementation.
+#include "MicroGpsSatellites.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// @brief Initialize an empty table.
+    GpsSatelliteTable::GpsSatelliteTable()
+        : m_tables(), m_front(0), m_talker(Talker::Unknown), m_total(0), m_number(0), m_next(0), m_part_open(false),
+          m_row_prn(0), m_row_elevation(0), m_row_azimuth(0)
+    {
+    }
+
+    /// @brief Start a GSV part. A previous part that never ended (bad or truncated sentence) drops its cycle.
+    ///
+    /// @param talker Talker of the GSV sentence.
+    /// @param total Total number of parts in the cycle.
+    void GpsSatelliteTable::begin_part(Talker talker, unsigned char total)
+    {
+        if (m_part_open || talker != m_talker || total != m_total)
+        {
+            m_next = 0;
+        }
+
+        m_talker = talker;
+        m_total = total;
+        m_number = 0;
+        m_part_open = true;
+        m_row_prn = 0;
+        m_row_elevation = 0;
+        m_row_azimuth = 0;
+    }
+
+    /// @brief Set the number of the current part. Part 1 starts a new cycle in the back buffer, keeping the rows of
+    /// other talkers from the front buffer.
+    void GpsSatelliteTable::set_part_number(unsigned char number)
+    {
+        m_number = number;
+
+        if (number == 1)
+        {
+            const GpsSatellites &front = m_tables[m_front];
+            GpsSatellites &dst = back();
+
+            unsigned char count = 0;
+            for (unsigned char i = 0; i < front.count; ++i)
+            {
+                if (front.talker[i] != m_talker)
+                {
+                    dst.talker[count] = front.talker[i];
+                    dst.prn[count] = front.prn[i];
+                    dst.elevation[count] = front.elevation[i];
+                    dst.azimuth[count] = front.azimuth[i];
+                    dst.snr[count] = front.snr[i];
+                    ++count;
+                }
+            }
+            dst.count = count;
+            m_next = 1;
+        }
+        else if (number != m_next)
+        {
+            // Missing or out of order part.
+            m_next = 0;
+        }
+    }
+
+    /// @brief Append the staged row with the given SNR to the cycle being assembled. Rows beyond max_satellites are
+    /// dropped.
+    void GpsSatelliteTable::commit_row(unsigned char snr)
+    {
+        GpsSatellites &dst = back();
+
+        if (m_next == 0 || m_row_prn == 0 || dst.count >= max_satellites)
+        {
+            return;
+        }
+
+        dst.talker[dst.count] = m_talker;
+        dst.prn[dst.count] = m_row_prn;
+        dst.elevation[dst.count] = m_row_elevation;
+        dst.azimuth[dst.count] = m_row_azimuth;
+        dst.snr[dst.count] = snr;
+        ++dst.count;
+
+        m_row_prn = 0;
+        m_row_elevation = 0;
+        m_row_azimuth = 0;
+    }
+
+    /// @brief End the current part once its checksum has been checked.
+    ///
+    /// @param good True if the sentence was valid.
+    /// @return True if this part completed a cycle and satellites() was updated.
+    bool GpsSatelliteTable::end_part(bool good)
+    {
+        m_part_open = false;
+
+        if (!good || m_next == 0 || m_number != m_next)
+        {
+            m_next = 0;
+            return false;
+        }
+
+        if (m_number == m_total)
+        {
+            m_front ^= 1;
+            m_next = 0;
+            return true;
+        }
+
+        ++m_next;
+        return false;
+    }
+
+} // namespace gps
+} // namespace scottz0r
@@ -0,0 +1,94 @@
+/// @file Satellite table definition module.
+///
+/// This module defines the GpsSatelliteTable class, which assembles multi-part GSV sentences into a table of
+/// satellites in view.
+#ifndef _SCOTTZ0R_GPS_SATELLITES_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_SATELLITES_INCLUDE_GUARD
+
+#include "MicroGpsTypes.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Maximum number of satellites held by a GpsSatelliteTable, across all talkers.
+    constexpr size_type max_satellites = 64;
+
+    /// @brief Satellites in view, stored as one array per column. Row i of every array describes the same satellite.
+    struct GpsSatellites
+    {
+        unsigned char count;
+        Talker talker[max_satellites];
+        unsigned char prn[max_satellites];
+        unsigned char elevation[max_satellites]; ///< Degrees, 0 to 90.
+        unsigned short azimuth[max_satellites];  ///< Degrees true, 0 to 359.
+        unsigned char snr[max_satellites];       ///< dB-Hz, 0 when not tracking.
+    };
+
+    /// @brief Double buffered satellite table, filled from GSV sentences by MicroGps.
+    ///
+    /// Each talker sends its satellites as a cycle of numbered GSV parts. Parts are written into the back buffer, and
+    /// the buffers are swapped only when the last part of a cycle passes its checksum, so satellites() never exposes a
+    /// half assembled cycle. Rows of other talkers are carried over, so a GN receiver's GPGSV and GLGSV cycles share
+    /// one table. A cycle with a missing, out of order or bad part is dropped.
+    ///
+    /// The assembly methods are driven by MicroGps, after attaching the table with MicroGps::set_satellite_table().
+    class GpsSatelliteTable
+    {
+    public:
+        GpsSatelliteTable();
+
+        /// @brief Get the satellites of the last completed cycles.
+        inline const GpsSatellites &satellites() const
+        {
+            return m_tables[m_front];
+        }
+
+        void begin_part(Talker talker, unsigned char total);
+
+        void set_part_number(unsigned char number);
+
+        /// @brief Stage the PRN of the next satellite row.
+        inline void set_prn(unsigned char prn)
+        {
+            m_row_prn = prn;
+        }
+
+        /// @brief Stage the elevation of the next satellite row.
+        inline void set_elevation(unsigned char elevation)
+        {
+            m_row_elevation = elevation;
+        }
+
+        /// @brief Stage the azimuth of the next satellite row.
+        inline void set_azimuth(unsigned short azimuth)
+        {
+            m_row_azimuth = azimuth;
+        }
+
+        void commit_row(unsigned char snr);
+
+        bool end_part(bool good);
+
+    private:
+        inline GpsSatellites &back()
+        {
+            return m_tables[m_front ^ 1];
+        }
+
+        GpsSatellites m_tables[2];
+        unsigned char m_front;
+        Talker m_talker;
+        unsigned char m_total;
+        unsigned char m_number;
+        unsigned char m_next; // Next expected part number, 0 if not assembling a cycle.
+        bool m_part_open;
+        unsigned char m_row_prn;
+        unsigned char m_row_elevation;
+        unsigned short m_row_azimuth;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_SATELLITES_INCLUDE_GUARD
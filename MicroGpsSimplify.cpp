@@ -0,0 +1,173 @@
+/// @file Track simplification implementation.
+#include "MicroGpsSimplify.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Both coordinates, which together make a usable position.
+    static constexpr unsigned char coordinate_fields =
+        position_field_bit(PositionField::Latitude) | position_field_bit(PositionField::Longitude);
+
+    /// @brief Cross product of two vectors: positive if b is counterclockwise of a.
+    static inline float cross(float a_east, float a_north, float b_east, float b_north)
+    {
+        return a_east * b_north - a_north * b_east;
+    }
+
+    /// @brief Initialize the simplifier. The first fix is always a vertex.
+    ///
+    /// @param tolerance_m Largest distance, in meters, of a skipped fix from the segment between the vertices around
+    /// it.
+    /// @param max_window Most fixes in one segment, at least 1. The last fix of a full segment becomes a vertex.
+    GpsTrackSimplifier::GpsTrackSimplifier(float tolerance_m, size_type max_window)
+        : m_vertex({}), m_previous({}), m_tolerance(tolerance_m), m_right_east(0), m_right_north(0), m_left_east(0),
+          m_left_north(0), m_farthest(0), m_max_window(max_window > 0 ? max_window : 1), m_count(0),
+          m_state_bit_flags(0)
+    {
+    }
+
+    /// @brief Add a fix.
+    ///
+    /// @param position Fix to add.
+    /// @return True if a vertex was emitted. It is available from vertex(), and is the given fix only for the first
+    /// fix; otherwise it is an earlier fix.
+    bool GpsTrackSimplifier::update(const GpsPosition &position)
+    {
+        if ((position.fields & coordinate_fields) != coordinate_fields)
+        {
+            return false;
+        }
+
+        if (!(m_state_bit_flags & (unsigned char)StateBits::StartedBit))
+        {
+            m_vertex = position;
+            open_segment(position);
+            return true;
+        }
+
+        float east = m_frame.east(position.longitude);
+        float north = m_frame.north(position.latitude);
+        float distance = sqrtf(east * east + north * north);
+        if (m_count < m_max_window && extends(east, north, distance))
+        {
+            narrow(east, north, distance);
+            m_previous = position;
+            ++m_count;
+            return false;
+        }
+
+        // The previous fix ends the segment and anchors the next one, which so far holds this fix.
+        m_vertex = m_previous;
+        open_segment(m_previous);
+
+        east = m_frame.east(position.longitude);
+        north = m_frame.north(position.latitude);
+        narrow(east, north, sqrtf(east * east + north * north));
+        m_previous = position;
+        m_count = 1;
+        return true;
+    }
+
+    /// @brief End the track: emit the last fix as a vertex if it is not one yet. Call at the end of a track or
+    /// before a gap; the next fix starts a new track.
+    ///
+    /// @return True if a vertex was emitted.
+    bool GpsTrackSimplifier::flush()
+    {
+        bool pending = m_count > 0;
+        if (pending)
+        {
+            m_vertex = m_previous;
+        }
+        m_count = 0;
+        m_state_bit_flags = 0;
+        return pending;
+    }
+
+    /// @brief Forget the track without emitting anything. The next fix is a vertex.
+    void GpsTrackSimplifier::reset()
+    {
+        m_count = 0;
+        m_state_bit_flags = 0;
+    }
+
+    /// @brief Start a segment at an anchor with an unbounded cone.
+    void GpsTrackSimplifier::open_segment(const GpsPosition &anchor)
+    {
+        m_frame.reset(anchor.latitude, anchor.longitude);
+        m_previous = anchor;
+        m_farthest = 0;
+        m_count = 0;
+        m_state_bit_flags = (unsigned char)StateBits::StartedBit;
+    }
+
+    /// @brief Narrow the cone to the directions whose line passes within the tolerance of a fix.
+    ///
+    /// The bounds are the tangents from the anchor to the tolerance circle around the fix: the fix rotated by
+    /// +-asin(tolerance / distance), computed without trigonometry.
+    void GpsTrackSimplifier::narrow(float east, float north, float distance)
+    {
+        m_farthest = distance > m_farthest ? distance : m_farthest;
+        if (distance <= m_tolerance)
+        {
+            return;
+        }
+
+        float along = sqrtf(distance * distance - m_tolerance * m_tolerance);
+        float right_east = east * along + north * m_tolerance;
+        float right_north = north * along - east * m_tolerance;
+        float left_east = east * along - north * m_tolerance;
+        float left_north = north * along + east * m_tolerance;
+
+        if (!(m_state_bit_flags & (unsigned char)StateBits::BoundedBit))
+        {
+            m_right_east = right_east;
+            m_right_north = right_north;
+            m_left_east = left_east;
+            m_left_north = left_north;
+            m_state_bit_flags |= (unsigned char)StateBits::BoundedBit;
+            return;
+        }
+
+        if (cross(m_right_east, m_right_north, right_east, right_north) > 0)
+        {
+            m_right_east = right_east;
+            m_right_north = right_north;
+        }
+        if (cross(left_east, left_north, m_left_east, m_left_north) > 0)
+        {
+            m_left_east = left_east;
+            m_left_north = left_north;
+        }
+        if (cross(m_right_east, m_right_north, m_left_east, m_left_north) < 0)
+        {
+            m_state_bit_flags |= (unsigned char)StateBits::EmptyBit;
+        }
+    }
+
+    /// @brief Returns true if a fix can end the segment: its direction is in the cone and it is at least as far from
+    /// the anchor as every fix of the segment, so each of them projects onto the segment and not past its end.
+    bool GpsTrackSimplifier::extends(float east, float north, float distance) const
+    {
+        if (m_state_bit_flags & (unsigned char)StateBits::EmptyBit)
+        {
+            return false;
+        }
+
+        if (distance < m_farthest)
+        {
+            return false;
+        }
+
+        if (!(m_state_bit_flags & (unsigned char)StateBits::BoundedBit))
+        {
+            return true;
+        }
+
+        return cross(m_right_east, m_right_north, east, north) >= 0 &&
+               cross(east, north, m_left_east, m_left_north) >= 0;
+    }
+
+} // namespace gps
+} // namespace scottz0r
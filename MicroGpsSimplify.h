@@ -0,0 +1,77 @@
+/// @file Track simplification definition module.
+///
+/// This module defines the GpsTrackSimplifier class, which thins a stream of fixes to the vertices needed to redraw
+/// the track within a distance tolerance.
+#ifndef _SCOTTZ0R_GPS_SIMPLIFY_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_SIMPLIFY_INCLUDE_GUARD
+
+#include "MicroGps.h"
+#include "MicroGpsGeo.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// @brief Streaming track simplification by cone intersection (a sleeve fit).
+    ///
+    /// The last emitted vertex is the anchor. Every fix after it narrows a cone of directions from the anchor: the
+    /// directions whose line passes within the tolerance of that fix. A new fix can end the current segment if its
+    /// direction is inside the cone of the fixes before it and it is at least as far from the anchor as every one of
+    /// them. Then each skipped fix is within the tolerance of the line and projects onto the segment rather than past
+    /// its end, so it is within the tolerance of the segment from the anchor to the new fix. The first fix that cannot
+    /// end the segment makes the fix before it a vertex and the new anchor.
+    ///
+    /// Each fix costs a projection into a GpsLocalFrame, a few cross products and two square roots, and the state is
+    /// three fixes, so it runs on an MCU. Unlike Douglas-Peucker it never revisits fixes, so it can keep somewhat
+    /// more vertices for the same tolerance, most of all when fixes step back toward the anchor, as jitter does on a
+    /// slow track. A segment is closed after max_window fixes, which bounds how long a fix waits in the simplifier.
+    /// Fixes without both coordinates are skipped.
+    class GpsTrackSimplifier
+    {
+        enum class StateBits : unsigned char
+        {
+            StartedBit = 0x01, ///< An anchor has been emitted.
+            BoundedBit = 0x02, ///< The cone has bounds. Fixes within the tolerance of the anchor do not bound it.
+            EmptyBit = 0x04    ///< No line through the anchor fits every fix of the segment.
+        };
+
+    public:
+        GpsTrackSimplifier(float tolerance_m = 5, size_type max_window = 600);
+
+        bool update(const GpsPosition &position);
+
+        bool flush();
+
+        void reset();
+
+        /// @brief Get the last emitted vertex. Valid after update() or flush() returned true.
+        inline const GpsPosition &vertex() const
+        {
+            return m_vertex;
+        }
+
+    private:
+        void open_segment(const GpsPosition &anchor);
+
+        void narrow(float east, float north, float distance);
+
+        bool extends(float east, float north, float distance) const;
+
+        GpsLocalFrame m_frame; ///< Frame at the anchor.
+        GpsPosition m_vertex;
+        GpsPosition m_previous; ///< Last fix, the end of the segment so far.
+        float m_tolerance;
+        float m_right_east; ///< Clockwise bound of the cone.
+        float m_right_north;
+        float m_left_east; ///< Counterclockwise bound of the cone.
+        float m_left_north;
+        float m_farthest; ///< Largest distance of a fix of the segment from the anchor.
+        size_type m_max_window;
+        size_type m_count; ///< Fixes in the segment after the anchor.
+        unsigned char m_state_bit_flags; // Booleans, combined to save space.
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_SIMPLIFY_INCLUDE_GUARD
@@ -0,0 +1,357 @@
+/// @file Binary track codec implementation.
+#include "MicroGpsTrack.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    using namespace scottz0r::gps::_detail;
+
+    /// Meta byte layout: fix quality in the low nibble, talker in bits 4 to 6 and a "satellites changed" flag.
+    static constexpr unsigned char track_fix_mask = 0x0F;
+    static constexpr unsigned char track_talker_shift = 4;
+    static constexpr unsigned char track_talker_mask = 0x07;
+    static constexpr unsigned char track_satellites_bit = 0x80;
+
+    /// @brief Round a value to a fixed point integer with the given scale.
+    static int32_t round_to_fixed(double value, double scale)
+    {
+        double scaled = value * scale;
+        return (int32_t)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
+    }
+
+    /// @brief Returns true if the field is present in a presence byte.
+    static inline bool is_present(unsigned char presence, PositionField field)
+    {
+        return (presence & position_field_bit(field)) != 0;
+    }
+
+    /// @brief Write the delta of a present field.
+    static inline char *write_delta(int32_t value, int32_t previous, char *dst)
+    {
+        // Wrapping subtraction keeps every delta (including across +-180 degrees) in 32 bits.
+        int32_t delta = (int32_t)((uint32_t)value - (uint32_t)previous);
+        return dst + varint_write(zigzag_encode(delta), dst);
+    }
+
+    /// @brief Read the delta of a present field and add it to the previous value.
+    ///
+    /// @return Pointer past the varint, or nullptr if the input is truncated or invalid.
+    static inline const char *read_delta(const char *src, const char *end, int32_t previous, int32_t &value)
+    {
+        uint32_t encoded;
+        size_type size = varint_read(src, end, encoded);
+        if (size == 0)
+        {
+            return nullptr;
+        }
+
+        value = (int32_t)((uint32_t)previous + (uint32_t)zigzag_decode(encoded));
+        return src + size;
+    }
+
+    /// @brief Update the prediction state with a record. Missing fields keep their last value, so a gap does not
+    /// cost a full value when the field comes back.
+    static void update_previous(FixedGpsPosition &previous, const FixedGpsPosition &position)
+    {
+        unsigned char presence = position.fields;
+
+        previous.number_satellites = position.number_satellites;
+        if (is_present(presence, PositionField::Time))
+        {
+            previous.time_ms = position.time_ms;
+        }
+        if (is_present(presence, PositionField::Latitude))
+        {
+            previous.latitude = position.latitude;
+        }
+        if (is_present(presence, PositionField::Longitude))
+        {
+            previous.longitude = position.longitude;
+        }
+        if (is_present(presence, PositionField::Dilution))
+        {
+            previous.horizontal_dilution = position.horizontal_dilution;
+        }
+        if (is_present(presence, PositionField::Altitude))
+        {
+            previous.altitude_msl = position.altitude_msl;
+        }
+        if (is_present(presence, PositionField::GeoidHeight))
+        {
+            previous.geoid_height = position.geoid_height;
+        }
+    }
+
+    /// @brief Convert a position to fixed point, rounding coordinates to FixedNumeric::coordinate_scale and values to
+    /// FixedNumeric::value_scale.
+    FixedGpsPosition to_fixed_position(const GpsPosition &position)
+    {
+        FixedGpsPosition fixed = {};
+        fixed.timestamp = position.timestamp;
+        fixed.time_ms = position.time_ms;
+        fixed.talker = position.talker;
+        fixed.fix_quality = position.fix_quality;
+        fixed.number_satellites = position.number_satellites;
+        fixed.fields = position.fields;
+        fixed.latitude = round_to_fixed(position.latitude, FixedNumeric::coordinate_scale);
+        fixed.longitude = round_to_fixed(position.longitude, FixedNumeric::coordinate_scale);
+        fixed.horizontal_dilution = round_to_fixed(position.horizontal_dilution, FixedNumeric::value_scale);
+        fixed.altitude_msl = round_to_fixed(position.altitude_msl, FixedNumeric::value_scale);
+        fixed.geoid_height = round_to_fixed(position.geoid_height, FixedNumeric::value_scale);
+        return fixed;
+    }
+
+    /// @brief Convert a fixed point position to floating point.
+    GpsPosition to_float_position(const FixedGpsPosition &position)
+    {
+        GpsPosition result = {};
+        result.timestamp = position.timestamp;
+        result.time_ms = position.time_ms;
+        result.talker = position.talker;
+        result.fix_quality = position.fix_quality;
+        result.number_satellites = position.number_satellites;
+        result.fields = position.fields;
+        result.latitude = (float)((double)position.latitude / FixedNumeric::coordinate_scale);
+        result.longitude = (float)((double)position.longitude / FixedNumeric::coordinate_scale);
+        result.horizontal_dilution = (float)((double)position.horizontal_dilution / FixedNumeric::value_scale);
+        result.altitude_msl = (float)((double)position.altitude_msl / FixedNumeric::value_scale);
+        result.geoid_height = (float)((double)position.geoid_height / FixedNumeric::value_scale);
+        return result;
+    }
+
+    namespace _detail
+    {
+        /// @brief Write an unsigned LEB128 varint: 7 bits per byte, low bits first, high bit set on all but the last
+        /// byte. Writes at most 5 bytes.
+        ///
+        /// @return Number of bytes written.
+        size_type varint_write(uint32_t value, char *dst)
+        {
+            size_type size = 0;
+            while (value >= 0x80)
+            {
+                dst[size++] = (char)(value | 0x80);
+                value >>= 7;
+            }
+            dst[size++] = (char)value;
+            return size;
+        }
+
+        /// @brief Read an unsigned LEB128 varint.
+        ///
+        /// @return Number of bytes read, or 0 if the input ends first or the varint is longer than 5 bytes.
+        size_type varint_read(const char *src, const char *end, uint32_t &value)
+        {
+            uint32_t result = 0;
+            for (size_type i = 0; i < 5 && src + i < end; ++i)
+            {
+                unsigned char b = (unsigned char)src[i];
+                result |= (uint32_t)(b & 0x7F) << (7 * i);
+                if (!(b & 0x80))
+                {
+                    value = result;
+                    return i + 1;
+                }
+            }
+            return 0;
+        }
+    } // namespace _detail
+
+    /// @brief Initialize the encoder. The first record is encoded against an all zero record.
+    GpsTrackEncoder::GpsTrackEncoder() : m_previous({})
+    {
+    }
+
+    /// @brief Encode a record. The UTC timestamp (hhmmss) is not stored; the decoder rebuilds it from time_ms. Fix
+    /// quality is stored in 4 bits.
+    ///
+    /// @param position Record to encode. Only fields in position.fields are stored.
+    /// @param dst Destination buffer. At least track_record_max_size bytes avoids a copy.
+    /// @param dst_size Size of dst in bytes.
+    /// @return Number of bytes written, or 0 if dst is too small. Nothing is encoded if 0 is returned.
+    size_type GpsTrackEncoder::encode(const FixedGpsPosition &position, char *dst, size_type dst_size)
+    {
+        size_type size;
+        if (dst_size >= track_record_max_size)
+        {
+            size = encode_unchecked(position, dst);
+        }
+        else
+        {
+            char record[track_record_max_size];
+            size = encode_unchecked(position, record);
+            if (size > dst_size)
+            {
+                return 0;
+            }
+
+            for (size_type i = 0; i < size; ++i)
+            {
+                dst[i] = record[i];
+            }
+        }
+
+        update_previous(m_previous, position);
+        return size;
+    }
+
+    /// @brief Encode a floating point record, rounded to fixed point. See to_fixed_position().
+    size_type GpsTrackEncoder::encode(const GpsPosition &position, char *dst, size_type dst_size)
+    {
+        return encode(to_fixed_position(position), dst, dst_size);
+    }
+
+    /// @brief Forget the previous record, so the next record can be decoded on its own.
+    void GpsTrackEncoder::reset()
+    {
+        m_previous = {};
+    }
+
+    /// @brief Encode a record into a buffer of at least track_record_max_size bytes.
+    size_type GpsTrackEncoder::encode_unchecked(const FixedGpsPosition &position, char *dst)
+    {
+        unsigned char presence = position.fields;
+        bool satellites_changed = position.number_satellites != m_previous.number_satellites;
+
+        char *p = dst;
+        *p++ = (char)presence;
+        *p++ = (char)((position.fix_quality & track_fix_mask) |
+                      (((unsigned char)position.talker & track_talker_mask) << track_talker_shift) |
+                      (satellites_changed ? track_satellites_bit : 0));
+
+        if (satellites_changed)
+        {
+            *p++ = (char)position.number_satellites;
+        }
+
+        if (is_present(presence, PositionField::Time))
+        {
+            p = write_delta((int32_t)position.time_ms, (int32_t)m_previous.time_ms, p);
+        }
+        if (is_present(presence, PositionField::Latitude))
+        {
+            p = write_delta(position.latitude, m_previous.latitude, p);
+        }
+        if (is_present(presence, PositionField::Longitude))
+        {
+            p = write_delta(position.longitude, m_previous.longitude, p);
+        }
+        if (is_present(presence, PositionField::Dilution))
+        {
+            p = write_delta(position.horizontal_dilution, m_previous.horizontal_dilution, p);
+        }
+        if (is_present(presence, PositionField::Altitude))
+        {
+            p = write_delta(position.altitude_msl, m_previous.altitude_msl, p);
+        }
+        if (is_present(presence, PositionField::GeoidHeight))
+        {
+            p = write_delta(position.geoid_height, m_previous.geoid_height, p);
+        }
+
+        return (size_type)(p - dst);
+    }
+
+    /// @brief Initialize the decoder. The first record is decoded against an all zero record.
+    GpsTrackDecoder::GpsTrackDecoder() : m_previous({})
+    {
+    }
+
+    /// @brief Decode a record. Missing fields are zero, and the timestamp is rebuilt from time_ms.
+    ///
+    /// @param src Encoded records.
+    /// @param size Number of bytes in src.
+    /// @param position Decoded record. Unchanged if 0 is returned.
+    /// @return Number of bytes consumed, or 0 if src does not hold a whole record.
+    size_type GpsTrackDecoder::decode(const char *src, size_type size, FixedGpsPosition &position)
+    {
+        if (size < 2)
+        {
+            return 0;
+        }
+
+        const char *p = src;
+        const char *end = src + size;
+
+        FixedGpsPosition result = {};
+        unsigned char presence = (unsigned char)*p++;
+        unsigned char meta = (unsigned char)*p++;
+
+        result.fields = presence;
+        result.fix_quality = meta & track_fix_mask;
+        result.talker = (Talker)((meta >> track_talker_shift) & track_talker_mask);
+        result.number_satellites = m_previous.number_satellites;
+
+        if (meta & track_satellites_bit)
+        {
+            if (p == end)
+            {
+                return 0;
+            }
+            result.number_satellites = (unsigned char)*p++;
+        }
+
+        if (is_present(presence, PositionField::Time))
+        {
+            int32_t time_ms;
+            if (!(p = read_delta(p, end, (int32_t)m_previous.time_ms, time_ms)))
+            {
+                return 0;
+            }
+            result.time_ms = (uint32_t)time_ms;
+
+            uint32_t seconds = result.time_ms / 1000;
+            result.timestamp = (unsigned)((seconds / 3600) * 10000 + (seconds / 60 % 60) * 100 + seconds % 60);
+        }
+        if (is_present(presence, PositionField::Latitude) &&
+            !(p = read_delta(p, end, m_previous.latitude, result.latitude)))
+        {
+            return 0;
+        }
+        if (is_present(presence, PositionField::Longitude) &&
+            !(p = read_delta(p, end, m_previous.longitude, result.longitude)))
+        {
+            return 0;
+        }
+        if (is_present(presence, PositionField::Dilution) &&
+            !(p = read_delta(p, end, m_previous.horizontal_dilution, result.horizontal_dilution)))
+        {
+            return 0;
+        }
+        if (is_present(presence, PositionField::Altitude) &&
+            !(p = read_delta(p, end, m_previous.altitude_msl, result.altitude_msl)))
+        {
+            return 0;
+        }
+        if (is_present(presence, PositionField::GeoidHeight) &&
+            !(p = read_delta(p, end, m_previous.geoid_height, result.geoid_height)))
+        {
+            return 0;
+        }
+
+        update_previous(m_previous, result);
+        position = result;
+        return (size_type)(p - src);
+    }
+
+    /// @brief Decode a record into floating point. See to_float_position().
+    size_type GpsTrackDecoder::decode(const char *src, size_type size, GpsPosition &position)
+    {
+        FixedGpsPosition fixed;
+        size_type consumed = decode(src, size, fixed);
+        if (consumed)
+        {
+            position = to_float_position(fixed);
+        }
+        return consumed;
+    }
+
+    /// @brief Forget the previous record. Must match the resets of the encoder.
+    void GpsTrackDecoder::reset()
+    {
+        m_previous = {};
+    }
+
+} // namespace gps
+} // namespace scottz0r
@@ -0,0 +1,83 @@
+/// @file Binary track codec definitions.
+///
+/// This module defines a streaming binary codec for sequences of position records. Each record is a presence byte
+/// followed by the present fields, delta encoded against the previous record and packed as zigzag varints. Fixed point
+/// records round trip exactly.
+#ifndef _SCOTTZ0R_GPS_TRACK_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_TRACK_INCLUDE_GUARD
+
+#include "MicroGps.h"
+#include "MicroGpsTypes.h"
+#include <stdint.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Largest encoded record: presence and meta bytes, satellites, and six 5 byte varints.
+    constexpr size_type track_record_max_size = 33;
+
+    FixedGpsPosition to_fixed_position(const GpsPosition &position);
+
+    GpsPosition to_float_position(const FixedGpsPosition &position);
+
+    namespace _detail
+    {
+        /// @brief Map a signed delta to an unsigned value with small magnitudes first (0, -1, 1, -2, ...).
+        inline uint32_t zigzag_encode(int32_t value)
+        {
+            return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+        }
+
+        /// @brief Inverse of zigzag_encode().
+        inline int32_t zigzag_decode(uint32_t value)
+        {
+            return (int32_t)((value >> 1) ^ (0u - (value & 1)));
+        }
+
+        size_type varint_write(uint32_t value, char *dst);
+
+        size_type varint_read(const char *src, const char *end, uint32_t &value);
+    } // namespace _detail
+
+    /// @brief Streaming encoder for position records.
+    ///
+    /// Records are encoded against the previous record, so a decoder must see every record from the last reset().
+    /// Reset both sides at block boundaries to make blocks independently decodable.
+    class GpsTrackEncoder
+    {
+    public:
+        GpsTrackEncoder();
+
+        size_type encode(const FixedGpsPosition &position, char *dst, size_type dst_size);
+
+        size_type encode(const GpsPosition &position, char *dst, size_type dst_size);
+
+        void reset();
+
+    private:
+        size_type encode_unchecked(const FixedGpsPosition &position, char *dst);
+
+        FixedGpsPosition m_previous;
+    };
+
+    /// @brief Streaming decoder for records written by GpsTrackEncoder.
+    class GpsTrackDecoder
+    {
+    public:
+        GpsTrackDecoder();
+
+        size_type decode(const char *src, size_type size, FixedGpsPosition &position);
+
+        size_type decode(const char *src, size_type size, GpsPosition &position);
+
+        void reset();
+
+    private:
+        FixedGpsPosition m_previous;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_TRACK_INCLUDE_GUARD
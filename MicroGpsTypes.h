@@ -9,6 +9,20 @@ namespace gps
     /// Size type used in GPS project.
     using size_type = unsigned int;
 
+    /// @brief Talker identifiers, taken from the first two characters of an NMEA address field. Unknown is zero so
+    /// that value initialized data reports an unknown talker.
+    enum class Talker : unsigned char
+    {
+        Unknown,
+        GPS,     ///< GP
+        GLONASS, ///< GL
+        Galileo, ///< GA
+        BeiDou,  ///< GB or BD
+        QZSS,    ///< GQ
+        NavIC,   ///< GI
+        GNSS     ///< GN, combined multi-constellation solution.
+    };
+
 } // namespace gps
 } // namespace scottz0r
 
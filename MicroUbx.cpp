@@ -0,0 +1,359 @@
+/// @file MicroUbx implementation.
+#include "MicroUbx.h"
+
+namespace scottz0r
+{
+namespace gps
+{
+    using namespace scottz0r::gps::_detail;
+
+    /// UBX class of acknowledge messages, with the ACK-NAK and ACK-ACK IDs and payload length.
+    static constexpr unsigned char ubx_class_ack = 0x05;
+    static constexpr unsigned char ubx_id_ack_nak = 0x00;
+    static constexpr unsigned char ubx_id_ack_ack = 0x01;
+    static constexpr uint16_t ubx_length_ack = 2;
+
+    /// UBX class of navigation results.
+    static constexpr unsigned char ubx_class_nav = 0x01;
+
+    /// NAV-DOP message ID and payload length.
+    static constexpr unsigned char ubx_id_nav_dop = 0x04;
+    static constexpr uint16_t ubx_length_nav_dop = 18;
+
+    /// NAV-PVT message ID and payload length.
+    static constexpr unsigned char ubx_id_nav_pvt = 0x07;
+    static constexpr uint16_t ubx_length_nav_pvt = 92;
+
+    /// @brief Initialize the class instance, initializing all class members to the default state. The class will be
+    /// ready to process UBX messages after initialization.
+    MicroUbx::MicroUbx()
+        : m_length(0), m_count(0), m_state(State::Sync1), m_message_type(MessageType::Unknown), m_class(0), m_ck_a(0),
+          m_ck_b(0), m_bad(false), m_position({}), m_navigation({}), m_solution({}), m_ack({})
+    {
+    }
+
+    /// @brief Process a byte of a UBX message.
+    ///
+    /// Bytes outside of a frame are skipped until the two sync characters are found. The message_type() method must
+    /// be used to determine the last message processed. The bad() method should be checked to ensure the last
+    /// processed message had the expected length and a valid checksum. Unsupported messages are skipped without
+    /// returning true.
+    ///
+    /// @param c Byte to process.
+    /// @return True if a supported message is ready. False if a message is still being processed.
+    bool MicroUbx::process(char c)
+    {
+        unsigned char b = (unsigned char)c;
+
+        switch (m_state)
+        {
+        case State::Sync1:
+            if (b == ubx_sync_1)
+            {
+                m_state = State::Sync2;
+            }
+            return false;
+
+        case State::Sync2:
+            if (b == ubx_sync_2)
+            {
+                m_ck_a = 0;
+                m_ck_b = 0;
+                m_state = State::Class;
+            }
+            else if (b != ubx_sync_1)
+            {
+                // A repeated first sync character may be the real start of a frame, so only reset otherwise.
+                m_state = State::Sync1;
+            }
+            return false;
+
+        case State::Class:
+            ubx_checksum_add(b, m_ck_a, m_ck_b);
+            m_class = b;
+            m_state = State::Id;
+            return false;
+
+        case State::Id:
+            ubx_checksum_add(b, m_ck_a, m_ck_b);
+            m_message_type = MessageType::Unknown;
+            if (m_class == ubx_class_nav)
+            {
+                if (b == ubx_id_nav_pvt)
+                {
+                    m_message_type = MessageType::NavPvt;
+                }
+                else if (b == ubx_id_nav_dop)
+                {
+                    m_message_type = MessageType::NavDop;
+                }
+            }
+            else if (m_class == ubx_class_ack)
+            {
+                if (b == ubx_id_ack_ack)
+                {
+                    m_message_type = MessageType::AckAck;
+                }
+                else if (b == ubx_id_ack_nak)
+                {
+                    m_message_type = MessageType::AckNak;
+                }
+            }
+            m_state = State::Length1;
+            return false;
+
+        case State::Length1:
+            ubx_checksum_add(b, m_ck_a, m_ck_b);
+            m_length = b;
+            m_state = State::Length2;
+            return false;
+
+        case State::Length2:
+            ubx_checksum_add(b, m_ck_a, m_ck_b);
+            m_length |= (uint16_t)(b << 8);
+
+            if (m_length > ubx_max_length)
+            {
+                // Not a real frame. Look for the next sync.
+                m_state = State::Sync1;
+                return false;
+            }
+
+            m_bad = false;
+            m_count = 0;
+            m_buffer.clear();
+
+            // Supported messages have a fixed length. Anything else is a malformed frame.
+            if ((m_message_type == MessageType::NavPvt && m_length != ubx_length_nav_pvt) ||
+                (m_message_type == MessageType::NavDop && m_length != ubx_length_nav_dop) ||
+                ((m_message_type == MessageType::AckAck || m_message_type == MessageType::AckNak) &&
+                 m_length != ubx_length_ack))
+            {
+                m_bad = true;
+            }
+
+            m_state = m_length > 0 ? State::Payload : State::ChecksumA;
+            return false;
+
+        case State::Payload:
+            ubx_checksum_add(b, m_ck_a, m_ck_b);
+            if (m_message_type != MessageType::Unknown)
+            {
+                m_buffer.append(c);
+            }
+
+            ++m_count;
+            if (m_count == m_length)
+            {
+                m_state = State::ChecksumA;
+            }
+            return false;
+
+        case State::ChecksumA:
+            if (b != m_ck_a)
+            {
+                m_bad = true;
+            }
+            m_state = State::ChecksumB;
+            return false;
+
+        case State::ChecksumB:
+            if (b != m_ck_b)
+            {
+                m_bad = true;
+            }
+            m_state = State::Sync1;
+
+            if (m_message_type == MessageType::Unknown)
+            {
+                return false;
+            }
+
+            if (!m_bad)
+            {
+                process_payload();
+            }
+
+            // Return indicator that message is ready.
+            return true;
+
+        default:
+            // Code coverage exclusion: All states are handled.
+            m_state = State::Sync1;
+            return false;
+        }
+    }
+
+    /// @brief Process bytes until a message is ready or the input is exhausted. The caller handles the message and
+    /// then resumes at the returned offset.
+    ///
+    /// @param data Bytes to process.
+    /// @param size Number of bytes in data.
+    /// @return Number of bytes consumed. A message is ready if process() returned true for the last consumed byte,
+    /// which is the case whenever the return is less than size.
+    size_type MicroUbx::process_until_complete(const char *data, size_type size)
+    {
+        for (size_type i = 0; i < size; ++i)
+        {
+            if (process(data[i]))
+            {
+                return i + 1;
+            }
+        }
+
+        return size;
+    }
+
+    /// @brief Decode the payload of a supported message with a valid checksum.
+    void MicroUbx::process_payload()
+    {
+        switch (m_message_type)
+        {
+        case MessageType::NavPvt:
+            process_nav_pvt();
+            break;
+        case MessageType::NavDop:
+            process_nav_dop();
+            break;
+        case MessageType::AckAck:
+        case MessageType::AckNak:
+            process_ack();
+            break;
+        default:
+            // Do nothing.
+            break;
+        }
+    }
+
+    /// @brief Decode a NAV-PVT payload. Offsets are from the u-blox protocol specification.
+    void MicroUbx::process_nav_pvt()
+    {
+        const char *p = m_buffer.get();
+
+        unsigned year = read_u16_le(p + 4);
+        unsigned char month = (unsigned char)p[6];
+        unsigned char day = (unsigned char)p[7];
+        unsigned char hour = (unsigned char)p[8];
+        unsigned char minute = (unsigned char)p[9];
+        unsigned char second = (unsigned char)p[10];
+        unsigned char valid = (unsigned char)p[11];
+        unsigned char fix_type = (unsigned char)p[20];
+        unsigned char flags = (unsigned char)p[21];
+        bool fix_ok = flags & 0x01;
+        unsigned char carrier_solution = flags >> 6;
+
+        unsigned timestamp = hour * 10000u + minute * 100u + second;
+
+        // Nanoseconds adjust the second, and may be negative.
+        int32_t time_ms = (int32_t)(((hour * 60ul + minute) * 60ul + second) * 1000ul) + read_i32_le(p + 16) / 1000000;
+        if (time_ms < 0)
+        {
+            time_ms = 0;
+        }
+
+        // Map the UBX fix type and flags onto the NMEA GGA fix quality.
+        unsigned char fix_quality;
+        if (fix_type == 1)
+        {
+            fix_quality = 6; // Dead reckoning only.
+        }
+        else if (!fix_ok || fix_type == 0 || fix_type == 5)
+        {
+            fix_quality = 0;
+        }
+        else if (carrier_solution == 2)
+        {
+            fix_quality = 4; // RTK fixed.
+        }
+        else if (carrier_solution == 1)
+        {
+            fix_quality = 5; // RTK float.
+        }
+        else if (flags & 0x02)
+        {
+            fix_quality = 2; // Differential.
+        }
+        else
+        {
+            fix_quality = 1;
+        }
+
+        float latitude = read_i32_le(p + 28) * 1e-7f;
+        float longitude = read_i32_le(p + 24) * 1e-7f;
+        int32_t height = read_i32_le(p + 32);
+        int32_t height_msl = read_i32_le(p + 36);
+
+        // Horizontal dilution is not part of NAV-PVT. Keep the value from NAV-DOP.
+        float horizontal_dilution = m_position.horizontal_dilution;
+        unsigned char dilution_field = m_position.fields & position_field_bit(PositionField::Dilution);
+        m_position = {};
+        m_position.timestamp = timestamp;
+        m_position.time_ms = (uint32_t)time_ms;
+        m_position.talker = Talker::GNSS;
+        m_position.fix_quality = fix_quality;
+        m_position.number_satellites = (unsigned char)p[23];
+        m_position.latitude = latitude;
+        m_position.longitude = longitude;
+        m_position.horizontal_dilution = horizontal_dilution;
+        // The other position fields are part of NAV-PVT, but like empty NMEA fields the time is only present when
+        // the receiver flags it valid (validTime), and the coordinates only with a fix.
+        m_position.fields = dilution_field | position_field_bit(PositionField::FixQuality) |
+                            position_field_bit(PositionField::Satellites);
+        if (valid & 0x02)
+        {
+            m_position.fields |= position_field_bit(PositionField::Time);
+        }
+        if (fix_quality != 0)
+        {
+            m_position.fields |= position_field_bit(PositionField::Latitude) |
+                                 position_field_bit(PositionField::Longitude) |
+                                 position_field_bit(PositionField::Altitude) |
+                                 position_field_bit(PositionField::GeoidHeight);
+        }
+        m_position.altitude_msl = height_msl / 1000.0f;
+        m_position.geoid_height = (height - height_msl) / 1000.0f;
+
+        // Ground speed in mm/s to hundredths of a knot (1 knot = 514.444 mm/s), and heading in 1e-5 degrees to
+        // hundredths of a degree.
+        int32_t ground_speed = read_i32_le(p + 60);
+        int32_t heading = read_i32_le(p + 64);
+        uint32_t speed = ground_speed > 0 ? ((uint32_t)ground_speed * 1944u + 5000u) / 10000u : 0;
+
+        m_navigation = {};
+        m_navigation.timestamp = timestamp;
+        m_navigation.time_ms = (uint32_t)time_ms;
+        m_navigation.talker = Talker::GNSS;
+        m_navigation.valid = fix_ok;
+        m_navigation.date = (valid & 0x01) ? pack_date(year, month, day) : 0;
+        m_navigation.speed_knots = speed > 0xFFFF ? 0xFFFF : (unsigned short)speed;
+        m_navigation.course = heading > 0 ? (unsigned short)(heading / 1000) : 0;
+        m_navigation.latitude = latitude;
+        m_navigation.longitude = longitude;
+
+        m_solution.mode = 'A';
+        m_solution.fix_type = (fix_type == 2 || fix_type == 3) ? fix_type : 1;
+    }
+
+    /// @brief Decode a NAV-DOP payload. UBX dilutions are already hundredths.
+    void MicroUbx::process_nav_dop()
+    {
+        const char *p = m_buffer.get();
+
+        m_solution.pdop = read_u16_le(p + 6);
+        m_solution.vdop = read_u16_le(p + 10);
+        m_solution.hdop = read_u16_le(p + 12);
+        m_position.horizontal_dilution = m_solution.hdop / 100.0f;
+        m_position.fields |= position_field_bit(PositionField::Dilution);
+    }
+
+    /// @brief Decode an ACK-ACK or ACK-NAK payload: the class and ID of the acknowledged message.
+    void MicroUbx::process_ack()
+    {
+        const char *p = m_buffer.get();
+
+        m_ack.command = (unsigned short)(((unsigned char)p[0] << 8) | (unsigned char)p[1]);
+        m_ack.status = m_message_type == MessageType::AckAck ? AckStatus::Succeeded : AckStatus::Failed;
+    }
+
+} // namespace gps
+} // namespace scottz0r
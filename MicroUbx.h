@@ -0,0 +1,166 @@
+/// @file MicroUbx definition module.
+///
+/// This module defines the MicroUbx class, which processes u-blox UBX binary messages with low overhead.
+#ifndef _SCOTTZ0R_MICRO_UBX_INCLUDE_GUARD
+#define _SCOTTZ0R_MICRO_UBX_INCLUDE_GUARD
+
+#include "MicroGps.h"
+#include "MicroGpsTypes.h"
+#include <stdint.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// First UBX sync character.
+    constexpr unsigned char ubx_sync_1 = 0xB5;
+
+    /// Second UBX sync character.
+    constexpr unsigned char ubx_sync_2 = 0x62;
+
+    /// Longest payload accepted before a sync is treated as a false match in binary data.
+    constexpr uint16_t ubx_max_length = 4096;
+
+    /// @brief Detail implementations. Do not used. Exposed for test coverage.
+    namespace _detail
+    {
+        /// @brief Add a byte to a running UBX (8-bit Fletcher) checksum.
+        inline void ubx_checksum_add(unsigned char byte, unsigned char &ck_a, unsigned char &ck_b)
+        {
+            ck_a += byte;
+            ck_b += ck_a;
+        }
+
+        /// @brief Read a little endian unsigned 16 bit integer.
+        inline uint16_t read_u16_le(const char *p)
+        {
+            return (uint16_t)((unsigned char)p[0] | ((unsigned char)p[1] << 8));
+        }
+
+        /// @brief Read a little endian unsigned 32 bit integer.
+        inline uint32_t read_u32_le(const char *p)
+        {
+            return (uint32_t)(unsigned char)p[0] | ((uint32_t)(unsigned char)p[1] << 8) |
+                   ((uint32_t)(unsigned char)p[2] << 16) | ((uint32_t)(unsigned char)p[3] << 24);
+        }
+
+        /// @brief Read a little endian signed 32 bit integer.
+        inline int32_t read_i32_le(const char *p)
+        {
+            return (int32_t)read_u32_le(p);
+        }
+    } // namespace _detail
+
+    /// @brief UBX binary message processing class for embedded systems.
+    ///
+    /// Drop in alternative to MicroGps for u-blox receivers configured for UBX output. Messages are collected one
+    /// byte at a time and fill the same GpsPosition, GpsNavigation and GpsSolution records as the NMEA parser, so the
+    /// application code does not change with the protocol.
+    class MicroUbx
+    {
+        enum class State : unsigned char
+        {
+            Sync1,
+            Sync2,
+            Class,
+            Id,
+            Length1,
+            Length2,
+            Payload,
+            ChecksumA,
+            ChecksumB
+        };
+
+    public:
+        /// @brief Supported message types that this class can process.
+        enum class MessageType : unsigned char
+        {
+            NavPvt,
+            NavDop,
+            AckAck,
+            AckNak,
+            Unknown
+        };
+
+        MicroUbx();
+
+        bool process(char c);
+
+        size_type process_until_complete(const char *data, size_type size);
+
+        /// @brief Get the GPS position data. Data will be valid after a NAV-PVT message has been parsed successfully
+        /// up to the start of the next NAV-PVT message. Horizontal dilution comes from the last NAV-DOP message. As
+        /// with empty NMEA fields, the time field is left out unless the receiver flags it valid, and the coordinates
+        /// and altitude are left out without a fix.
+        inline const GpsPosition &position_data() const
+        {
+            return m_position;
+        }
+
+        /// @brief Get the navigation data. Data will be valid after a NAV-PVT message has been parsed successfully up
+        /// to the start of the next NAV-PVT message.
+        inline const GpsNavigation &navigation_data() const
+        {
+            return m_navigation;
+        }
+
+        /// @brief Get the solution data. Fix type comes from NAV-PVT and dilutions from NAV-DOP. UBX does not report
+        /// the used satellite set in these messages, so the active set is empty.
+        inline const GpsSolution &solution_data() const
+        {
+            return m_solution;
+        }
+
+        /// @brief Get the acknowledge data. Data will be valid after an ACK-ACK or ACK-NAK message has been parsed
+        /// successfully. The command is the acknowledged class << 8 | message ID.
+        inline const GpsAck &ack_data() const
+        {
+            return m_ack;
+        }
+
+        /// @brief Returns true if the last message parse is invalid.
+        inline bool bad() const
+        {
+            return m_bad;
+        }
+
+        /// @brief Returns true if the last message parse was successful.
+        inline bool good() const
+        {
+            return !bad();
+        }
+
+        /// @brief Get the last parsed message type.
+        inline MessageType message_type() const
+        {
+            return m_message_type;
+        }
+
+    private:
+        void process_payload();
+
+        void process_nav_pvt();
+
+        void process_nav_dop();
+
+        void process_ack();
+
+        _detail::GpsBuffer<92> m_buffer;
+        uint16_t m_length;
+        uint16_t m_count;
+        State m_state;
+        MessageType m_message_type;
+        unsigned char m_class;
+        unsigned char m_ck_a;
+        unsigned char m_ck_b;
+        bool m_bad;
+        GpsPosition m_position;
+        GpsNavigation m_navigation;
+        GpsSolution m_solution;
+        GpsAck m_ack;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_MICRO_UBX_INCLUDE_GUARD
@@ -1,6 +1,6 @@
 #include <MicroGps.h>
 
-using namespace scottz0r;
+using namespace scottz0r::gps;
 
 MicroGps gps;
 
@@ -12,23 +12,28 @@ void setup()
 
 void loop()
 {
-    while(Serial1.available())
+    char buffer[64];
+    size_type size = Serial1.readBytes(buffer, min(Serial1.available(), (int)sizeof(buffer)));
+    size_type offset = 0;
+
+    // The parser returns after each sentence, then resumes at the returned offset.
+    while(offset < size)
     {
-        char c = Serial1.read();
-        if(gps.process(c) && gps.good())
+        offset += gps.process_until_complete(buffer + offset, size - offset);
+        if(gps.complete() && gps.good())
         {
-            if(gps.message_type() == MicroGps::MessageType::GPGGA)
+            if(gps.message_type() == MicroGps::MessageType::GGA)
             {
                 // Do something with gps.position_data()
-                handle_gpgga();
+                handle_gga();
             }
         }
     }
 }
 
-void handle_gpgga()
+void handle_gga()
 {
-    Serial.print("GPGGA-> ");
+    Serial.print("GGA-> ");
     if(gps.position_data().fix_quality == 0)
     {
         Serial.println("No fix (quality is 0)");
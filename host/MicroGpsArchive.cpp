@@ -0,0 +1,939 @@
+/// @file Lossless NMEA archive implementation.
+#include "MicroGpsArchive.h"
+#include "../MicroGps.h"
+#include "../MicroGpsFormat.h"
+#include "MicroGpsBytes.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    using namespace scottz0r::gps::_detail;
+
+    /// Sizes of the fixed parts of the file, in bytes.
+    static constexpr size_type file_header_size = 16;
+    static constexpr size_type index_entry_size = 24;
+    static constexpr size_type trailer_size = 24;
+
+    static constexpr uint16_t file_version = 1;
+    static const char file_magic[4] = {'M', 'G', 'N', 'A'};
+    static const char trailer_magic[4] = {'M', 'G', 'N', 'I'};
+
+    /// Record headers. A sentence header is ((type index + 1) << 3) | flags.
+    static constexpr unsigned char record_raw = 0x00;
+    static constexpr unsigned char record_type = 0x01;
+    static constexpr unsigned char sentence_count_changed = 0x01;
+    static constexpr unsigned char sentence_lf_only = 0x02;
+    static constexpr unsigned char sentence_codes_repeated = 0x04;
+    static constexpr unsigned char sentence_type_shift = 3;
+
+    /// Field codes, four per byte with the first field in the low bits.
+    static constexpr unsigned char code_same = 0;
+    static constexpr unsigned char code_delta = 1;
+    static constexpr unsigned char code_format = 2;
+    static constexpr unsigned char code_literal = 3;
+
+    /// Number format: sign, decimal point, integer digits and fraction digits.
+    static constexpr uint16_t format_negative = 0x200;
+    static constexpr uint16_t format_point = 0x100;
+    static constexpr size_type format_max_digits = 18;
+
+    static const char hex_digits[] = "0123456789ABCDEF";
+
+    static inline size_type format_integer_digits(uint16_t format)
+    {
+        return (format >> 4) & 0x0F;
+    }
+
+    static inline size_type format_fraction_digits(uint16_t format)
+    {
+        return format & 0x0F;
+    }
+
+    static inline uint64_t zigzag_encode64(int64_t value)
+    {
+        return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    }
+
+    static inline int64_t zigzag_decode64(uint64_t value)
+    {
+        return (int64_t)((value >> 1) ^ (0ULL - (value & 1)));
+    }
+
+    /// @brief Append an unsigned LEB128 varint of at most 10 bytes.
+    static inline void put_varint(uint64_t value, std::vector<char> &out)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back((char)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((char)value);
+    }
+
+    /// @brief Read an unsigned LEB128 varint.
+    ///
+    /// @return False if the input ends first or the varint is longer than 10 bytes.
+    static inline bool get_varint(const char *&p, const char *end, uint64_t &value)
+    {
+        uint64_t result = 0;
+        for (size_type i = 0; i < 10 && p < end; ++i)
+        {
+            unsigned char b = (unsigned char)*p++;
+            result |= (uint64_t)(b & 0x7F) << (7 * i);
+            if (!(b & 0x80))
+            {
+                value = result;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static inline int hex_value(char c)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+        if (c >= 'A' && c <= 'F')
+        {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    /// @brief Split a field into a number format and value, if it is a plain decimal number ("-12.340", "007", "").
+    ///
+    /// @return False if the field must be stored as text.
+    static bool parse_number(const char *field, size_type size, uint16_t &format, uint64_t &value)
+    {
+        size_type i = 0;
+        uint16_t result = 0;
+        if (i < size && field[i] == '-')
+        {
+            result |= format_negative;
+            ++i;
+        }
+
+        uint64_t number = 0;
+        size_type integer_digits = 0;
+        while (i < size && _detail::is_digit(field[i]))
+        {
+            number = number * 10 + (uint64_t)(field[i++] - '0');
+            ++integer_digits;
+            if (integer_digits > 15)
+            {
+                return false;
+            }
+        }
+
+        size_type fraction_digits = 0;
+        if (i < size && field[i] == '.')
+        {
+            result |= format_point;
+            ++i;
+            while (i < size && _detail::is_digit(field[i]))
+            {
+                number = number * 10 + (uint64_t)(field[i++] - '0');
+                ++fraction_digits;
+                if (fraction_digits > 15)
+                {
+                    return false;
+                }
+            }
+        }
+
+        if (i != size || integer_digits + fraction_digits > format_max_digits)
+        {
+            return false;
+        }
+
+        format = (uint16_t)(result | (integer_digits << 4) | fraction_digits);
+        value = number;
+        return true;
+    }
+
+    /// @brief Returns true if a format read from an archive can be printed, and the value fits its digits.
+    static bool is_valid_number(uint16_t format, uint64_t value)
+    {
+        size_type digits = format_integer_digits(format) + format_fraction_digits(format);
+        if ((format & ~(format_negative | format_point | 0xFF)) || digits > format_max_digits ||
+            (format_fraction_digits(format) > 0 && !(format & format_point)))
+        {
+            return false;
+        }
+
+        uint64_t limit = 1;
+        for (size_type i = 0; i < digits; ++i)
+        {
+            limit *= 10;
+        }
+        return value < limit;
+    }
+
+    /// @brief Append a number exactly as it was parsed by parse_number().
+    static void print_number(uint16_t format, uint64_t value, std::string &out)
+    {
+        size_type integer_digits = format_integer_digits(format);
+        size_type digits = integer_digits + format_fraction_digits(format);
+
+        char buffer[format_max_digits];
+        for (size_type i = digits; i > 0; --i)
+        {
+            buffer[i - 1] = (char)('0' + value % 10);
+            value /= 10;
+        }
+
+        if (format & format_negative)
+        {
+            out.push_back('-');
+        }
+        out.append(buffer, integer_digits);
+        if (format & format_point)
+        {
+            out.push_back('.');
+            out.append(buffer + integer_digits, digits - integer_digits);
+        }
+    }
+
+    /// @brief Encode a block of NMEA text. Every byte is kept; text after the last line end is stored verbatim.
+    ///
+    /// @param data Text to encode.
+    /// @param size Number of bytes in data.
+    /// @param out Encoded bytes are appended here.
+    void GpsArchiveEncoder::encode(const char *data, size_type size, std::vector<char> &out)
+    {
+        size_type start = 0;
+        for (size_type i = 0; i < size; ++i)
+        {
+            if (data[i] == '\n')
+            {
+                encode_line(data + start, i + 1 - start, out);
+                start = i + 1;
+            }
+        }
+
+        if (start < size)
+        {
+            encode_line(data + start, size - start, out);
+        }
+    }
+
+    /// @brief Forget every sentence type and prediction.
+    void GpsArchiveEncoder::reset()
+    {
+        m_types.clear();
+    }
+
+    /// @brief Encode one line, including its line end, as a sentence or verbatim.
+    void GpsArchiveEncoder::encode_line(const char *line, size_type size, std::vector<char> &out)
+    {
+        if (encode_sentence(line, size, out))
+        {
+            return;
+        }
+
+        out.push_back((char)record_raw);
+        put_varint(size, out);
+        out.insert(out.end(), line, line + size);
+    }
+
+    /// @brief Encode "$<type>,<fields>*HH\r\n" (or "\n") with a good, upper case checksum.
+    ///
+    /// @return False if the line is not such a sentence. Nothing is written then.
+    bool GpsArchiveEncoder::encode_sentence(const char *line, size_type size, std::vector<char> &out)
+    {
+        if (size < 5 || line[size - 1] != '\n' || line[0] != '$')
+        {
+            return false;
+        }
+
+        bool lf_only = line[size - 2] != '\r';
+        size_type text_size = size - (lf_only ? 1 : 2);
+        if (text_size < 4 || line[text_size - 3] != '*')
+        {
+            return false;
+        }
+
+        const char *body = line + 1;
+        size_type body_size = text_size - 4;
+        int high = hex_value(line[text_size - 2]);
+        int low = hex_value(line[text_size - 1]);
+        if (high < 0 || low < 0 || (unsigned char)nmea_checksum(body, body_size) != (unsigned)(high << 4 | low))
+        {
+            return false;
+        }
+
+        // Type name and field count.
+        size_type name_size = 0;
+        size_type field_count = 0;
+        for (size_type i = 0; i < body_size; ++i)
+        {
+            if (body[i] == ',')
+            {
+                if (field_count == 0)
+                {
+                    name_size = i;
+                }
+                ++field_count;
+            }
+        }
+        if (field_count == 0)
+        {
+            name_size = body_size;
+        }
+        if (field_count > archive_max_fields)
+        {
+            return false;
+        }
+
+        size_type index = 0;
+        while (index < m_types.size() && m_types[index].name.compare(0, std::string::npos, body, name_size) != 0)
+        {
+            ++index;
+        }
+
+        if (index == m_types.size())
+        {
+            if (index == archive_max_types)
+            {
+                return false;
+            }
+
+            out.push_back((char)record_type);
+            put_varint(name_size, out);
+            out.insert(out.end(), body, body + name_size);
+            m_types.push_back({std::string(body, name_size), {}, {}});
+        }
+
+        ArchiveType &type = m_types[index];
+        bool count_changed = field_count != type.fields.size();
+        if (count_changed)
+        {
+            type.fields.resize(field_count);
+        }
+
+        unsigned char codes[archive_max_fields];
+        m_payload.clear();
+
+        const char *field = body + name_size + 1;
+        const char *body_end = body + body_size;
+        for (size_type i = 0; i < field_count; ++i)
+        {
+            const char *field_end = field;
+            while (field_end < body_end && *field_end != ',')
+            {
+                ++field_end;
+            }
+
+            ArchiveField &state = type.fields[i];
+            size_type field_size = (size_type)(field_end - field);
+            uint16_t format;
+            uint64_t value;
+            if (parse_number(field, field_size, format, value))
+            {
+                uint64_t delta = 0;
+                if (state.numeric && state.format == format)
+                {
+                    uint64_t predicted = state.value + state.delta;
+                    codes[i] = value == predicted ? code_same : code_delta;
+                    if (codes[i] == code_delta)
+                    {
+                        put_varint(zigzag_encode64((int64_t)(value - predicted)), m_payload);
+                    }
+                    delta = value - state.value;
+                }
+                else
+                {
+                    codes[i] = code_format;
+                    m_payload.push_back((char)format);
+                    m_payload.push_back((char)(format >> 8));
+                    put_varint(value, m_payload);
+                }
+
+                state.numeric = true;
+                state.format = format;
+                state.value = value;
+                state.delta = delta;
+            }
+            else if (!state.numeric && state.text.compare(0, std::string::npos, field, field_size) == 0)
+            {
+                codes[i] = code_same;
+            }
+            else
+            {
+                codes[i] = code_literal;
+                put_varint(field_size, m_payload);
+                m_payload.insert(m_payload.end(), field, field_end);
+
+                state.numeric = false;
+                state.text.assign(field, field_size);
+            }
+
+            field = field_end + 1;
+        }
+
+        bool repeated = !count_changed && type.codes.size() == field_count;
+        for (size_type i = 0; repeated && i < field_count; ++i)
+        {
+            repeated = type.codes[i] == codes[i];
+        }
+
+        unsigned char header = (unsigned char)((index + 1) << sentence_type_shift);
+        header |= count_changed ? sentence_count_changed : 0;
+        header |= lf_only ? sentence_lf_only : 0;
+        header |= repeated ? sentence_codes_repeated : 0;
+        out.push_back((char)header);
+
+        if (count_changed)
+        {
+            put_varint(field_count, out);
+        }
+
+        if (!repeated)
+        {
+            type.codes.assign(codes, codes + field_count);
+            for (size_type i = 0; i < field_count; i += 4)
+            {
+                unsigned char packed = 0;
+                for (size_type j = 0; j < 4 && i + j < field_count; ++j)
+                {
+                    packed |= (unsigned char)(codes[i + j] << (2 * j));
+                }
+                out.push_back((char)packed);
+            }
+        }
+
+        out.insert(out.end(), m_payload.begin(), m_payload.end());
+        return true;
+    }
+
+    /// @brief Decode text written by GpsArchiveEncoder.
+    ///
+    /// @param src Encoded bytes.
+    /// @param size Number of bytes in src.
+    /// @param out Decoded text is appended here.
+    /// @return False if src is truncated or corrupt. Text decoded before the error is still appended.
+    bool GpsArchiveDecoder::decode(const char *src, size_type size, std::string &out)
+    {
+        const char *p = src;
+        const char *end = src + size;
+        while (p < end)
+        {
+            unsigned char header = (unsigned char)*p++;
+            uint64_t length;
+            if (header == record_raw || header == record_type)
+            {
+                if (!get_varint(p, end, length) || length > (uint64_t)(end - p))
+                {
+                    return false;
+                }
+
+                if (header == record_raw)
+                {
+                    out.append(p, (size_t)length);
+                }
+                else
+                {
+                    if (m_types.size() == archive_max_types)
+                    {
+                        return false;
+                    }
+                    m_types.push_back({std::string(p, (size_t)length), {}, {}});
+                }
+
+                p += length;
+                continue;
+            }
+
+            size_type index = (header >> sentence_type_shift) - 1;
+            if (header < (1 << sentence_type_shift) || index >= m_types.size())
+            {
+                return false;
+            }
+
+            ArchiveType &type = m_types[index];
+            if (header & sentence_count_changed)
+            {
+                uint64_t count;
+                if (!get_varint(p, end, count) || count > archive_max_fields)
+                {
+                    return false;
+                }
+                type.fields.resize((size_t)count);
+            }
+
+            size_type field_count = (size_type)type.fields.size();
+            if (header & sentence_codes_repeated)
+            {
+                if (type.codes.size() != field_count)
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                if ((size_type)(end - p) < (field_count + 3) / 4)
+                {
+                    return false;
+                }
+
+                type.codes.resize(field_count);
+                for (size_type i = 0; i < field_count; ++i)
+                {
+                    type.codes[i] = (unsigned char)(((unsigned char)p[i / 4] >> (2 * (i % 4))) & 0x03);
+                }
+                p += (field_count + 3) / 4;
+            }
+
+            size_t start = out.size();
+            out.push_back('$');
+            out.append(type.name);
+            for (size_type i = 0; i < field_count; ++i)
+            {
+                out.push_back(',');
+
+                ArchiveField &state = type.fields[i];
+                switch (type.codes[i])
+                {
+                case code_same:
+                    if (state.numeric)
+                    {
+                        state.value += state.delta;
+                        print_number(state.format, state.value, out);
+                    }
+                    else
+                    {
+                        out.append(state.text);
+                    }
+                    break;
+
+                case code_delta: {
+                    uint64_t encoded;
+                    if (!state.numeric || !get_varint(p, end, encoded))
+                    {
+                        return false;
+                    }
+
+                    uint64_t value = state.value + state.delta + (uint64_t)zigzag_decode64(encoded);
+                    if (!is_valid_number(state.format, value))
+                    {
+                        return false;
+                    }
+                    state.delta = value - state.value;
+                    state.value = value;
+                    print_number(state.format, value, out);
+                    break;
+                }
+
+                case code_format: {
+                    uint64_t value;
+                    if (end - p < 2)
+                    {
+                        return false;
+                    }
+                    uint16_t format = get_u16(p);
+                    p += 2;
+                    if (!get_varint(p, end, value) || !is_valid_number(format, value))
+                    {
+                        return false;
+                    }
+
+                    state.numeric = true;
+                    state.format = format;
+                    state.value = value;
+                    state.delta = 0;
+                    print_number(format, value, out);
+                    break;
+                }
+
+                default:
+                    if (!get_varint(p, end, length) || length > (uint64_t)(end - p))
+                    {
+                        return false;
+                    }
+
+                    state.numeric = false;
+                    state.text.assign(p, (size_t)length);
+                    out.append(state.text);
+                    p += length;
+                    break;
+                }
+            }
+
+            char checksum = nmea_checksum(out.data() + start + 1, (size_type)(out.size() - start - 1));
+            out.push_back('*');
+            out.push_back(hex_digits[(checksum >> 4) & 0x0F]);
+            out.push_back(hex_digits[checksum & 0x0F]);
+            if (!(header & sentence_lf_only))
+            {
+                out.push_back('\r');
+            }
+            out.push_back('\n');
+        }
+
+        return true;
+    }
+
+    /// @brief Forget every sentence type and prediction. Must match the resets of the encoder.
+    void GpsArchiveDecoder::reset()
+    {
+        m_types.clear();
+    }
+
+    /// @brief Initialize the writer.
+    ///
+    /// @param block_size Number of input bytes per block, at least 256.
+    GpsArchiveWriter::GpsArchiveWriter(size_type block_size)
+        : m_file(nullptr), m_block_size(block_size), m_raw_size(0), m_offset(0), m_bad(false)
+    {
+    }
+
+    GpsArchiveWriter::~GpsArchiveWriter()
+    {
+        close();
+    }
+
+    /// @brief Create or truncate an archive file and write its header.
+    ///
+    /// @return False if the file cannot be created or the block size is too small.
+    bool GpsArchiveWriter::open(const char *path)
+    {
+        close();
+
+        if (m_block_size < 256)
+        {
+            return false;
+        }
+
+        m_file = fopen(path, "wb");
+        if (!m_file)
+        {
+            return false;
+        }
+
+        m_encoder.reset();
+        m_pending.clear();
+        m_blocks.clear();
+        m_raw_size = 0;
+        m_offset = file_header_size;
+
+        char header[file_header_size] = {};
+        for (size_type i = 0; i < 4; ++i)
+        {
+            header[i] = file_magic[i];
+        }
+        put_u16(header + 4, file_version);
+        put_u32(header + 8, (uint32_t)m_block_size);
+
+        m_bad = fwrite(header, 1, sizeof(header), m_file) != sizeof(header);
+        return !m_bad;
+    }
+
+    /// @brief Append input text. Whole blocks are encoded and written as soon as they are buffered.
+    ///
+    /// @return False if the file is not open or a write failed.
+    bool GpsArchiveWriter::write(const char *data, size_type size)
+    {
+        if (!m_file || m_bad)
+        {
+            return false;
+        }
+
+        m_pending.append(data, size);
+        m_raw_size += size;
+
+        size_type start = 0;
+        while (m_pending.size() - start >= m_block_size)
+        {
+            // Cut after the last line end in the block, so sentences are not split between blocks.
+            size_type cut = m_block_size;
+            while (cut > 0 && m_pending[start + cut - 1] != '\n')
+            {
+                --cut;
+            }
+            if (cut == 0)
+            {
+                cut = m_block_size;
+            }
+
+            if (!flush_block(start, cut))
+            {
+                return false;
+            }
+            start += cut;
+        }
+
+        m_pending.erase(0, start);
+        return true;
+    }
+
+    /// @brief Write the buffered input, the index and the trailer, then close the file.
+    ///
+    /// @return False if the file was not open or a write failed. The file is closed either way.
+    bool GpsArchiveWriter::close()
+    {
+        if (!m_file)
+        {
+            return false;
+        }
+
+        if (!m_pending.empty())
+        {
+            flush_block(0, (size_type)m_pending.size());
+            m_pending.clear();
+        }
+
+        uint64_t index_offset = m_offset;
+        for (size_type i = 0; i < m_blocks.size() && !m_bad; ++i)
+        {
+            char entry[index_entry_size];
+            put_u64(entry, m_blocks[i].raw_offset);
+            put_u64(entry + 8, m_blocks[i].offset);
+            put_u32(entry + 16, m_blocks[i].raw_size);
+            put_u32(entry + 20, m_blocks[i].size);
+            m_bad = fwrite(entry, 1, sizeof(entry), m_file) != sizeof(entry);
+            m_offset += sizeof(entry);
+        }
+
+        char trailer[trailer_size] = {};
+        put_u64(trailer, index_offset);
+        put_u64(trailer + 8, m_raw_size);
+        put_u32(trailer + 16, (uint32_t)m_blocks.size());
+        for (size_type i = 0; i < 4; ++i)
+        {
+            trailer[20 + i] = trailer_magic[i];
+        }
+
+        if (!m_bad)
+        {
+            m_bad = fwrite(trailer, 1, sizeof(trailer), m_file) != sizeof(trailer);
+            m_offset += sizeof(trailer);
+        }
+
+        m_bad = (fclose(m_file) != 0) || m_bad;
+        m_file = nullptr;
+        return !m_bad;
+    }
+
+    /// @brief Encode and write buffered input as one block.
+    bool GpsArchiveWriter::flush_block(size_type start, size_type size)
+    {
+        GpsArchiveBlock block;
+        block.raw_offset = m_blocks.empty() ? 0 : m_blocks.back().raw_offset + m_blocks.back().raw_size;
+        block.offset = m_offset;
+        block.raw_size = size;
+
+        m_encoded.clear();
+        m_encoder.reset();
+        m_encoder.encode(m_pending.data() + start, size, m_encoded);
+        block.size = (uint32_t)m_encoded.size();
+
+        m_bad = fwrite(m_encoded.data(), 1, m_encoded.size(), m_file) != m_encoded.size() || m_bad;
+        m_blocks.push_back(block);
+        m_offset += block.size;
+        return !m_bad;
+    }
+
+    GpsArchiveReader::GpsArchiveReader() : m_data(nullptr), m_size(0), m_block_count(0), m_raw_size(0), m_index(nullptr)
+    {
+    }
+
+    GpsArchiveReader::~GpsArchiveReader()
+    {
+        close();
+    }
+
+    /// @brief Map an archive file and check its header, trailer and index.
+    ///
+    /// @return False if the file cannot be mapped or is not a complete archive.
+    bool GpsArchiveReader::open(const char *path)
+    {
+        close();
+
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < file_header_size + trailer_size)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        void *data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+
+        m_data = (const char *)data;
+        m_size = (size_t)info.st_size;
+
+        const char *trailer = m_data + m_size - trailer_size;
+        uint64_t index_offset = get_u64(trailer);
+        m_raw_size = get_u64(trailer + 8);
+        m_block_count = get_u32(trailer + 16);
+
+        bool valid = equals4(m_data, file_magic) && get_u16(m_data + 4) == file_version &&
+                     equals4(trailer + 20, trailer_magic) && index_offset >= file_header_size &&
+                     index_offset + (uint64_t)m_block_count * index_entry_size + trailer_size == m_size;
+
+        // Blocks must tile both the input and the archive, in order.
+        m_index = m_data + index_offset;
+        uint64_t raw_offset = 0;
+        uint64_t offset = file_header_size;
+        for (size_type i = 0; valid && i < m_block_count; ++i)
+        {
+            GpsArchiveBlock entry;
+            block(i, entry);
+            valid = entry.raw_offset == raw_offset && entry.offset == offset;
+            raw_offset += entry.raw_size;
+            offset += entry.size;
+        }
+
+        if (!valid || raw_offset != m_raw_size || offset != index_offset)
+        {
+            close();
+            return false;
+        }
+
+        return true;
+    }
+
+    /// @brief Unmap the file.
+    void GpsArchiveReader::close()
+    {
+        if (m_data)
+        {
+            munmap((void *)m_data, m_size);
+        }
+
+        m_data = nullptr;
+        m_size = 0;
+        m_block_count = 0;
+        m_raw_size = 0;
+        m_index = nullptr;
+    }
+
+    /// @brief Read the index entry of a block.
+    ///
+    /// @return False if the block does not exist.
+    bool GpsArchiveReader::block(size_type index, GpsArchiveBlock &block) const
+    {
+        if (index >= m_block_count)
+        {
+            return false;
+        }
+
+        const char *entry = m_index + (size_t)index * index_entry_size;
+        block.raw_offset = get_u64(entry);
+        block.offset = get_u64(entry + 8);
+        block.raw_size = get_u32(entry + 16);
+        block.size = get_u32(entry + 20);
+        return true;
+    }
+
+    /// @brief Find the block holding an input offset by binary search of the index.
+    ///
+    /// @return Block number, or block_count() if the offset is past the end of the input.
+    size_type GpsArchiveReader::find_block(uint64_t raw_offset) const
+    {
+        if (raw_offset >= m_raw_size)
+        {
+            return m_block_count;
+        }
+
+        // Last block that starts at or before the offset.
+        size_type low = 0;
+        size_type high = m_block_count;
+        while (low < high)
+        {
+            size_type mid = low + (high - low) / 2;
+            if (get_u64(m_index + (size_t)mid * index_entry_size) <= raw_offset)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+
+        return low - 1;
+    }
+
+    /// @brief Decode a whole block.
+    ///
+    /// @param index Block number.
+    /// @param out Original text of the block is appended here.
+    /// @return False if the block does not exist or does not decode to its original size.
+    bool GpsArchiveReader::read_block(size_type index, std::string &out) const
+    {
+        GpsArchiveBlock entry;
+        if (!block(index, entry))
+        {
+            return false;
+        }
+
+        size_t start = out.size();
+        GpsArchiveDecoder decoder;
+        if (!decoder.decode(m_data + entry.offset, entry.size, out) || out.size() - start != entry.raw_size)
+        {
+            out.resize(start);
+            return false;
+        }
+
+        return true;
+    }
+
+    /// @brief Read a range of the original input. Only the blocks that overlap the range are decoded.
+    ///
+    /// @param raw_offset Offset of the first byte in the original input.
+    /// @param size Number of bytes to read.
+    /// @param out Original bytes are appended here.
+    /// @return False if the range is past the end of the input or a block is corrupt.
+    bool GpsArchiveReader::read(uint64_t raw_offset, size_type size, std::string &out) const
+    {
+        if (raw_offset > m_raw_size || size > m_raw_size - raw_offset)
+        {
+            return false;
+        }
+
+        std::string text;
+        uint64_t end = raw_offset + size;
+        for (size_type index = find_block(raw_offset); index < m_block_count && raw_offset < end; ++index)
+        {
+            GpsArchiveBlock entry;
+            block(index, entry);
+
+            text.clear();
+            if (!read_block(index, text))
+            {
+                return false;
+            }
+
+            size_t first = (size_t)(raw_offset - entry.raw_offset);
+            size_t count = entry.raw_size - first;
+            if (end - raw_offset < count)
+            {
+                count = (size_t)(end - raw_offset);
+            }
+            out.append(text, first, count);
+            raw_offset += count;
+        }
+
+        return true;
+    }
+
+} // namespace gps
+} // namespace scottz0r
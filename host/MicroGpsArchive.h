@@ -0,0 +1,193 @@
+/// @file Lossless NMEA archive definitions.
+///
+/// This module defines a compressed archive for raw NMEA logs that restores the original bytes exactly. Host only
+/// (POSIX).
+///
+/// Each sentence with a good upper case checksum is stored as a token for its type (such as "GPGGA") and one code per
+/// field. A numeric field keeps its format (sign, digit counts and decimal point, so leading zeros survive) and value
+/// apart. The value is predicted from the same field of the previous sentence of the same type, as the last value
+/// plus the last change. The codes are:
+/// - Same: the field equals the prediction (numbers) or the previous text.
+/// - Delta: same format as before, value stored as a zigzag varint difference from the prediction.
+/// - Format: a new number format and its value.
+/// - Literal: the text of the field.
+/// The checksum is recomputed on decode instead of stored. Every other line is stored verbatim.
+///
+/// Layout, all integers little endian:
+/// - File header (16 bytes): magic "MGNA", version and block size.
+/// - Blocks, each the encoding of up to block size bytes of input, cut after a line end when possible. The codec
+///   state is reset per block, so each block decodes on its own.
+/// - Index: the input offset, file offset, input size and encoded size of every block.
+/// - Trailer (24 bytes): index offset, input size, block count and magic "MGNI".
+#ifndef _SCOTTZ0R_GPS_ARCHIVE_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_ARCHIVE_INCLUDE_GUARD
+
+#include "../MicroGpsTypes.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Default number of input bytes per block. Reading any byte decodes at most this much.
+    constexpr size_type archive_block_size = 65536;
+
+    /// Largest number of sentence types per block. Sentences of further types are stored verbatim.
+    constexpr size_type archive_max_types = 30;
+
+    /// Largest number of fields in a tokenized sentence, not counting the type.
+    constexpr size_type archive_max_fields = 64;
+
+    /// @brief Location of a block in the input and in the archive.
+    struct GpsArchiveBlock
+    {
+        uint64_t raw_offset; ///< Offset of the first input byte of the block.
+        uint64_t offset;     ///< Offset of the encoded block in the archive file.
+        uint32_t raw_size;   ///< Number of input bytes in the block.
+        uint32_t size;       ///< Number of encoded bytes.
+    };
+
+    namespace _detail
+    {
+        /// @brief Prediction state of one field.
+        struct ArchiveField
+        {
+            bool numeric;
+            uint16_t format;
+            uint64_t value;
+            uint64_t delta;
+            std::string text;
+        };
+
+        /// @brief Prediction state of one sentence type.
+        struct ArchiveType
+        {
+            std::string name;
+            std::vector<ArchiveField> fields;
+            std::vector<unsigned char> codes;
+        };
+    } // namespace _detail
+
+    /// @brief Encodes NMEA text. Sentences are encoded against earlier sentences, so a decoder must see everything
+    /// encoded since the last reset().
+    class GpsArchiveEncoder
+    {
+    public:
+        void encode(const char *data, size_type size, std::vector<char> &out);
+
+        void reset();
+
+    private:
+        void encode_line(const char *line, size_type size, std::vector<char> &out);
+
+        bool encode_sentence(const char *line, size_type size, std::vector<char> &out);
+
+        std::vector<_detail::ArchiveType> m_types;
+        std::vector<char> m_payload;
+    };
+
+    /// @brief Decodes text written by GpsArchiveEncoder.
+    class GpsArchiveDecoder
+    {
+    public:
+        bool decode(const char *src, size_type size, std::string &out);
+
+        void reset();
+
+    private:
+        std::vector<_detail::ArchiveType> m_types;
+    };
+
+    /// @brief Writes an archive file. Input is buffered until a block is full, so it can be written in any pieces.
+    class GpsArchiveWriter
+    {
+    public:
+        explicit GpsArchiveWriter(size_type block_size = archive_block_size);
+
+        ~GpsArchiveWriter();
+
+        GpsArchiveWriter(const GpsArchiveWriter &) = delete;
+        GpsArchiveWriter &operator=(const GpsArchiveWriter &) = delete;
+
+        bool open(const char *path);
+
+        bool write(const char *data, size_type size);
+
+        bool close();
+
+        /// @brief Get the number of input bytes written so far.
+        inline uint64_t raw_size() const
+        {
+            return m_raw_size;
+        }
+
+        /// @brief Get the number of archive bytes written so far.
+        inline uint64_t size() const
+        {
+            return m_offset;
+        }
+
+    private:
+        bool flush_block(size_type start, size_type size);
+
+        FILE *m_file;
+        GpsArchiveEncoder m_encoder;
+        std::string m_pending;
+        std::vector<char> m_encoded;
+        std::vector<GpsArchiveBlock> m_blocks;
+        size_type m_block_size;
+        uint64_t m_raw_size;
+        uint64_t m_offset;
+        bool m_bad;
+    };
+
+    /// @brief Reads an archive file through a read only memory map. Only the blocks a read needs are decoded.
+    class GpsArchiveReader
+    {
+    public:
+        GpsArchiveReader();
+
+        ~GpsArchiveReader();
+
+        GpsArchiveReader(const GpsArchiveReader &) = delete;
+        GpsArchiveReader &operator=(const GpsArchiveReader &) = delete;
+
+        bool open(const char *path);
+
+        void close();
+
+        /// @brief Get the number of blocks in the archive.
+        inline size_type block_count() const
+        {
+            return m_block_count;
+        }
+
+        /// @brief Get the number of bytes of the original input.
+        inline uint64_t raw_size() const
+        {
+            return m_raw_size;
+        }
+
+        bool block(size_type index, GpsArchiveBlock &block) const;
+
+        size_type find_block(uint64_t raw_offset) const;
+
+        bool read_block(size_type index, std::string &out) const;
+
+        bool read(uint64_t raw_offset, size_type size, std::string &out) const;
+
+    private:
+        const char *m_data;
+        size_t m_size;
+        size_type m_block_count;
+        uint64_t m_raw_size;
+        const char *m_index;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_ARCHIVE_INCLUDE_GUARD
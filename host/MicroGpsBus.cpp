@@ -0,0 +1,278 @@
+/// @file Shared memory fix bus implementation.
+#include "MicroGpsBus.h"
+#include "MicroGpsBytes.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    using namespace scottz0r::gps::_detail;
+
+    static constexpr uint16_t bus_version = 1;
+    static const char bus_magic[4] = {'M', 'G', 'F', 'B'};
+
+    static_assert(sizeof(GpsBusHeader) == 64, "Bus header must be one cache line");
+    static_assert(sizeof(GpsBusSlot) == 64, "Bus slot must be one cache line");
+
+    /// @brief Size of a bus mapping with the given number of slots.
+    static inline size_t bus_size(size_type capacity)
+    {
+        return sizeof(GpsBusHeader) + (size_t)capacity * sizeof(GpsBusSlot);
+    }
+
+    /// @brief Initialize a closed writer.
+    GpsFixBusWriter::GpsFixBusWriter() : m_header(nullptr), m_slots(nullptr), m_size(0), m_published(0), m_name{}
+    {
+    }
+
+    /// @brief Close the bus.
+    GpsFixBusWriter::~GpsFixBusWriter()
+    {
+        close();
+    }
+
+    /// @brief Create a bus. A bus of the same name is replaced; its readers keep their mapping but see no new
+    /// records.
+    ///
+    /// @param name Shared memory object name, such as "/gps-fixes".
+    /// @param capacity Number of slots, a power of two. A reader can fall this many records behind before it loses
+    /// any.
+    /// @return False if the capacity is invalid or the object cannot be created and mapped.
+    bool GpsFixBusWriter::open(const char *name, size_type capacity)
+    {
+        close();
+
+        if (capacity < 2 || (capacity & (capacity - 1)) || strlen(name) >= sizeof(m_name))
+        {
+            return false;
+        }
+
+        shm_unlink(name);
+        int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        size_t size = bus_size(capacity);
+        if (ftruncate(fd, (off_t)size) != 0)
+        {
+            ::close(fd);
+            shm_unlink(name);
+            return false;
+        }
+
+        void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            shm_unlink(name);
+            return false;
+        }
+
+        // The object starts zeroed, so every slot reads as empty. The magic goes last: readers reject the bus until
+        // the header is complete.
+        m_header = (GpsBusHeader *)data;
+        m_slots = (GpsBusSlot *)(m_header + 1);
+        m_size = size;
+        m_published = 0;
+        strcpy(m_name, name);
+
+        m_header->version = bus_version;
+        m_header->record_size = (uint16_t)sizeof(GpsPosition);
+        m_header->capacity = capacity;
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(m_header->magic, bus_magic, sizeof(bus_magic));
+        return true;
+    }
+
+    /// @brief Unmap the bus and remove its name. Readers that have it open keep their mapping.
+    void GpsFixBusWriter::close()
+    {
+        if (m_header)
+        {
+            munmap(m_header, m_size);
+            shm_unlink(m_name);
+        }
+
+        m_header = nullptr;
+        m_slots = nullptr;
+        m_size = 0;
+        m_name[0] = '\0';
+    }
+
+    /// @brief Publish a fix. Never waits: the oldest record is overwritten whether or not every reader has seen it.
+    ///
+    /// @param position Fix to publish.
+    /// @param source Value passed to readers with the fix.
+    /// @return Sequence number of the record, or 0 if the bus is not open.
+    uint64_t GpsFixBusWriter::publish(const GpsPosition &position, uint32_t source)
+    {
+        if (!m_header)
+        {
+            return 0;
+        }
+
+        uint64_t sequence = ++m_published;
+        GpsBusSlot &slot = m_slots[sequence & (m_header->capacity - 1)];
+
+        __atomic_store_n(&slot.sequence, 2 * sequence - 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        slot.source = source;
+        slot.position = position;
+        __atomic_store_n(&slot.sequence, 2 * sequence, __ATOMIC_RELEASE);
+
+        __atomic_store_n(&m_header->published, sequence, __ATOMIC_RELEASE);
+        return sequence;
+    }
+
+    /// @brief Initialize a closed reader.
+    GpsFixBusReader::GpsFixBusReader()
+        : m_header(nullptr), m_slots(nullptr), m_size(0), m_mask(0), m_next(1), m_lost(0)
+    {
+    }
+
+    /// @brief Close the bus.
+    GpsFixBusReader::~GpsFixBusReader()
+    {
+        close();
+    }
+
+    /// @brief Map a bus read only. Reading starts with the next record published.
+    ///
+    /// @return False if the bus does not exist, is not complete or was written with a different GpsPosition layout.
+    bool GpsFixBusReader::open(const char *name)
+    {
+        close();
+
+        int fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(GpsBusHeader))
+        {
+            ::close(fd);
+            return false;
+        }
+
+        void *data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+
+        m_header = (const GpsBusHeader *)data;
+        m_slots = (const GpsBusSlot *)(m_header + 1);
+        m_size = (size_t)info.st_size;
+
+        bool valid = equals4(m_header->magic, bus_magic);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        size_type capacity = m_header->capacity;
+        valid = valid && m_header->version == bus_version && m_header->record_size == sizeof(GpsPosition) &&
+                capacity >= 2 && !(capacity & (capacity - 1)) && bus_size(capacity) == m_size;
+        if (!valid)
+        {
+            close();
+            return false;
+        }
+
+        m_mask = capacity - 1;
+        m_next = published() + 1;
+        m_lost = 0;
+        return true;
+    }
+
+    /// @brief Unmap the bus.
+    void GpsFixBusReader::close()
+    {
+        if (m_header)
+        {
+            munmap((void *)m_header, m_size);
+        }
+
+        m_header = nullptr;
+        m_slots = nullptr;
+        m_size = 0;
+    }
+
+    /// @brief Read the next record. Never waits.
+    ///
+    /// If the writer has lapped this reader, the overwritten records are added to lost() and reading continues with
+    /// the oldest record still in the ring.
+    ///
+    /// @param record Record read. Unchanged if false is returned.
+    /// @return False if no new record is published yet or the bus is not open.
+    bool GpsFixBusReader::read(GpsBusRecord &record)
+    {
+        if (!m_header)
+        {
+            return false;
+        }
+
+        for (;;)
+        {
+            const GpsBusSlot &slot = m_slots[m_next & m_mask];
+            uint64_t expected = 2 * m_next;
+
+            // Older sequences are a previous lap or record m_next being written: nothing new yet.
+            uint64_t before = __atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE);
+            if (before < expected)
+            {
+                return false;
+            }
+
+            if (before == expected)
+            {
+                uint32_t source = slot.source;
+                GpsPosition position = slot.position;
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(&slot.sequence, __ATOMIC_RELAXED) == expected)
+                {
+                    record.sequence = m_next++;
+                    record.source = source;
+                    record.position = position;
+                    return true;
+                }
+            }
+
+            // Lapped while waiting or while copying.
+            uint64_t next = oldest();
+            next = next > m_next ? next : m_next + 1;
+            m_lost += next - m_next;
+            m_next = next;
+        }
+    }
+
+    /// @brief Go back to the oldest record still in the ring, to replay recent history after open().
+    void GpsFixBusReader::rewind()
+    {
+        m_next = oldest();
+    }
+
+    /// @brief Get the number of records published so far.
+    uint64_t GpsFixBusReader::published() const
+    {
+        return m_header ? __atomic_load_n(&m_header->published, __ATOMIC_ACQUIRE) : 0;
+    }
+
+    /// @brief Get the sequence number of the oldest record that can still be read. The slot after the newest record
+    /// may be mid write, so it is not counted as retained.
+    uint64_t GpsFixBusReader::oldest() const
+    {
+        uint64_t newest = published();
+        uint64_t capacity = m_mask + 1;
+        return newest + 2 > capacity ? newest + 2 - capacity : 1;
+    }
+
+} // namespace gps
+} // namespace scottz0r
@@ -0,0 +1,133 @@
+/// @file Shared memory fix bus definitions.
+///
+/// This module publishes fixes to other local processes through a POSIX shared memory ring. Host only (POSIX): the
+/// host directory is not built by the Arduino IDE.
+///
+/// One writer process maps the ring read/write and every reader maps the same pages read only, so a fix is parsed
+/// and copied once no matter how many consumers there are. The writer never waits for readers. Each slot carries the
+/// sequence number of the record in it and works as a seqlock: the writer marks the slot busy, copies the record and
+/// publishes the sequence. A reader that copies a slot and finds a different sequence before and after, or a newer
+/// record than it expected, has been lapped. It then skips to the oldest record still in the ring and counts what it
+/// lost.
+///
+/// Layout: a 64 byte header (magic "MGFB", version, record size, capacity and the number of published records)
+/// followed by capacity slots of 64 bytes. The ring is only shared between processes built with the same GpsPosition
+/// layout; readers reject a ring with a different record size.
+#ifndef _SCOTTZ0R_GPS_BUS_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_BUS_INCLUDE_GUARD
+
+#include "../MicroGps.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Default number of slots. Must be a power of two.
+    constexpr size_type fix_bus_capacity = 4096;
+
+    /// @brief Record read from the bus.
+    struct GpsBusRecord
+    {
+        uint64_t sequence;    ///< Publish order, starting at 1. Gaps are records lost to an overrun.
+        uint32_t source;      ///< Source given to GpsFixBusWriter::publish(), such as a port number.
+        GpsPosition position; ///< Published fix.
+    };
+
+    namespace _detail
+    {
+        /// @brief Shared header at the start of the mapping.
+        struct alignas(64) GpsBusHeader
+        {
+            char magic[4];
+            uint16_t version;
+            uint16_t record_size;
+            uint32_t capacity;
+            uint32_t reserved;
+            uint64_t published; ///< Number of records published. Written by the writer only.
+        };
+
+        /// @brief One slot. The sequence is 2n while record n is in the slot and 2n - 1 while it is being written.
+        struct alignas(64) GpsBusSlot
+        {
+            uint64_t sequence;
+            uint32_t source;
+            uint32_t reserved;
+            GpsPosition position;
+        };
+    } // namespace _detail
+
+    /// @brief Single writer of a fix bus.
+    class GpsFixBusWriter
+    {
+    public:
+        GpsFixBusWriter();
+
+        ~GpsFixBusWriter();
+
+        GpsFixBusWriter(const GpsFixBusWriter &) = delete;
+        GpsFixBusWriter &operator=(const GpsFixBusWriter &) = delete;
+
+        bool open(const char *name, size_type capacity = fix_bus_capacity);
+
+        void close();
+
+        uint64_t publish(const GpsPosition &position, uint32_t source = 0);
+
+        /// @brief Returns true if the bus is open.
+        inline bool is_open() const
+        {
+            return m_header != nullptr;
+        }
+
+    private:
+        _detail::GpsBusHeader *m_header;
+        _detail::GpsBusSlot *m_slots;
+        size_t m_size;
+        uint64_t m_published;
+        char m_name[256];
+    };
+
+    /// @brief One reader of a fix bus. Readers are independent; each process or thread uses its own.
+    class GpsFixBusReader
+    {
+    public:
+        GpsFixBusReader();
+
+        ~GpsFixBusReader();
+
+        GpsFixBusReader(const GpsFixBusReader &) = delete;
+        GpsFixBusReader &operator=(const GpsFixBusReader &) = delete;
+
+        bool open(const char *name);
+
+        void close();
+
+        bool read(GpsBusRecord &record);
+
+        void rewind();
+
+        uint64_t published() const;
+
+        /// @brief Get the number of records skipped because the writer lapped this reader.
+        inline uint64_t lost() const
+        {
+            return m_lost;
+        }
+
+    private:
+        uint64_t oldest() const;
+
+        const _detail::GpsBusHeader *m_header;
+        const _detail::GpsBusSlot *m_slots;
+        size_t m_size;
+        uint64_t m_mask;
+        uint64_t m_next;
+        uint64_t m_lost;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_BUS_INCLUDE_GUARD
@@ -0,0 +1,56 @@
+/// @file Little endian byte helpers shared by the host file formats.
+#ifndef _SCOTTZ0R_GPS_BYTES_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_BYTES_INCLUDE_GUARD
+
+#include <stdint.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    namespace _detail
+    {
+        inline void put_u16(char *p, uint16_t value)
+        {
+            p[0] = (char)value;
+            p[1] = (char)(value >> 8);
+        }
+
+        inline void put_u32(char *p, uint32_t value)
+        {
+            put_u16(p, (uint16_t)value);
+            put_u16(p + 2, (uint16_t)(value >> 16));
+        }
+
+        inline void put_u64(char *p, uint64_t value)
+        {
+            put_u32(p, (uint32_t)value);
+            put_u32(p + 4, (uint32_t)(value >> 32));
+        }
+
+        inline uint16_t get_u16(const char *p)
+        {
+            return (uint16_t)((unsigned char)p[0] | ((unsigned char)p[1] << 8));
+        }
+
+        inline uint32_t get_u32(const char *p)
+        {
+            return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+        }
+
+        inline uint64_t get_u64(const char *p)
+        {
+            return get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+        }
+
+        /// @brief Compare two 4 character magic numbers.
+        inline bool equals4(const char *lhs, const char *rhs)
+        {
+            return lhs[0] == rhs[0] && lhs[1] == rhs[1] && lhs[2] == rhs[2] && lhs[3] == rhs[3];
+        }
+    } // namespace _detail
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_BYTES_INCLUDE_GUARD
@@ -0,0 +1,215 @@
+/// @file Fleet position table implementation.
+#include "MicroGpsFleet.h"
+#include <new>
+#include <stdlib.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// @brief Spread receiver IDs over the table, so sequential IDs do not form long probe runs.
+    static inline uint32_t hash_id(uint32_t id)
+    {
+        id ^= id >> 16;
+        id *= 0x7FEB352D;
+        id ^= id >> 15;
+        id *= 0x846CA68B;
+        id ^= id >> 16;
+        return id;
+    }
+
+    /// @brief Allocate the table. Entries are never allocated after this.
+    ///
+    /// @param max_receivers Largest number of receivers. The table has at least twice as many entries, so probe runs
+    /// stay short when it is full.
+    GpsFleetTable::GpsFleetTable(size_type max_receivers)
+        : m_entries(nullptr), m_mask(0), m_max_receivers(0), m_size(0)
+    {
+        size_type entries = 2;
+        while (entries < 2 * (uint64_t)max_receivers && entries < 0x40000000)
+        {
+            entries *= 2;
+        }
+
+        void *data = nullptr;
+        if (max_receivers == 0 || posix_memalign(&data, alignof(Entry), entries * sizeof(Entry)) != 0)
+        {
+            return;
+        }
+
+        m_entries = (Entry *)data;
+        for (size_type i = 0; i < entries; ++i)
+        {
+            Entry *entry = new (&m_entries[i]) Entry;
+            entry->id.store(fleet_empty_id, std::memory_order_relaxed);
+            entry->sequence.store(0, std::memory_order_relaxed);
+            entry->positions[0] = {};
+            entry->positions[1] = {};
+        }
+
+        m_mask = entries - 1;
+        m_max_receivers = max_receivers < entries / 2 ? max_receivers : entries / 2;
+    }
+
+    /// @brief Free the table.
+    GpsFleetTable::~GpsFleetTable()
+    {
+        free(m_entries);
+    }
+
+    /// @brief Set the position of a receiver, adding it if it is new. Updates of one receiver from several threads
+    /// are applied one at a time.
+    ///
+    /// @return False if the receiver is new and the table is full, or the ID is fleet_empty_id.
+    bool GpsFleetTable::update(uint32_t id, const GpsPosition &position)
+    {
+        Entry *entry = find_entry(id, true);
+        if (!entry)
+        {
+            return false;
+        }
+
+        // Take the entry by making the sequence odd. Only writers of the same receiver wait here.
+        uint64_t sequence = entry->sequence.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            if ((sequence & 1) == 0 &&
+                entry->sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire,
+                                                      std::memory_order_relaxed))
+            {
+                break;
+            }
+            sequence = entry->sequence.load(std::memory_order_relaxed);
+        }
+
+        // Order the odd sequence before the position stores, so a reader that sees a stored byte also sees the writer.
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // Readers that saw the previous sequence copy the other position, so this copy does not tear theirs.
+        entry->positions[(sequence / 2 + 1) & 1] = position;
+        entry->sequence.store(sequence + 2, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Get the last position of a receiver. Never waits for a writer to finish.
+    ///
+    /// @param position Last position. Unchanged if false is returned.
+    /// @return False if the receiver has no position yet.
+    bool GpsFleetTable::find(uint32_t id, GpsPosition &position) const
+    {
+        const Entry *entry = find_entry(id);
+        return entry && read_entry(*entry, position) != 0;
+    }
+
+    /// @brief Copy the position of every receiver, for example to render a map. Each position is consistent, but
+    /// receivers are copied one after the other while updates continue.
+    ///
+    /// @param positions Replaced with the positions, in table order. Reusing the vector avoids allocations.
+    /// @return Number of positions copied.
+    size_type GpsFleetTable::snapshot(std::vector<GpsFleetPosition> &positions) const
+    {
+        positions.clear();
+        for (size_type i = 0; m_entries && i <= m_mask; ++i)
+        {
+            const Entry &entry = m_entries[i];
+            uint32_t id = entry.id.load(std::memory_order_acquire);
+            if (id == fleet_empty_id)
+            {
+                continue;
+            }
+
+            GpsFleetPosition item;
+            item.id = id;
+            item.updates = read_entry(entry, item.position) / 2;
+            if (item.updates > 0)
+            {
+                positions.push_back(item);
+            }
+        }
+        return (size_type)positions.size();
+    }
+
+    /// @brief Find the entry of a receiver by linear probing.
+    ///
+    /// @param insert Claim an empty entry for a new receiver.
+    /// @return The entry, or nullptr if it is not found and cannot be added.
+    GpsFleetTable::Entry *GpsFleetTable::find_entry(uint32_t id, bool insert)
+    {
+        if (!m_entries || id == fleet_empty_id)
+        {
+            return nullptr;
+        }
+
+        for (size_type i = hash_id(id) & m_mask, probes = 0; probes <= m_mask; i = (i + 1) & m_mask, ++probes)
+        {
+            Entry &entry = m_entries[i];
+            uint32_t current = entry.id.load(std::memory_order_acquire);
+            if (current == id)
+            {
+                return &entry;
+            }
+            if (current != fleet_empty_id)
+            {
+                continue;
+            }
+            if (!insert)
+            {
+                return nullptr;
+            }
+
+            // Reserve room before claiming, so the table never holds more than max_receivers.
+            if (m_size.fetch_add(1, std::memory_order_relaxed) >= m_max_receivers)
+            {
+                m_size.fetch_sub(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            if (entry.id.compare_exchange_strong(current, id, std::memory_order_acq_rel))
+            {
+                return &entry;
+            }
+
+            // Another writer claimed the entry first, possibly for the same receiver.
+            m_size.fetch_sub(1, std::memory_order_relaxed);
+            if (current == id)
+            {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief Find the entry of a receiver without adding it.
+    const GpsFleetTable::Entry *GpsFleetTable::find_entry(uint32_t id) const
+    {
+        return const_cast<GpsFleetTable *>(this)->find_entry(id, false);
+    }
+
+    /// @brief Copy the last complete position of an entry.
+    ///
+    /// @return Sequence of the copied update (twice the update count), or 0 if the entry has no position yet.
+    uint64_t GpsFleetTable::read_entry(const Entry &entry, GpsPosition &position)
+    {
+        for (;;)
+        {
+            uint64_t before = entry.sequence.load(std::memory_order_acquire);
+            uint64_t complete = before & ~(uint64_t)1;
+            if (complete == 0)
+            {
+                return 0;
+            }
+
+            // Update n = complete / 2 is in positions[n % 2]. Only update n + 2, which starts by moving the sequence
+            // past complete + 2, writes there again.
+            GpsPosition copy = entry.positions[(complete / 2) & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.sequence.load(std::memory_order_relaxed) <= complete + 2)
+            {
+                position = copy;
+                return complete;
+            }
+        }
+    }
+
+} // namespace gps
+} // namespace scottz0r
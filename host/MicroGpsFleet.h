@@ -0,0 +1,89 @@
+/// @file Fleet position table definitions.
+///
+/// This module keeps the last known position of every receiver of a fleet, for lookups from many threads while the
+/// receivers keep updating. Host only: the host directory is not built by the Arduino IDE.
+///
+/// The table is an open addressing hash table from receiver ID to position, allocated once with a fixed capacity.
+/// Entries are cache line aligned, so updates to different receivers never contend. Each entry is a seqlock over two
+/// copies of the position: a writer makes the sequence odd, fills the copy readers are not directed to and makes the
+/// sequence even again. Readers take nothing and never block a writer or wait for one to finish, so the table is
+/// lock-free. Reads are not wait-free: a read is retried if the same receiver was updated twice while it copied 32
+/// bytes, so a receiver updated without pause can keep a reader retrying. Receivers cannot be removed.
+#ifndef _SCOTTZ0R_GPS_FLEET_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_FLEET_INCLUDE_GUARD
+
+#include "../MicroGps.h"
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Receiver ID that marks an empty entry. It cannot be used as a receiver ID.
+    constexpr uint32_t fleet_empty_id = 0xFFFFFFFF;
+
+    /// @brief Position of one receiver, as copied by GpsFleetTable::snapshot().
+    struct GpsFleetPosition
+    {
+        uint32_t id;          ///< Receiver ID.
+        uint64_t updates;     ///< Number of updates of the receiver so far.
+        GpsPosition position; ///< Last position.
+    };
+
+    /// @brief Last known position of each receiver. All members may be called from any thread.
+    class GpsFleetTable
+    {
+    public:
+        explicit GpsFleetTable(size_type max_receivers);
+
+        ~GpsFleetTable();
+
+        GpsFleetTable(const GpsFleetTable &) = delete;
+        GpsFleetTable &operator=(const GpsFleetTable &) = delete;
+
+        bool update(uint32_t id, const GpsPosition &position);
+
+        bool find(uint32_t id, GpsPosition &position) const;
+
+        size_type snapshot(std::vector<GpsFleetPosition> &positions) const;
+
+        /// @brief Get the number of receivers in the table.
+        inline size_type size() const
+        {
+            return m_size.load(std::memory_order_relaxed);
+        }
+
+        /// @brief Get the number of receivers the table can hold.
+        inline size_type max_receivers() const
+        {
+            return m_max_receivers;
+        }
+
+    private:
+        /// @brief One receiver. The sequence is twice the number of updates, plus one while an update is in progress.
+        /// Update n is written to positions[n % 2].
+        struct alignas(64) Entry
+        {
+            std::atomic<uint32_t> id;
+            std::atomic<uint64_t> sequence;
+            GpsPosition positions[2];
+        };
+
+        Entry *find_entry(uint32_t id, bool insert);
+
+        const Entry *find_entry(uint32_t id) const;
+
+        static uint64_t read_entry(const Entry &entry, GpsPosition &position);
+
+        Entry *m_entries;
+        size_type m_mask;
+        size_type m_max_receivers;
+        std::atomic<size_type> m_size;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_FLEET_INCLUDE_GUARD
@@ -0,0 +1,116 @@
+/// @file Synthetic NMEA traffic implementation.
+#include "MicroGpsGenerator.h"
+#include "../MicroGpsFormat.h"
+#include <math.h>
+#include <stdio.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    static constexpr uint32_t day_ms = 86400000;
+    static constexpr double pi = 3.14159265358979323846;
+    static constexpr double meters_per_degree = 111319.49;
+    static constexpr double knots_per_meter_per_second = 1.9438445;
+
+    /// @brief Format an angle as NMEA degrees and minutes ("dddmm.mmmm") and its hemisphere.
+    static void format_ddmm(double degrees, unsigned degree_digits, char positive, char negative, char *dst,
+                            size_type dst_size, char &hemisphere)
+    {
+        hemisphere = degrees < 0 ? negative : positive;
+        double value = fabs(degrees);
+        unsigned whole = (unsigned)value;
+        double minutes = (value - whole) * 60.0;
+        if (minutes >= 59.99995)
+        {
+            ++whole;
+            minutes = 0;
+        }
+        snprintf(dst, dst_size, "%0*u%07.4f", (int)degree_digits, whole, minutes);
+    }
+
+    /// @brief Initialize the generator.
+    ///
+    /// @param seed Seed of the random walk. Equal seeds give equal traffic.
+    /// @param latitude Starting latitude in degrees.
+    /// @param longitude Starting longitude in degrees.
+    /// @param interval_ms Time between epochs.
+    GpsTrafficGenerator::GpsTrafficGenerator(uint32_t seed, double latitude, double longitude, uint32_t interval_ms)
+        : m_state(seed ? seed : 1), m_time_ms(12 * 3600000), m_interval_ms(interval_ms), m_epochs(0),
+          m_latitude(latitude), m_longitude(longitude), m_heading(0), m_speed(15), m_altitude(243.9)
+    {
+        m_heading = random() % 360;
+    }
+
+    /// @brief Write the sentences of the next epoch, "$GPGGA...\r\n$GPRMC...\r\n", and advance the receiver.
+    ///
+    /// @param dst Destination buffer. generator_epoch_max_size characters always fit.
+    /// @param dst_size Size of dst.
+    /// @return Number of characters written, or 0 if dst is too small. Nothing advances if 0 is returned.
+    size_type GpsTrafficGenerator::next_epoch(char *dst, size_type dst_size)
+    {
+        uint32_t seconds = m_time_ms / 1000;
+        char time[16];
+        snprintf(time, sizeof(time), "%02u%02u%02u.%02u", seconds / 3600, seconds / 60 % 60, seconds % 60,
+                 m_time_ms % 1000 / 10);
+
+        char latitude[16];
+        char longitude[16];
+        char north;
+        char east;
+        format_ddmm(m_latitude, 2, 'N', 'S', latitude, sizeof(latitude), north);
+        format_ddmm(m_longitude, 3, 'E', 'W', longitude, sizeof(longitude), east);
+
+        char body[128];
+        char epoch[generator_epoch_max_size];
+        snprintf(body, sizeof(body), "GPGGA,%s,%s,%c,%s,%c,1,%02u,0.9,%.1f,M,-30.1,M,,", time, latitude, north,
+                 longitude, east, 8 + m_state % 4, m_altitude);
+        size_type size = format_nmea_sentence(body, epoch, sizeof(epoch));
+
+        snprintf(body, sizeof(body), "GPRMC,%s,A,%s,%c,%s,%c,%.1f,%.1f,191124,,,A", time, latitude, north, longitude,
+                 east, m_speed * knots_per_meter_per_second, m_heading);
+        size += format_nmea_sentence(body, epoch + size, sizeof(epoch) - size);
+
+        if (size > dst_size)
+        {
+            return 0;
+        }
+        for (size_type i = 0; i < size; ++i)
+        {
+            dst[i] = epoch[i];
+        }
+
+        // Drive on, turning and changing speed a little each epoch.
+        double seconds_per_epoch = m_interval_ms / 1000.0;
+        double distance = m_speed * seconds_per_epoch;
+        m_latitude += distance * cos(m_heading * pi / 180) / meters_per_degree;
+        m_longitude += distance * sin(m_heading * pi / 180) / (meters_per_degree * cos(m_latitude * pi / 180));
+        m_heading = fmod(m_heading + ((int)(random() % 11) - 5) + 360.0, 360.0);
+        m_speed = fmax(0.0, fmin(40.0, m_speed + ((int)(random() % 5) - 2) * 0.5));
+        m_altitude += ((int)(random() % 5) - 2) * 0.1;
+        m_time_ms = (m_time_ms + m_interval_ms) % day_ms;
+        ++m_epochs;
+        return size;
+    }
+
+    /// @brief Append the sentences of several epochs to a string.
+    void GpsTrafficGenerator::generate(size_type epochs, std::string &out)
+    {
+        char epoch[generator_epoch_max_size];
+        for (size_type i = 0; i < epochs; ++i)
+        {
+            out.append(epoch, next_epoch(epoch, sizeof(epoch)));
+        }
+    }
+
+    /// @brief Next value of a xorshift32 generator.
+    uint32_t GpsTrafficGenerator::random()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+} // namespace gps
+} // namespace scottz0r
@@ -0,0 +1,59 @@
+/// @file Synthetic NMEA traffic definitions.
+///
+/// This module generates repeatable NMEA traffic of a moving receiver, for tests and benchmarks of the host modules.
+/// Host only.
+#ifndef _SCOTTZ0R_GPS_GENERATOR_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_GENERATOR_INCLUDE_GUARD
+
+#include "../MicroGpsTypes.h"
+#include <stdint.h>
+#include <string>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Largest number of characters written for one epoch.
+    constexpr size_type generator_epoch_max_size = 256;
+
+    /// @brief Generates a GGA and an RMC sentence per epoch for a receiver driving a random walk.
+    class GpsTrafficGenerator
+    {
+    public:
+        explicit GpsTrafficGenerator(uint32_t seed = 1, double latitude = 38.9145533, double longitude = -94.7561333,
+                                     uint32_t interval_ms = 1000);
+
+        size_type next_epoch(char *dst, size_type dst_size);
+
+        void generate(size_type epochs, std::string &out);
+
+        /// @brief Get the UTC time of day of the next epoch, in milliseconds since midnight.
+        inline uint32_t time_ms() const
+        {
+            return m_time_ms;
+        }
+
+        /// @brief Get the number of epochs generated so far.
+        inline uint32_t epochs() const
+        {
+            return m_epochs;
+        }
+
+    private:
+        uint32_t random();
+
+        uint32_t m_state;
+        uint32_t m_time_ms;
+        uint32_t m_interval_ms;
+        uint32_t m_epochs;
+        double m_latitude;
+        double m_longitude;
+        double m_heading;
+        double m_speed;
+        double m_altitude;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_GENERATOR_INCLUDE_GUARD
@@ -0,0 +1,205 @@
+/// @file Time ordered merge implementation.
+#include "MicroGpsMerge.h"
+#include <algorithm>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Milliseconds per day, and the largest jump that is still taken as the same day.
+    static constexpr uint32_t day_ms = 86400000;
+    static constexpr uint32_t half_day_ms = day_ms / 2;
+
+    /// @brief Orders a reorder buffer as a min heap on time.
+    static bool later(const GpsMergeItem &lhs, const GpsMergeItem &rhs)
+    {
+        return lhs.time_ms > rhs.time_ms;
+    }
+
+    /// @brief Initialize the merge.
+    ///
+    /// @param reorder_window Number of fixes held back per source. A fix may arrive after at most this many later
+    /// fixes of the same source; 1 disables reordering.
+    GpsMerge::GpsMerge(size_type reorder_window)
+        : m_last({}), m_reorder_window(reorder_window > 0 ? reorder_window : 1), m_late(0), m_started(false),
+          m_emitted(false)
+    {
+    }
+
+    /// @brief Add a source. Its receiver number is the number of sources added before it.
+    ///
+    /// @param source Pulls the next fix of the source.
+    /// @param context Context given to the source.
+    /// @param first_day Day of the first fix relative to the other sources, when they do not all start on the same
+    /// UTC day.
+    /// @return False if merging has already started.
+    bool GpsMerge::add_source(GpsMergeSource source, void *context, uint32_t first_day)
+    {
+        if (m_started || !source)
+        {
+            return false;
+        }
+
+        Source state = {};
+        state.source = source;
+        state.context = context;
+        state.day = first_day;
+        m_sources.push_back(state);
+        return true;
+    }
+
+    /// @brief Get the next fix in (time, receiver) order.
+    ///
+    /// @return False when every source is exhausted.
+    bool GpsMerge::next(GpsMergeItem &item)
+    {
+        if (!m_started)
+        {
+            m_started = true;
+            for (size_type i = 0; i < m_sources.size(); ++i)
+            {
+                fill(i);
+            }
+            build();
+        }
+
+        if (m_sources.empty())
+        {
+            return false;
+        }
+
+        size_type winner = m_tree[0];
+        Source &source = m_sources[winner];
+        if (source.buffer.empty())
+        {
+            return false;
+        }
+
+        std::pop_heap(source.buffer.begin(), source.buffer.end(), later);
+        item = source.buffer.back();
+        source.buffer.pop_back();
+        m_last = item;
+        m_emitted = true;
+        fill(winner);
+
+        // Replay the path from the leaf of the winner to the root.
+        size_type count = (size_type)m_sources.size();
+        for (size_type node = (winner + count) >> 1; node > 0; node >>= 1)
+        {
+            if (less(m_tree[node], winner))
+            {
+                std::swap(m_tree[node], winner);
+            }
+        }
+        m_tree[0] = winner;
+        return true;
+    }
+
+    /// @brief Pull fixes from a source until its reorder buffer is full or it is exhausted.
+    ///
+    /// @return False if the buffer is empty.
+    bool GpsMerge::fill(size_type index)
+    {
+        Source &source = m_sources[index];
+        GpsPosition position;
+        while (!source.exhausted && source.buffer.size() < m_reorder_window)
+        {
+            if (!source.source(position, source.context))
+            {
+                source.exhausted = true;
+                break;
+            }
+
+            if (!has_field(position, PositionField::Time))
+            {
+                continue;
+            }
+
+            // A large step back is midnight; a large step forward is a late fix from before midnight.
+            uint32_t time_ms = position.time_ms;
+            uint64_t day = source.day;
+            if (source.has_last && time_ms + half_day_ms < source.last_time_ms)
+            {
+                day = ++source.day;
+                source.last_time_ms = time_ms;
+            }
+            else if (source.has_last && time_ms > source.last_time_ms + half_day_ms)
+            {
+                day = day > 0 ? day - 1 : 0;
+            }
+            else if (!source.has_last || time_ms > source.last_time_ms)
+            {
+                source.last_time_ms = time_ms;
+            }
+            source.has_last = true;
+
+            GpsMergeItem item;
+            item.time_ms = day * day_ms + time_ms;
+            item.receiver = index;
+            item.position = position;
+
+            // Too late to be put back in order: a later fix has already been emitted.
+            if (m_emitted && (item.time_ms < m_last.time_ms ||
+                              (item.time_ms == m_last.time_ms && item.receiver < m_last.receiver)))
+            {
+                ++m_late;
+                continue;
+            }
+
+            source.buffer.push_back(item);
+            std::push_heap(source.buffer.begin(), source.buffer.end(), later);
+        }
+
+        return !source.buffer.empty();
+    }
+
+    /// @brief Returns true if the head of one source goes before the head of another. Empty sources go last.
+    bool GpsMerge::less(size_type lhs, size_type rhs) const
+    {
+        const std::vector<GpsMergeItem> &left = m_sources[lhs].buffer;
+        const std::vector<GpsMergeItem> &right = m_sources[rhs].buffer;
+        if (left.empty() || right.empty())
+        {
+            return !left.empty() || (right.empty() && lhs < rhs);
+        }
+
+        uint64_t left_ms = left.front().time_ms;
+        uint64_t right_ms = right.front().time_ms;
+        return left_ms < right_ms || (left_ms == right_ms && lhs < rhs);
+    }
+
+    /// @brief Build the loser tree. Leaves are nodes count to 2 * count - 1; node 0 holds the winner.
+    void GpsMerge::build()
+    {
+        m_tree.assign(m_sources.size() > 0 ? m_sources.size() : 1, 0);
+        if (!m_sources.empty())
+        {
+            m_tree[0] = build(1);
+        }
+    }
+
+    /// @brief Play the matches of a subtree, storing the loser of each.
+    ///
+    /// @return Winner of the subtree.
+    size_type GpsMerge::build(size_type node)
+    {
+        size_type count = (size_type)m_sources.size();
+        if (node >= count)
+        {
+            return node - count;
+        }
+
+        size_type left = build(2 * node);
+        size_type right = build(2 * node + 1);
+        if (less(left, right))
+        {
+            m_tree[node] = right;
+            return left;
+        }
+
+        m_tree[node] = left;
+        return right;
+    }
+
+} // namespace gps
+} // namespace scottz0r
@@ -0,0 +1,93 @@
+/// @file Time ordered merge definitions.
+///
+/// This module merges the fixes of several receivers into one stream in global time order. Host only.
+///
+/// Each source is read through a small reorder buffer, so fixes that arrive slightly out of order are put back in
+/// order, and its time of day is extended across midnight. A loser tree picks the next fix among the sources in
+/// log2(N) comparisons, ordered by time and then by receiver. Memory is bounded by the reorder window of each source;
+/// nothing is sorted as a whole.
+#ifndef _SCOTTZ0R_GPS_MERGE_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_MERGE_INCLUDE_GUARD
+
+#include "../MicroGps.h"
+#include <stdint.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Default number of fixes held back per source to undo local disorder.
+    constexpr size_type merge_reorder_window = 16;
+
+    /// @brief Fix in the merged stream.
+    struct GpsMergeItem
+    {
+        uint64_t time_ms;     ///< Milliseconds since midnight of the first day of the source.
+        size_type receiver;   ///< Source number, in order of GpsMerge::add_source().
+        GpsPosition position; ///< Fix as produced by the parser.
+    };
+
+    /// @brief Pull the next fix of a source.
+    ///
+    /// @param position Next fix. Must have a time (PositionField::Time); fixes without one are skipped.
+    /// @param context Context given to GpsMerge::add_source().
+    /// @return False at the end of the source.
+    using GpsMergeSource = bool (*)(GpsPosition &position, void *context);
+
+    /// @brief Streaming k-way merge of fixes from several receivers by (time, receiver).
+    class GpsMerge
+    {
+    public:
+        explicit GpsMerge(size_type reorder_window = merge_reorder_window);
+
+        bool add_source(GpsMergeSource source, void *context, uint32_t first_day = 0);
+
+        bool next(GpsMergeItem &item);
+
+        /// @brief Get the number of sources.
+        inline size_type source_count() const
+        {
+            return (size_type)m_sources.size();
+        }
+
+        /// @brief Get the number of fixes dropped because they arrived later than the reorder window allows.
+        inline uint64_t late_count() const
+        {
+            return m_late;
+        }
+
+    private:
+        /// @brief Read state of one source.
+        struct Source
+        {
+            GpsMergeSource source;
+            void *context;
+            bool exhausted;
+            uint32_t day;
+            uint32_t last_time_ms;
+            bool has_last;
+            std::vector<GpsMergeItem> buffer;
+        };
+
+        bool fill(size_type index);
+
+        bool less(size_type lhs, size_type rhs) const;
+
+        void build();
+
+        size_type build(size_type node);
+
+        std::vector<Source> m_sources;
+        std::vector<size_type> m_tree;
+        GpsMergeItem m_last;
+        size_type m_reorder_window;
+        uint64_t m_late;
+        bool m_started;
+        bool m_emitted;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_MERGE_INCLUDE_GUARD
@@ -0,0 +1,407 @@
+/// @file Parallel log reprocessing implementation.
+#include "MicroGpsReprocess.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <dirent.h>
+#include <fcntl.h>
+#include <mutex>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    using namespace scottz0r::gps::_detail;
+
+    namespace _detail
+    {
+        /// @brief A chunk of a file: the lines that start in [begin, end).
+        struct ReprocessTask
+        {
+            size_type file;
+            size_type chunk;
+            uint64_t begin;
+            uint64_t end;
+        };
+
+        /// @brief Task deque of one worker. The owner takes from the front and thieves take from the back, so they
+        /// only meet on the last task.
+        struct ReprocessQueue
+        {
+            std::mutex mutex;
+            std::deque<ReprocessTask> tasks;
+        };
+
+        /// @brief Parse state of one file, filled in by the workers that parse its chunks.
+        struct ReprocessFile
+        {
+            uint64_t size;
+            bool readable; ///< Set before the workers start.
+            bool failed;   ///< Set by a worker, under the completion lock.
+            size_type remaining;
+            std::vector<std::vector<GpsPosition>> fixes;
+            std::vector<GpsStats> stats;
+        };
+
+        /// @brief Parse the lines of a buffer that start in [begin, end) with a new parser. Lines are whole, so
+        /// adjacent chunks parse every sentence exactly once.
+        ///
+        /// @param data File contents.
+        /// @param size Number of bytes in data.
+        /// @param begin First byte of the chunk. A line that starts before it belongs to the previous chunk.
+        /// @param end End of the chunk. The line that crosses it is parsed to its end.
+        /// @param fixes Position of every good GGA sentence is appended here.
+        /// @param stats Sentence counters are added here.
+        /// @return Number of fixes appended.
+        size_type parse_chunk(const char *data, uint64_t size, uint64_t begin, uint64_t end,
+                              std::vector<GpsPosition> &fixes, GpsStats &stats)
+        {
+            uint64_t first = begin;
+            while (first > 0 && first < size && data[first - 1] != '\n')
+            {
+                ++first;
+            }
+
+            uint64_t last = end < size ? end : size;
+            while (last > 0 && last < size && data[last - 1] != '\n')
+            {
+                ++last;
+            }
+
+            BasicMicroGps<GpsReprocessPolicy> gps;
+            size_type count = 0;
+            for (uint64_t offset = first; offset < last;)
+            {
+                uint64_t remaining = last - offset;
+                size_type block = remaining > UINT32_MAX ? UINT32_MAX : (size_type)remaining;
+                offset += gps.process_until_complete(data + offset, block);
+                if (gps.complete() && gps.good() && gps.message_type() == MessageType::GGA)
+                {
+                    fixes.push_back(gps.position_data());
+                    ++count;
+                }
+            }
+
+            stats.sentences += gps.stats().sentences;
+            stats.checksum_errors += gps.stats().checksum_errors;
+            stats.format_errors += gps.stats().format_errors;
+            stats.unknown += gps.stats().unknown;
+            return count;
+        }
+
+        /// @brief List the regular files under a directory, recursively, sorted by path. Symbolic links to files are
+        /// listed; symbolic links to directories are not followed, so link cycles cannot recurse forever.
+        ///
+        /// @return False if the directory cannot be opened.
+        bool list_files(const std::string &directory, std::vector<std::string> &paths)
+        {
+            DIR *dir = opendir(directory.c_str());
+            if (!dir)
+            {
+                return false;
+            }
+
+            std::vector<std::string> files;
+            std::vector<std::string> directories;
+            while (struct dirent *entry = readdir(dir))
+            {
+                std::string name = entry->d_name;
+                if (name == "." || name == "..")
+                {
+                    continue;
+                }
+
+                std::string path = directory + "/" + name;
+                struct stat info;
+                if (lstat(path.c_str(), &info) != 0)
+                {
+                    continue;
+                }
+
+                if (S_ISLNK(info.st_mode) && (stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)))
+                {
+                    continue;
+                }
+
+                if (S_ISREG(info.st_mode))
+                {
+                    files.push_back(path);
+                }
+                else if (S_ISDIR(info.st_mode))
+                {
+                    directories.push_back(path);
+                }
+            }
+            closedir(dir);
+
+            // Files and directories are merged in name order, so the order does not depend on the file system.
+            std::sort(directories.begin(), directories.end());
+            files.insert(files.end(), directories.begin(), directories.end());
+            std::sort(files.begin(), files.end());
+            for (const auto &path : files)
+            {
+                if (std::binary_search(directories.begin(), directories.end(), path))
+                {
+                    list_files(path, paths);
+                }
+                else
+                {
+                    paths.push_back(path);
+                }
+            }
+
+            return true;
+        }
+    } // namespace _detail
+
+    /// Bytes mapped past the end of a chunk for the line that crosses it. Doubled until the line ends in the window.
+    static constexpr uint64_t line_slack = 4096;
+
+    /// @brief Parse one chunk of a file. Each task maps only a page aligned window around its chunk, so workers do not
+    /// map whole logs and files larger than the address space can be parsed; the pages are shared through the page
+    /// cache. The window is clamped to the current size, so a file truncated since it was listed is parsed up to its
+    /// end instead of faulting on pages past it.
+    ///
+    /// @return False if the file cannot be read.
+    static bool run_task(const std::string &path, const ReprocessTask &task, ReprocessFile &file)
+    {
+        if (file.size == 0)
+        {
+            return true;
+        }
+
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        uint64_t size = (uint64_t)info.st_size < file.size ? (uint64_t)info.st_size : file.size;
+        if (task.begin >= size)
+        {
+            close(fd);
+            return true;
+        }
+
+        // parse_chunk() reads the byte before the chunk to find the first line start.
+        uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+        uint64_t first = task.begin > 0 ? task.begin - 1 : 0;
+        uint64_t offset = first - first % page;
+
+        for (uint64_t slack = line_slack;; slack *= 2)
+        {
+            uint64_t window_end = task.end < size && size - task.end > slack ? task.end + slack : size;
+            size_t length = (size_t)(window_end - offset);
+            void *data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, (off_t)offset);
+            if (data == MAP_FAILED)
+            {
+                close(fd);
+                return false;
+            }
+
+            // The line that crosses the end of the chunk must end inside the window.
+            const char *bytes = (const char *)data;
+            if (window_end == size ||
+                memchr(bytes + (task.end - 1 - offset), '\n', (size_t)(window_end - task.end + 1)) != nullptr)
+            {
+                madvise(data, length, MADV_SEQUENTIAL);
+                parse_chunk(bytes, window_end - offset, task.begin - offset, task.end - offset,
+                            file.fixes[task.chunk], file.stats[task.chunk]);
+                munmap(data, length);
+                close(fd);
+                return true;
+            }
+            munmap(data, length);
+        }
+    }
+
+    /// @brief Initialize the reprocessor.
+    ///
+    /// @param threads Number of worker threads, or 0 for one per hardware thread.
+    /// @param chunk_size Largest number of bytes parsed by one task.
+    GpsReprocessor::GpsReprocessor(size_type threads, size_type chunk_size)
+        : m_threads(threads), m_chunk_size(chunk_size > 0 ? chunk_size : reprocess_chunk_size)
+    {
+        if (m_threads == 0)
+        {
+            m_threads = std::thread::hardware_concurrency();
+        }
+        if (m_threads == 0)
+        {
+            m_threads = 1;
+        }
+    }
+
+    /// @brief Parse every regular file under a directory. See run(const std::vector<std::string> &, ...).
+    ///
+    /// @return False if the directory cannot be opened.
+    bool GpsReprocessor::run(const char *directory, GpsFileHandler handler, void *context, GpsReprocessStats &stats)
+    {
+        std::vector<std::string> paths;
+        if (!list_files(directory, paths))
+        {
+            stats = {};
+            return false;
+        }
+
+        return run(paths, handler, context, stats);
+    }
+
+    /// @brief Parse a list of files. The handler is called for each file in list order as soon as it and every file
+    /// before it are parsed, and its results are freed after the call.
+    ///
+    /// @param paths Files to parse.
+    /// @param handler Called once per file, from this thread.
+    /// @param context Context given to the handler.
+    /// @param stats Totals of the run, including the time spent in the handler.
+    /// @return False if any file could not be read. Every other file is still parsed.
+    bool GpsReprocessor::run(const std::vector<std::string> &paths, GpsFileHandler handler, void *context,
+                             GpsReprocessStats &stats)
+    {
+        auto start = std::chrono::steady_clock::now();
+        stats = {};
+
+        std::vector<ReprocessFile> files(paths.size());
+        std::vector<ReprocessQueue> queues(m_threads);
+
+        // Spread the chunks round robin, in file order, so the first files finish first.
+        size_type next_queue = 0;
+        for (size_type i = 0; i < paths.size(); ++i)
+        {
+            ReprocessFile &file = files[i];
+            struct stat info;
+            file.readable = stat(paths[i].c_str(), &info) == 0 && S_ISREG(info.st_mode);
+            file.failed = false;
+            file.size = file.readable ? (uint64_t)info.st_size : 0;
+
+            size_type chunks = (size_type)((file.size + m_chunk_size - 1) / m_chunk_size);
+            if (chunks == 0)
+            {
+                chunks = 1;
+            }
+            file.remaining = chunks;
+            file.fixes.resize(chunks);
+            file.stats.resize(chunks);
+
+            for (size_type chunk = 0; chunk < chunks; ++chunk)
+            {
+                queues[next_queue].tasks.push_back(
+                    {i, chunk, (uint64_t)chunk * m_chunk_size, (uint64_t)(chunk + 1) * m_chunk_size});
+                next_queue = (next_queue + 1) % m_threads;
+            }
+        }
+
+        std::mutex done_mutex;
+        std::condition_variable done;
+
+        auto worker = [&](size_type id) {
+            ReprocessTask task;
+            for (;;)
+            {
+                bool found = false;
+                {
+                    std::lock_guard<std::mutex> lock(queues[id].mutex);
+                    if (!queues[id].tasks.empty())
+                    {
+                        task = queues[id].tasks.front();
+                        queues[id].tasks.pop_front();
+                        found = true;
+                    }
+                }
+
+                for (size_type k = 1; !found && k < m_threads; ++k)
+                {
+                    ReprocessQueue &victim = queues[(id + k) % m_threads];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.tasks.empty())
+                    {
+                        task = victim.tasks.back();
+                        victim.tasks.pop_back();
+                        found = true;
+                    }
+                }
+
+                // Every task is queued before the workers start, so empty queues mean the work is done.
+                if (!found)
+                {
+                    return;
+                }
+
+                ReprocessFile &file = files[task.file];
+                bool failed = file.readable && !run_task(paths[task.file], task, file);
+
+                std::lock_guard<std::mutex> lock(done_mutex);
+                file.failed = file.failed || failed;
+                if (--file.remaining == 0)
+                {
+                    done.notify_one();
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (size_type id = 0; id < m_threads; ++id)
+        {
+            threads.emplace_back(worker, id);
+        }
+
+        bool ok = true;
+        for (size_type i = 0; i < files.size(); ++i)
+        {
+            ReprocessFile &file = files[i];
+            {
+                std::unique_lock<std::mutex> lock(done_mutex);
+                done.wait(lock, [&file] { return file.remaining == 0; });
+            }
+
+            GpsFileResult result;
+            result.path = paths[i];
+            result.size = file.size;
+            result.ok = file.readable && !file.failed;
+            result.stats = {};
+            for (size_type chunk = 0; chunk < file.fixes.size(); ++chunk)
+            {
+                result.fixes.insert(result.fixes.end(), file.fixes[chunk].begin(), file.fixes[chunk].end());
+                result.stats.sentences += file.stats[chunk].sentences;
+                result.stats.checksum_errors += file.stats[chunk].checksum_errors;
+                result.stats.format_errors += file.stats[chunk].format_errors;
+                result.stats.unknown += file.stats[chunk].unknown;
+            }
+            file.fixes.clear();
+            file.fixes.shrink_to_fit();
+
+            ok = ok && result.ok;
+            ++stats.files;
+            stats.bytes += file.size;
+            stats.fixes += result.fixes.size();
+
+            if (handler)
+            {
+                handler(result, context);
+            }
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return ok;
+    }
+
+} // namespace gps
+} // namespace scottz0r
@@ -0,0 +1,101 @@
+/// @file Parallel log reprocessing definitions.
+///
+/// This module parses directories of NMEA log files on a work stealing thread pool. Host only (POSIX threads).
+///
+/// Every file is cut into chunks at line ends, and each chunk is parsed by its own MicroGps. The chunks are spread
+/// over one deque per worker. A worker takes tasks from the front of its own deque, and when that is empty it steals
+/// from the back of another deque, so a few large files do not leave the other workers idle. Results are handed to the
+/// caller one file at a time, in path order, no matter which worker finished first.
+#ifndef _SCOTTZ0R_GPS_REPROCESS_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_REPROCESS_INCLUDE_GUARD
+
+#include "../MicroGps.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Default chunk size in bytes. Files larger than this are parsed by several tasks.
+    constexpr size_type reprocess_chunk_size = 4 * 1024 * 1024;
+
+    /// @brief Parser policy for reprocessing: GGA positions, with sentence counters.
+    struct GpsReprocessPolicy : MicroGpsPolicy
+    {
+        static constexpr unsigned messages = message_bit(MessageType::GGA);
+        static constexpr bool enable_stats = true;
+    };
+
+    /// @brief Parse result of one file.
+    struct GpsFileResult
+    {
+        std::string path;               ///< Path of the file.
+        uint64_t size;                  ///< Size of the file in bytes.
+        bool ok;                        ///< False if the file could not be read.
+        GpsStats stats;                 ///< Sentence counters, summed over chunks.
+        std::vector<GpsPosition> fixes; ///< Position of every good GGA sentence, in file order.
+    };
+
+    /// @brief Called once per file, in path order, from the thread that called GpsReprocessor::run().
+    using GpsFileHandler = void (*)(const GpsFileResult &result, void *context);
+
+    /// @brief Totals of a reprocessing run.
+    struct GpsReprocessStats
+    {
+        size_type files;
+        uint64_t bytes;
+        uint64_t fixes;
+        double seconds;
+
+        inline double files_per_second() const
+        {
+            return seconds > 0 ? files / seconds : 0;
+        }
+
+        inline double megabytes_per_second() const
+        {
+            return seconds > 0 ? bytes / seconds / 1e6 : 0;
+        }
+
+        inline double fixes_per_second() const
+        {
+            return seconds > 0 ? fixes / seconds : 0;
+        }
+    };
+
+    namespace _detail
+    {
+        size_type parse_chunk(const char *data, uint64_t size, uint64_t begin, uint64_t end,
+                              std::vector<GpsPosition> &fixes, GpsStats &stats);
+
+        bool list_files(const std::string &directory, std::vector<std::string> &paths);
+    } // namespace _detail
+
+    /// @brief Parses every regular file under a directory on a work stealing thread pool.
+    class GpsReprocessor
+    {
+    public:
+        explicit GpsReprocessor(size_type threads = 0, size_type chunk_size = reprocess_chunk_size);
+
+        bool run(const char *directory, GpsFileHandler handler, void *context, GpsReprocessStats &stats);
+
+        bool run(const std::vector<std::string> &paths, GpsFileHandler handler, void *context,
+                 GpsReprocessStats &stats);
+
+        /// @brief Get the number of worker threads.
+        inline size_type threads() const
+        {
+            return m_threads;
+        }
+
+    private:
+        size_type m_threads;
+        size_type m_chunk_size;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_REPROCESS_INCLUDE_GUARD
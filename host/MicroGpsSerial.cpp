@@ -0,0 +1,323 @@
+/// @file Serial port ingest implementation.
+#include "MicroGpsSerial.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Largest number of events taken from epoll per loop iteration.
+    static constexpr int max_events = 64;
+
+    /// @brief Map a baud rate to a termios speed.
+    ///
+    /// @return False if the rate is not a standard rate.
+    static bool baud_to_speed(unsigned long baud, speed_t &speed)
+    {
+        static const struct
+        {
+            unsigned long baud;
+            speed_t speed;
+        } rates[] = {{4800, B4800},     {9600, B9600},     {19200, B19200},   {38400, B38400},
+                     {57600, B57600},   {115200, B115200}, {230400, B230400}, {460800, B460800},
+                     {921600, B921600}};
+
+        for (const auto &rate : rates)
+        {
+            if (rate.baud == baud)
+            {
+                speed = rate.speed;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Switch a terminal to raw, non-blocking mode: no echo, no line editing and no character translation.
+    ///
+    /// @param fd Open terminal.
+    /// @param baud Baud rate, or 0 to keep the current rate.
+    /// @return False if the fd is not a terminal or the rate is not a standard rate.
+    bool configure_serial_port(int fd, unsigned long baud)
+    {
+        struct termios options;
+        if (tcgetattr(fd, &options) != 0)
+        {
+            return false;
+        }
+
+        cfmakeraw(&options);
+        options.c_cflag |= CLOCAL | CREAD;
+        options.c_cc[VMIN] = 1;
+        options.c_cc[VTIME] = 0;
+
+        if (baud != 0)
+        {
+            speed_t speed;
+            if (!baud_to_speed(baud, speed) || cfsetispeed(&options, speed) != 0 || cfsetospeed(&options, speed) != 0)
+            {
+                return false;
+            }
+        }
+
+        if (tcsetattr(fd, TCSANOW, &options) != 0)
+        {
+            return false;
+        }
+
+        int flags = fcntl(fd, F_GETFL);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    /// @brief Initialize the event loop.
+    ///
+    /// @param handler Called with the fixes of each loop iteration.
+    /// @param context Context given to the handler.
+    /// @param read_size Size of each read() call.
+    GpsSerialIngest::GpsSerialIngest(GpsFixBatchHandler handler, void *context, size_type read_size)
+        : m_handler(handler), m_context(context), m_epoll(epoll_create1(EPOLL_CLOEXEC)),
+          m_buffer(read_size > 0 ? read_size : serial_read_size), m_stop(false)
+    {
+    }
+
+    GpsSerialIngest::~GpsSerialIngest()
+    {
+        for (size_type port = 0; port < m_ports.size(); ++port)
+        {
+            close_port(port);
+        }
+
+        if (m_epoll >= 0)
+        {
+            ::close(m_epoll);
+        }
+    }
+
+    /// @brief Open a serial device and add it to the loop.
+    ///
+    /// @param path Device path, such as "/dev/ttyUSB0". A regular file is replayed as a log and not configured.
+    /// @param baud Baud rate, or 0 to keep the current rate.
+    /// @return Port number, or -1 if the device cannot be opened or configured.
+    int GpsSerialIngest::add_port(const char *path, unsigned long baud)
+    {
+        int fd = ::open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return -1;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (!S_ISREG(info.st_mode) && !configure_serial_port(fd, baud)))
+        {
+            ::close(fd);
+            return -1;
+        }
+
+        int port = add_fd(fd);
+        if (port < 0)
+        {
+            ::close(fd);
+        }
+        return port;
+    }
+
+    /// @brief Add an open fd, such as a pipe, socket or log file, to the loop. The fd is made non-blocking, and the
+    /// loop owns it from now on. Regular files cannot be watched by epoll; they are read every iteration until they
+    /// end, which replays a log as fast as it can be parsed.
+    ///
+    /// @return Port number, or -1 if the fd cannot be watched.
+    int GpsSerialIngest::add_fd(int fd)
+    {
+        int flags = fcntl(fd, F_GETFL);
+        if (m_epoll < 0 || flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0)
+        {
+            return -1;
+        }
+
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u32 = (uint32_t)m_ports.size();
+        bool always_ready = false;
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            if (errno != EPERM)
+            {
+                return -1;
+            }
+            always_ready = true;
+        }
+
+        Port port;
+        port.fd = fd;
+        port.always_ready = always_ready;
+        port.bytes = 0;
+        port.fixes = 0;
+        m_ports.push_back(port);
+        return (int)(m_ports.size() - 1);
+    }
+
+    /// @brief Remove a port from the loop and close it. Port numbers are not reused.
+    ///
+    /// @return False if the port is not open.
+    bool GpsSerialIngest::remove_port(size_type port)
+    {
+        if (!is_open(port))
+        {
+            return false;
+        }
+
+        close_port(port);
+        return true;
+    }
+
+    /// @brief Run one loop iteration: wait for readable ports, drain them and hand the completed fixes to the
+    /// handler in one call.
+    ///
+    /// @param timeout_ms Longest time to wait, or -1 to wait until a port is readable.
+    /// @return Number of fixes handed to the handler, or -1 if waiting failed.
+    int GpsSerialIngest::poll(int timeout_ms)
+    {
+        if (m_epoll < 0)
+        {
+            return -1;
+        }
+
+        // Files are always readable, so do not wait while one is open.
+        bool any_ready = false;
+        for (const auto &port : m_ports)
+        {
+            any_ready = any_ready || (port.fd >= 0 && port.always_ready);
+        }
+
+        struct epoll_event events[max_events];
+        int count = epoll_wait(m_epoll, events, max_events, any_ready ? 0 : timeout_ms);
+        if (count < 0)
+        {
+            return errno == EINTR ? 0 : -1;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            size_type port = events[i].data.u32;
+            if (is_open(port) && !read_port(port))
+            {
+                close_port(port);
+            }
+        }
+
+        for (size_type port = 0; any_ready && port < m_ports.size(); ++port)
+        {
+            if (m_ports[port].fd >= 0 && m_ports[port].always_ready && !read_port(port))
+            {
+                close_port(port);
+            }
+        }
+
+        int fixes = (int)m_batch.size();
+        if (!m_batch.empty())
+        {
+            if (m_handler)
+            {
+                m_handler(m_batch.data(), (size_type)m_batch.size(), m_context);
+            }
+            m_batch.clear();
+        }
+        return fixes;
+    }
+
+    /// @brief Run loop iterations until stop() is called or waiting fails.
+    ///
+    /// @param timeout_ms Longest wait per iteration, which bounds how long stop() takes to be seen.
+    void GpsSerialIngest::run(int timeout_ms)
+    {
+        m_stop = false;
+        while (!m_stop && poll(timeout_ms) >= 0)
+        {
+        }
+    }
+
+    /// @brief Make run() return after the current iteration. Safe to call from another thread or a signal handler.
+    void GpsSerialIngest::stop()
+    {
+        m_stop = true;
+    }
+
+    /// @brief Returns true if a port is open.
+    bool GpsSerialIngest::is_open(size_type port) const
+    {
+        return port < m_ports.size() && m_ports[port].fd >= 0;
+    }
+
+    /// @brief Get the number of bytes read from a port.
+    uint64_t GpsSerialIngest::bytes_read(size_type port) const
+    {
+        return port < m_ports.size() ? m_ports[port].bytes : 0;
+    }
+
+    /// @brief Get the number of fixes completed on a port.
+    uint64_t GpsSerialIngest::fix_count(size_type port) const
+    {
+        return port < m_ports.size() ? m_ports[port].fixes : 0;
+    }
+
+    /// @brief Read a readable port until it is drained or has had its share of reads, and parse what was read.
+    ///
+    /// @return False if the port hung up or failed and must be closed.
+    bool GpsSerialIngest::read_port(size_type index)
+    {
+        Port &port = m_ports[index];
+        for (size_type reads = 0; reads < serial_reads_per_event; ++reads)
+        {
+            ssize_t size = ::read(port.fd, m_buffer.data(), m_buffer.size());
+            if (size < 0)
+            {
+                return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            }
+            if (size == 0)
+            {
+                return false;
+            }
+
+            port.bytes += (uint64_t)size;
+            size_type offset = 0;
+            while (offset < (size_type)size)
+            {
+                offset += port.gps.process_until_complete(m_buffer.data() + offset, (size_type)size - offset);
+                if (port.gps.complete() && port.gps.good() && port.gps.message_type() == MessageType::GGA)
+                {
+                    m_batch.push_back({index, port.gps.position_data()});
+                    ++port.fixes;
+                }
+            }
+
+            // A short read means the port is drained.
+            if ((size_t)size < m_buffer.size())
+            {
+                return true;
+            }
+        }
+        return true;
+    }
+
+    /// @brief Remove a port from epoll and close its fd.
+    void GpsSerialIngest::close_port(size_type index)
+    {
+        Port &port = m_ports[index];
+        if (port.fd >= 0)
+        {
+            if (!port.always_ready)
+            {
+                epoll_ctl(m_epoll, EPOLL_CTL_DEL, port.fd, nullptr);
+            }
+            ::close(port.fd);
+            port.fd = -1;
+        }
+    }
+
+} // namespace gps
+} // namespace scottz0r
@@ -0,0 +1,100 @@
+/// @file Serial port ingest definitions.
+///
+/// This module reads many serial ports from one thread with an epoll event loop. Host only (Linux).
+///
+/// Ports are switched to raw, non-blocking mode. Each loop iteration waits for readable ports and drains them with
+/// large read() calls into a MicroGps per port. The fixes completed in an iteration are handed to the consumer in one
+/// batch.
+#ifndef _SCOTTZ0R_GPS_SERIAL_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_SERIAL_INCLUDE_GUARD
+
+#include "../MicroGps.h"
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Default size of each read() call, in bytes.
+    constexpr size_type serial_read_size = 65536;
+
+    /// Largest number of full reads of one port per loop iteration, so a busy port cannot starve the others.
+    constexpr size_type serial_reads_per_event = 4;
+
+    /// @brief Fix completed on a port.
+    struct GpsPortFix
+    {
+        size_type port;       ///< Port number returned by GpsSerialIngest::add_port().
+        GpsPosition position; ///< Position of a good GGA sentence.
+    };
+
+    /// @brief Called once per loop iteration with the fixes completed in it, in the order they were read.
+    using GpsFixBatchHandler = void (*)(const GpsPortFix *fixes, size_type count, void *context);
+
+    bool configure_serial_port(int fd, unsigned long baud);
+
+    /// @brief Event loop over serial ports.
+    class GpsSerialIngest
+    {
+    public:
+        GpsSerialIngest(GpsFixBatchHandler handler, void *context, size_type read_size = serial_read_size);
+
+        ~GpsSerialIngest();
+
+        GpsSerialIngest(const GpsSerialIngest &) = delete;
+        GpsSerialIngest &operator=(const GpsSerialIngest &) = delete;
+
+        int add_port(const char *path, unsigned long baud = 0);
+
+        int add_fd(int fd);
+
+        bool remove_port(size_type port);
+
+        int poll(int timeout_ms);
+
+        void run(int timeout_ms = 100);
+
+        void stop();
+
+        /// @brief Get the number of ports ever added, open or not.
+        inline size_type port_count() const
+        {
+            return (size_type)m_ports.size();
+        }
+
+        bool is_open(size_type port) const;
+
+        uint64_t bytes_read(size_type port) const;
+
+        uint64_t fix_count(size_type port) const;
+
+    private:
+        /// @brief State of one port.
+        struct Port
+        {
+            int fd;
+            bool always_ready;
+            uint64_t bytes;
+            uint64_t fixes;
+            MicroGps gps;
+        };
+
+        bool read_port(size_type port);
+
+        void close_port(size_type port);
+
+        GpsFixBatchHandler m_handler;
+        void *m_context;
+        int m_epoll;
+        std::vector<Port> m_ports;
+        std::vector<char> m_buffer;
+        std::vector<GpsPortFix> m_batch;
+        std::atomic<bool> m_stop;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_SERIAL_INCLUDE_GUARD
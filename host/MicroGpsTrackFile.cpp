@@ -0,0 +1,473 @@
+/// @file Block structured track file implementation.
+#include "MicroGpsTrackFile.h"
+#include "MicroGpsBytes.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    using namespace scottz0r::gps::_detail;
+
+    /// Sizes of the fixed parts of the file, in bytes.
+    static constexpr size_type file_header_size = 16;
+    static constexpr size_type block_header_size = 40;
+    static constexpr size_type index_entry_size = 12;
+    static constexpr size_type trailer_size = 24;
+
+    static constexpr uint16_t file_version = 1;
+    static const char file_magic[4] = {'M', 'G', 'T', 'K'};
+    static const char trailer_magic[4] = {'M', 'G', 'T', 'I'};
+
+    /// Milliseconds per day. A block never spans a whole day, so times of day inside a block are unambiguous.
+    static constexpr uint64_t day_ms = 86400000ULL;
+
+    /// @brief Read a block header from the start of a block.
+    static GpsTrackBlockHeader read_block_header(const char *p)
+    {
+        GpsTrackBlockHeader header;
+        header.first_ms = get_u64(p);
+        header.last_ms = get_u64(p + 8);
+        header.min_latitude = (int32_t)get_u32(p + 16);
+        header.max_latitude = (int32_t)get_u32(p + 20);
+        header.min_longitude = (int32_t)get_u32(p + 24);
+        header.max_longitude = (int32_t)get_u32(p + 28);
+        header.count = get_u16(p + 32);
+        header.payload_size = get_u16(p + 34);
+        return header;
+    }
+
+    /// @brief Write a block header to the start of a block. The last 4 bytes are reserved.
+    static void write_block_header(const GpsTrackBlockHeader &header, char *p)
+    {
+        put_u64(p, header.first_ms);
+        put_u64(p + 8, header.last_ms);
+        put_u32(p + 16, (uint32_t)header.min_latitude);
+        put_u32(p + 20, (uint32_t)header.max_latitude);
+        put_u32(p + 24, (uint32_t)header.min_longitude);
+        put_u32(p + 28, (uint32_t)header.max_longitude);
+        put_u16(p + 32, header.count);
+        put_u16(p + 34, header.payload_size);
+        put_u32(p + 36, 0);
+    }
+
+    /// @brief Decode the fixes of a block, calling the handler for those in [begin_ms, end_ms).
+    ///
+    /// @return Number of fixes passed to the handler.
+    static size_type decode_records(const char *block, size_type block_size, uint64_t begin_ms, uint64_t end_ms,
+                                    GpsTrackHandler handler, void *context)
+    {
+        GpsTrackBlockHeader header = read_block_header(block);
+        if (header.payload_size > block_size - block_header_size)
+        {
+            return 0;
+        }
+
+        const char *p = block + block_header_size;
+        size_type remaining = header.payload_size;
+        uint64_t first_time_of_day = header.first_ms % day_ms;
+
+        GpsTrackDecoder decoder;
+        size_type delivered = 0;
+        for (size_type i = 0; i < header.count; ++i)
+        {
+            FixedGpsPosition position;
+            size_type size = decoder.decode(p, remaining, position);
+            if (size == 0)
+            {
+                break;
+            }
+            p += size;
+            remaining -= size;
+
+            uint64_t utc_ms = header.first_ms + (position.time_ms + day_ms - first_time_of_day) % day_ms;
+            if (utc_ms >= begin_ms && utc_ms < end_ms)
+            {
+                handler(position, utc_ms, context);
+                ++delivered;
+            }
+        }
+
+        return delivered;
+    }
+
+    /// @brief Initialize the writer.
+    ///
+    /// @param block_size Size of each block in bytes, from 73 to 65575.
+    /// @param index_stride Number of blocks per sparse index entry.
+    GpsTrackFileWriter::GpsTrackFileWriter(size_type block_size, size_type index_stride)
+        : m_file(nullptr), m_header({}), m_block_size(block_size), m_index_stride(index_stride), m_block_count(0),
+          m_last_ms(0), m_bad(false)
+    {
+    }
+
+    GpsTrackFileWriter::~GpsTrackFileWriter()
+    {
+        close();
+    }
+
+    /// @brief Create or truncate a track file and write its header.
+    ///
+    /// @return False if the file cannot be created, or the block size or index stride is out of range.
+    bool GpsTrackFileWriter::open(const char *path)
+    {
+        close();
+
+        if (m_block_size < block_header_size + track_record_max_size || m_block_size > block_header_size + 0xFFFF ||
+            m_index_stride == 0)
+        {
+            return false;
+        }
+
+        m_file = fopen(path, "wb");
+        if (!m_file)
+        {
+            return false;
+        }
+
+        m_block.assign(m_block_size, 0);
+        m_index.clear();
+        m_encoder.reset();
+        m_header = {};
+        m_block_count = 0;
+        m_last_ms = 0;
+        m_bad = false;
+
+        char header[file_header_size] = {};
+        for (size_type i = 0; i < 4; ++i)
+        {
+            header[i] = file_magic[i];
+        }
+        put_u16(header + 4, file_version);
+        put_u32(header + 8, (uint32_t)m_block_size);
+        put_u32(header + 12, (uint32_t)m_index_stride);
+
+        m_bad = fwrite(header, 1, sizeof(header), m_file) != sizeof(header);
+        return !m_bad;
+    }
+
+    /// @brief Append a fix.
+    ///
+    /// @param position Fix to append. Must have a time (PositionField::Time).
+    /// @param date Packed date of the fix (see pack_date()), or 0 if unknown (GGA only input). A fix without a date is
+    /// on the day of the last fix, or the next day if its time of day is more than half a day earlier, so undated
+    /// tracks continue across midnight. The first undated fix is on 1970-01-01.
+    /// @return False if the file is not open, a write failed, the fix has no time or it is older than the last fix.
+    bool GpsTrackFileWriter::append(const FixedGpsPosition &position, unsigned short date)
+    {
+        if (!m_file || m_bad || !has_field(position, PositionField::Time))
+        {
+            return false;
+        }
+
+        uint64_t utc_ms = utc_epoch_ms(date, 0) + position.time_ms;
+        if (date == 0)
+        {
+            // A large step back in the time of day is midnight, as in GpsMerge.
+            utc_ms = m_last_ms - m_last_ms % day_ms + position.time_ms;
+            if (utc_ms + day_ms / 2 < m_last_ms)
+            {
+                utc_ms += day_ms;
+            }
+        }
+
+        if (utc_ms < m_last_ms)
+        {
+            return false;
+        }
+
+        if (m_header.count > 0 && (utc_ms - m_header.first_ms >= day_ms || m_header.count == 0xFFFF))
+        {
+            if (!flush_block())
+            {
+                return false;
+            }
+        }
+
+        if (m_header.count == 0)
+        {
+            begin_block(utc_ms);
+        }
+
+        size_type offset = block_header_size + m_header.payload_size;
+        size_type size = m_encoder.encode(position, m_block.data() + offset, m_block_size - offset);
+        if (size == 0)
+        {
+            // Block is full. The block size always fits at least one record.
+            if (!flush_block())
+            {
+                return false;
+            }
+            begin_block(utc_ms);
+            size = m_encoder.encode(position, m_block.data() + block_header_size, m_block_size - block_header_size);
+        }
+
+        m_header.last_ms = utc_ms;
+        m_header.payload_size = (unsigned short)(m_header.payload_size + size);
+        ++m_header.count;
+
+        if (has_field(position, PositionField::Latitude) && has_field(position, PositionField::Longitude))
+        {
+            if (position.latitude < m_header.min_latitude)
+            {
+                m_header.min_latitude = position.latitude;
+            }
+            if (position.latitude > m_header.max_latitude)
+            {
+                m_header.max_latitude = position.latitude;
+            }
+            if (position.longitude < m_header.min_longitude)
+            {
+                m_header.min_longitude = position.longitude;
+            }
+            if (position.longitude > m_header.max_longitude)
+            {
+                m_header.max_longitude = position.longitude;
+            }
+        }
+
+        m_last_ms = utc_ms;
+        return true;
+    }
+
+    /// @brief Write the last block, the sparse index and the trailer, then close the file.
+    ///
+    /// @return False if the file was not open or a write failed. The file is closed either way.
+    bool GpsTrackFileWriter::close()
+    {
+        if (!m_file)
+        {
+            return false;
+        }
+
+        if (m_header.count > 0)
+        {
+            flush_block();
+        }
+
+        if (!m_bad && !m_index.empty())
+        {
+            m_bad = fwrite(m_index.data(), 1, m_index.size(), m_file) != m_index.size();
+        }
+
+        char trailer[trailer_size] = {};
+        put_u64(trailer, file_header_size + (uint64_t)m_block_count * m_block_size);
+        put_u32(trailer + 8, (uint32_t)(m_index.size() / index_entry_size));
+        put_u32(trailer + 12, (uint32_t)m_block_count);
+        for (size_type i = 0; i < 4; ++i)
+        {
+            trailer[20 + i] = trailer_magic[i];
+        }
+
+        if (!m_bad)
+        {
+            m_bad = fwrite(trailer, 1, sizeof(trailer), m_file) != sizeof(trailer);
+        }
+
+        m_bad = (fclose(m_file) != 0) || m_bad;
+        m_file = nullptr;
+        return !m_bad;
+    }
+
+    /// @brief Start a new block with its first fix at the given time.
+    void GpsTrackFileWriter::begin_block(uint64_t utc_ms)
+    {
+        m_encoder.reset();
+        m_header = {};
+        m_header.first_ms = utc_ms;
+        m_header.last_ms = utc_ms;
+        m_header.min_latitude = INT32_MAX;
+        m_header.max_latitude = INT32_MIN;
+        m_header.min_longitude = INT32_MAX;
+        m_header.max_longitude = INT32_MIN;
+    }
+
+    /// @brief Write the current block, and index it if it starts an index stride.
+    bool GpsTrackFileWriter::flush_block()
+    {
+        write_block_header(m_header, m_block.data());
+        for (size_type i = block_header_size + m_header.payload_size; i < m_block_size; ++i)
+        {
+            m_block[i] = 0;
+        }
+
+        if (m_block_count % m_index_stride == 0)
+        {
+            char entry[index_entry_size];
+            put_u64(entry, m_header.first_ms);
+            put_u32(entry + 8, (uint32_t)m_block_count);
+            m_index.insert(m_index.end(), entry, entry + index_entry_size);
+        }
+
+        m_bad = fwrite(m_block.data(), 1, m_block_size, m_file) != m_block_size || m_bad;
+        ++m_block_count;
+        m_header.count = 0;
+        return !m_bad;
+    }
+
+    GpsTrackFileReader::GpsTrackFileReader()
+        : m_data(nullptr), m_size(0), m_block_size(0), m_block_count(0), m_index(nullptr), m_index_entries(0)
+    {
+    }
+
+    GpsTrackFileReader::~GpsTrackFileReader()
+    {
+        close();
+    }
+
+    /// @brief Map a track file and check its header, trailer and index.
+    ///
+    /// @return False if the file cannot be mapped or is not a complete track file.
+    bool GpsTrackFileReader::open(const char *path)
+    {
+        close();
+
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < file_header_size + trailer_size)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        void *data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED)
+        {
+            return false;
+        }
+
+        m_data = (const char *)data;
+        m_size = (size_t)info.st_size;
+
+        const char *trailer = m_data + m_size - trailer_size;
+        uint64_t index_offset = get_u64(trailer);
+        m_index_entries = get_u32(trailer + 8);
+        m_block_count = get_u32(trailer + 12);
+        m_block_size = get_u32(m_data + 8);
+
+        bool valid = equals4(m_data, file_magic) && get_u16(m_data + 4) == file_version &&
+                     equals4(trailer + 20, trailer_magic) && m_block_size >= block_header_size &&
+                     index_offset == file_header_size + (uint64_t)m_block_count * m_block_size &&
+                     index_offset + (uint64_t)m_index_entries * index_entry_size + trailer_size == m_size;
+        if (!valid)
+        {
+            close();
+            return false;
+        }
+
+        m_index = m_data + index_offset;
+        return true;
+    }
+
+    /// @brief Unmap the file.
+    void GpsTrackFileReader::close()
+    {
+        if (m_data)
+        {
+            munmap((void *)m_data, m_size);
+        }
+
+        m_data = nullptr;
+        m_size = 0;
+        m_block_size = 0;
+        m_block_count = 0;
+        m_index = nullptr;
+        m_index_entries = 0;
+    }
+
+    /// @brief Read the header of a block.
+    ///
+    /// @return False if the block does not exist.
+    bool GpsTrackFileReader::block_header(size_type block, GpsTrackBlockHeader &header) const
+    {
+        if (block >= m_block_count)
+        {
+            return false;
+        }
+
+        header = read_block_header(block_data(block));
+        return true;
+    }
+
+    /// @brief Find the first block that ends at or after a time. The sparse index is binary searched, then block
+    /// headers within one index stride are scanned.
+    ///
+    /// @return Block number, or block_count() if every block ends before the time.
+    size_type GpsTrackFileReader::find_block(uint64_t utc_ms) const
+    {
+        // Last index entry that starts at or before the time.
+        size_type low = 0;
+        size_type high = m_index_entries;
+        while (low < high)
+        {
+            size_type mid = low + (high - low) / 2;
+            if (get_u64(m_index + mid * index_entry_size) <= utc_ms)
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+
+        size_type block = low > 0 ? get_u32(m_index + (low - 1) * index_entry_size + 8) : 0;
+        while (block < m_block_count && get_u64(block_data(block) + 8) < utc_ms)
+        {
+            ++block;
+        }
+
+        return block;
+    }
+
+    /// @brief Decode every fix of a block.
+    ///
+    /// @return Number of fixes passed to the handler.
+    size_type GpsTrackFileReader::decode_block(size_type block, GpsTrackHandler handler, void *context) const
+    {
+        if (block >= m_block_count)
+        {
+            return 0;
+        }
+
+        return decode_records(block_data(block), m_block_size, 0, UINT64_MAX, handler, context);
+    }
+
+    /// @brief Decode the fixes in [begin_ms, end_ms), in time order. Only blocks that overlap the range are touched.
+    ///
+    /// @return Number of fixes passed to the handler.
+    size_type GpsTrackFileReader::query(uint64_t begin_ms, uint64_t end_ms, GpsTrackHandler handler,
+                                        void *context) const
+    {
+        size_type delivered = 0;
+        for (size_type block = find_block(begin_ms); block < m_block_count; ++block)
+        {
+            const char *data = block_data(block);
+            if (get_u64(data) >= end_ms)
+            {
+                break;
+            }
+
+            delivered += decode_records(data, m_block_size, begin_ms, end_ms, handler, context);
+        }
+
+        return delivered;
+    }
+
+    /// @brief Get a pointer to the start of a block.
+    const char *GpsTrackFileReader::block_data(size_type block) const
+    {
+        return m_data + file_header_size + (size_t)block * m_block_size;
+    }
+
+} // namespace gps
+} // namespace scottz0r
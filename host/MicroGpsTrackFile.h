@@ -0,0 +1,135 @@
+/// @file Block structured track file definitions.
+///
+/// This module defines an on-disk format for long position logs. Host only (POSIX): the host directory is not built by
+/// the Arduino IDE.
+///
+/// Layout, all integers little endian:
+/// - File header (16 bytes): magic "MGTK", version, block size and index stride.
+/// - Blocks of block size bytes: a 40 byte GpsTrackBlockHeader followed by GpsTrackEncoder records. The encoder is
+///   reset at the start of every block, so each block decodes on its own.
+/// - Sparse index: the first time and number of every index stride'th block.
+/// - Trailer (24 bytes): index offset, index entry count, block count and magic "MGTI".
+#ifndef _SCOTTZ0R_GPS_TRACK_FILE_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_TRACK_FILE_INCLUDE_GUARD
+
+#include "../MicroGpsTrack.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Default block size in bytes. One page, so a query touches only the pages of the blocks it decodes.
+    constexpr size_type track_file_block_size = 4096;
+
+    /// Default number of blocks per sparse index entry.
+    constexpr size_type track_file_index_stride = 16;
+
+    /// @brief Summary of a block, stored at the start of the block.
+    struct GpsTrackBlockHeader
+    {
+        uint64_t first_ms;    ///< UTC milliseconds since the Unix epoch of the first fix.
+        uint64_t last_ms;     ///< UTC milliseconds since the Unix epoch of the last fix.
+        int32_t min_latitude; ///< Bounding box in 1e-7 degrees. Empty (min > max) if no fix has a position.
+        int32_t max_latitude;
+        int32_t min_longitude;
+        int32_t max_longitude;
+        unsigned short count;        ///< Number of fixes.
+        unsigned short payload_size; ///< Number of encoded bytes after the header.
+    };
+
+    /// @brief Called for each fix found by a query.
+    ///
+    /// @param position Decoded fix.
+    /// @param utc_ms UTC milliseconds since the Unix epoch of the fix.
+    /// @param context Context given to the query.
+    using GpsTrackHandler = void (*)(const FixedGpsPosition &position, uint64_t utc_ms, void *context);
+
+    /// @brief Writes a track file. Fixes must be appended in time order.
+    class GpsTrackFileWriter
+    {
+    public:
+        explicit GpsTrackFileWriter(size_type block_size = track_file_block_size,
+                                    size_type index_stride = track_file_index_stride);
+
+        ~GpsTrackFileWriter();
+
+        GpsTrackFileWriter(const GpsTrackFileWriter &) = delete;
+        GpsTrackFileWriter &operator=(const GpsTrackFileWriter &) = delete;
+
+        bool open(const char *path);
+
+        bool append(const FixedGpsPosition &position, unsigned short date);
+
+        bool close();
+
+        /// @brief Get the number of blocks written so far.
+        inline size_type block_count() const
+        {
+            return m_block_count;
+        }
+
+    private:
+        void begin_block(uint64_t utc_ms);
+
+        bool flush_block();
+
+        FILE *m_file;
+        std::vector<char> m_block;
+        std::vector<char> m_index;
+        GpsTrackEncoder m_encoder;
+        GpsTrackBlockHeader m_header;
+        size_type m_block_size;
+        size_type m_index_stride;
+        size_type m_block_count;
+        uint64_t m_last_ms;
+        bool m_bad;
+    };
+
+    /// @brief Reads a track file through a read only memory map. Only the blocks a query needs are decoded.
+    class GpsTrackFileReader
+    {
+    public:
+        GpsTrackFileReader();
+
+        ~GpsTrackFileReader();
+
+        GpsTrackFileReader(const GpsTrackFileReader &) = delete;
+        GpsTrackFileReader &operator=(const GpsTrackFileReader &) = delete;
+
+        bool open(const char *path);
+
+        void close();
+
+        /// @brief Get the number of blocks in the file.
+        inline size_type block_count() const
+        {
+            return m_block_count;
+        }
+
+        bool block_header(size_type block, GpsTrackBlockHeader &header) const;
+
+        size_type find_block(uint64_t utc_ms) const;
+
+        size_type decode_block(size_type block, GpsTrackHandler handler, void *context) const;
+
+        size_type query(uint64_t begin_ms, uint64_t end_ms, GpsTrackHandler handler, void *context) const;
+
+    private:
+        const char *block_data(size_type block) const;
+
+        const char *m_data;
+        size_t m_size;
+        size_type m_block_size;
+        size_type m_block_count;
+        const char *m_index;
+        size_type m_index_entries;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_TRACK_FILE_INCLUDE_GUARD
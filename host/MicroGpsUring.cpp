@@ -0,0 +1,593 @@
+/// @file io_uring ingest implementation.
+#include "MicroGpsUring.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Multishot read opcode (Linux 6.7), which older kernel headers do not define.
+    static constexpr unsigned char op_read_multishot = 49;
+
+    /// Buffer group of the provided buffer ring.
+    static constexpr unsigned short buffer_group = 0;
+
+    /// User data of requests whose completions are ignored, such as cancellations.
+    static constexpr uint64_t ignored_user_data = UINT64_MAX;
+
+    static int io_uring_setup(unsigned entries, struct io_uring_params *params)
+    {
+        return (int)syscall(__NR_io_uring_setup, entries, params);
+    }
+
+    static int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, const void *arg,
+                              size_t arg_size)
+    {
+        return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, arg_size);
+    }
+
+    static int io_uring_register(int fd, unsigned opcode, const void *arg, unsigned count)
+    {
+        return (int)syscall(__NR_io_uring_register, fd, opcode, arg, count);
+    }
+
+    template <typename T> static inline T load_acquire(const T *p)
+    {
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+    }
+
+    template <typename T> static inline void store_release(T *p, T value)
+    {
+        __atomic_store_n(p, value, __ATOMIC_RELEASE);
+    }
+
+    /// @brief Initialize the loop, on io_uring if it is allowed and available.
+    ///
+    /// @param handler Called with the fixes of each loop iteration.
+    /// @param context Context given to the handler.
+    /// @param allow_uring False to always run on the epoll fallback.
+    /// @param buffer_size Size of each provided buffer, which is the most one read returns.
+    /// @param buffer_count Number of provided buffers, a power of two up to 32768.
+    GpsUringIngest::GpsUringIngest(GpsFixBatchHandler handler, void *context, bool allow_uring,
+                                   size_type buffer_size, size_type buffer_count)
+        : m_fallback(handler, context, buffer_size), m_handler(handler), m_context(context), m_stop(false),
+          m_ring_fd(-1), m_has_multishot(false), m_sq_ring(MAP_FAILED), m_sq_ring_size(0), m_cq_ring(MAP_FAILED),
+          m_cq_ring_size(0), m_sqes(nullptr), m_sqes_size(0), m_sq_head(nullptr), m_sq_tail(nullptr),
+          m_sq_mask(nullptr), m_sq_array(nullptr), m_sq_entries(0), m_cq_head(nullptr), m_cq_tail(nullptr),
+          m_cq_mask(nullptr), m_cqes(nullptr), m_to_submit(0), m_buffer_ring(MAP_FAILED), m_buffer_ring_size(0),
+          m_buffers(nullptr), m_buffers_size(0), m_buffer_size(buffer_size), m_buffer_count(buffer_count),
+          m_buffer_tail(0)
+    {
+        if (allow_uring && !setup(buffer_size, buffer_count))
+        {
+            teardown();
+        }
+    }
+
+    GpsUringIngest::~GpsUringIngest()
+    {
+        for (size_type port = 0; port < m_ports.size(); ++port)
+        {
+            close_port(port);
+        }
+        teardown();
+    }
+
+    /// @brief Create the ring, map its queues and register the provided buffers.
+    ///
+    /// @return False if any step is not supported. teardown() releases what was set up.
+    bool GpsUringIngest::setup(size_type buffer_size, size_type buffer_count)
+    {
+        if (buffer_size == 0 || buffer_count == 0 || buffer_count > 32768 || (buffer_count & (buffer_count - 1)))
+        {
+            return false;
+        }
+
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        m_ring_fd = io_uring_setup(uring_queue_depth, &params);
+        if (m_ring_fd < 0)
+        {
+            return false;
+        }
+
+        if (!(params.features & IORING_FEAT_EXT_ARG))
+        {
+            return false;
+        }
+
+        m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            m_sq_ring_size = m_cq_ring_size = m_sq_ring_size > m_cq_ring_size ? m_sq_ring_size : m_cq_ring_size;
+        }
+
+        m_sq_ring = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                         IORING_OFF_SQ_RING);
+        if (m_sq_ring == MAP_FAILED)
+        {
+            return false;
+        }
+
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            m_cq_ring = m_sq_ring;
+        }
+        else
+        {
+            m_cq_ring = mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                             IORING_OFF_CQ_RING);
+            if (m_cq_ring == MAP_FAILED)
+            {
+                return false;
+            }
+        }
+
+        m_sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+        void *sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd,
+                          IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+        {
+            return false;
+        }
+        m_sqes = (struct io_uring_sqe *)sqes;
+
+        char *sq = (char *)m_sq_ring;
+        m_sq_head = (unsigned *)(sq + params.sq_off.head);
+        m_sq_tail = (unsigned *)(sq + params.sq_off.tail);
+        m_sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+        m_sq_array = (unsigned *)(sq + params.sq_off.array);
+        m_sq_entries = params.sq_entries;
+
+        char *cq = (char *)m_cq_ring;
+        m_cq_head = (unsigned *)(cq + params.cq_off.head);
+        m_cq_tail = (unsigned *)(cq + params.cq_off.tail);
+        m_cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+        m_cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+        // Provided buffer ring (Linux 5.19): the kernel takes buffers from it as reads complete.
+        m_buffer_ring_size = buffer_count * sizeof(struct io_uring_buf);
+        m_buffer_ring = mmap(nullptr, m_buffer_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m_buffer_ring == MAP_FAILED)
+        {
+            return false;
+        }
+
+        m_buffers_size = (size_t)buffer_size * buffer_count;
+        void *buffers = mmap(nullptr, m_buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buffers == MAP_FAILED)
+        {
+            return false;
+        }
+        m_buffers = (char *)buffers;
+
+        struct io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = (uint64_t)(uintptr_t)m_buffer_ring;
+        reg.ring_entries = (uint32_t)buffer_count;
+        reg.bgid = buffer_group;
+        if (io_uring_register(m_ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+        {
+            return false;
+        }
+
+        m_buffer_tail = 0;
+        for (size_type id = 0; id < buffer_count; ++id)
+        {
+            recycle_buffer((unsigned short)id);
+        }
+
+        // Multishot reads are optional; single reads are used without them.
+        size_t probe_size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+        std::vector<char> probe_data(probe_size, 0);
+        struct io_uring_probe *probe = (struct io_uring_probe *)probe_data.data();
+        m_has_multishot = io_uring_register(m_ring_fd, IORING_REGISTER_PROBE, probe, 256) == 0 &&
+                          probe->last_op >= op_read_multishot &&
+                          (probe->ops[op_read_multishot].flags & IO_URING_OP_SUPPORTED);
+        return true;
+    }
+
+    /// @brief Release the ring and buffers. The loop runs on the fallback afterwards.
+    void GpsUringIngest::teardown()
+    {
+        if (m_sqes)
+        {
+            munmap(m_sqes, m_sqes_size);
+        }
+        if (m_cq_ring != MAP_FAILED && m_cq_ring != m_sq_ring)
+        {
+            munmap(m_cq_ring, m_cq_ring_size);
+        }
+        if (m_sq_ring != MAP_FAILED)
+        {
+            munmap(m_sq_ring, m_sq_ring_size);
+        }
+        if (m_ring_fd >= 0)
+        {
+            ::close(m_ring_fd);
+        }
+        if (m_buffer_ring != MAP_FAILED)
+        {
+            munmap(m_buffer_ring, m_buffer_ring_size);
+        }
+        if (m_buffers)
+        {
+            munmap(m_buffers, m_buffers_size);
+        }
+
+        m_ring_fd = -1;
+        m_sq_ring = MAP_FAILED;
+        m_cq_ring = MAP_FAILED;
+        m_sqes = nullptr;
+        m_buffer_ring = MAP_FAILED;
+        m_buffers = nullptr;
+    }
+
+    /// @brief Open a serial device and add it to the loop. See GpsSerialIngest::add_port().
+    int GpsUringIngest::add_port(const char *path, unsigned long baud)
+    {
+        if (backend() == GpsIngestBackend::Epoll)
+        {
+            return m_fallback.add_port(path, baud);
+        }
+
+        int fd = ::open(path, O_RDONLY | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return -1;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (!S_ISREG(info.st_mode) && !configure_serial_port(fd, baud)))
+        {
+            ::close(fd);
+            return -1;
+        }
+
+        int port = add_fd(fd);
+        if (port < 0)
+        {
+            ::close(fd);
+        }
+        return port;
+    }
+
+    /// @brief Add an open fd, such as a pipe, socket or log file, to the loop. The loop owns it from now on. See
+    /// GpsSerialIngest::add_fd().
+    ///
+    /// @return Port number, or -1 if the fd cannot be read.
+    int GpsUringIngest::add_fd(int fd)
+    {
+        if (backend() == GpsIngestBackend::Epoll)
+        {
+            return m_fallback.add_fd(fd);
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            return -1;
+        }
+
+        Port port;
+        port.fd = fd;
+        port.multishot = m_has_multishot && !S_ISREG(info.st_mode);
+        port.armed = false;
+        port.bytes = 0;
+        port.fixes = 0;
+        m_ports.push_back(port);
+
+        size_type index = (size_type)(m_ports.size() - 1);
+        if (!queue_read(index))
+        {
+            m_ports.pop_back();
+            return -1;
+        }
+        return (int)index;
+    }
+
+    /// @brief Remove a port from the loop and close it. Port numbers are not reused.
+    ///
+    /// @return False if the port is not open.
+    bool GpsUringIngest::remove_port(size_type port)
+    {
+        if (backend() == GpsIngestBackend::Epoll)
+        {
+            return m_fallback.remove_port(port);
+        }
+
+        if (!is_open(port))
+        {
+            return false;
+        }
+
+        close_port(port);
+        return true;
+    }
+
+    /// @brief Run one loop iteration: submit queued reads, wait for completions, parse them in place and hand the
+    /// completed fixes to the handler in one call.
+    ///
+    /// @param timeout_ms Longest time to wait, or -1 to wait until a read completes.
+    /// @return Number of fixes handed to the handler, or -1 if waiting failed.
+    int GpsUringIngest::poll(int timeout_ms)
+    {
+        if (backend() == GpsIngestBackend::Epoll)
+        {
+            return m_fallback.poll(timeout_ms);
+        }
+
+        if (enter(1, timeout_ms) < 0)
+        {
+            return -1;
+        }
+
+        reap();
+
+        // Re-arm ports whose reads ended, so data is not left waiting until the next iteration.
+        if (m_to_submit > 0 && enter(0, 0) < 0)
+        {
+            return -1;
+        }
+
+        int fixes = (int)m_batch.size();
+        if (!m_batch.empty())
+        {
+            if (m_handler)
+            {
+                m_handler(m_batch.data(), (size_type)m_batch.size(), m_context);
+            }
+            m_batch.clear();
+        }
+        return fixes;
+    }
+
+    /// @brief Run loop iterations until stop() is called or waiting fails.
+    void GpsUringIngest::run(int timeout_ms)
+    {
+        if (backend() == GpsIngestBackend::Epoll)
+        {
+            m_fallback.run(timeout_ms);
+            return;
+        }
+
+        m_stop = false;
+        while (!m_stop && poll(timeout_ms) >= 0)
+        {
+        }
+    }
+
+    /// @brief Make run() return after the current iteration. Safe to call from another thread or a signal handler.
+    void GpsUringIngest::stop()
+    {
+        m_stop = true;
+        m_fallback.stop();
+    }
+
+    /// @brief Get the number of ports ever added, open or not.
+    size_type GpsUringIngest::port_count() const
+    {
+        return backend() == GpsIngestBackend::Epoll ? m_fallback.port_count() : (size_type)m_ports.size();
+    }
+
+    /// @brief Returns true if a port is open.
+    bool GpsUringIngest::is_open(size_type port) const
+    {
+        if (backend() == GpsIngestBackend::Epoll)
+        {
+            return m_fallback.is_open(port);
+        }
+        return port < m_ports.size() && m_ports[port].fd >= 0;
+    }
+
+    /// @brief Get the number of bytes read from a port.
+    uint64_t GpsUringIngest::bytes_read(size_type port) const
+    {
+        if (backend() == GpsIngestBackend::Epoll)
+        {
+            return m_fallback.bytes_read(port);
+        }
+        return port < m_ports.size() ? m_ports[port].bytes : 0;
+    }
+
+    /// @brief Get the number of fixes completed on a port.
+    uint64_t GpsUringIngest::fix_count(size_type port) const
+    {
+        if (backend() == GpsIngestBackend::Epoll)
+        {
+            return m_fallback.fix_count(port);
+        }
+        return port < m_ports.size() ? m_ports[port].fixes : 0;
+    }
+
+    /// @brief Queue a read of a port into a provided buffer. Multishot reads stay armed until they fail or run out of
+    /// buffers; single reads complete once.
+    ///
+    /// @return False if the submission queue is full and cannot be flushed.
+    bool GpsUringIngest::queue_read(size_type index)
+    {
+        struct io_uring_sqe *sqe = next_sqe();
+        if (!sqe)
+        {
+            return false;
+        }
+
+        Port &port = m_ports[index];
+        sqe->opcode = port.multishot ? op_read_multishot : (unsigned char)IORING_OP_READ;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->fd = port.fd;
+        sqe->off = port.multishot ? 0 : (uint64_t)-1; // -1 reads at the file position.
+        sqe->len = port.multishot ? 0 : (uint32_t)m_buffer_size;
+        sqe->buf_group = buffer_group;
+        sqe->user_data = index;
+        port.armed = true;
+        return true;
+    }
+
+    /// @brief Queue the cancellation of the reads of a port.
+    bool GpsUringIngest::queue_cancel(size_type index)
+    {
+        struct io_uring_sqe *sqe = next_sqe();
+        if (!sqe)
+        {
+            return false;
+        }
+
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = index;
+        sqe->user_data = ignored_user_data;
+        return true;
+    }
+
+    /// @brief Get a cleared submission queue entry, submitting the queue first if it is full.
+    ///
+    /// @return The entry, or nullptr if the queue cannot be flushed.
+    struct io_uring_sqe *GpsUringIngest::next_sqe()
+    {
+        unsigned tail = *m_sq_tail;
+        if (tail - load_acquire(m_sq_head) >= m_sq_entries)
+        {
+            if (enter(0, 0) < 0 || tail - load_acquire(m_sq_head) >= m_sq_entries)
+            {
+                return nullptr;
+            }
+        }
+
+        unsigned index = tail & *m_sq_mask;
+        struct io_uring_sqe *sqe = &m_sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        m_sq_array[index] = index;
+        store_release(m_sq_tail, tail + 1);
+        ++m_to_submit;
+        return sqe;
+    }
+
+    /// @brief Submit queued entries and wait for completions.
+    ///
+    /// @param min_complete Number of completions to wait for.
+    /// @param timeout_ms Longest time to wait, or -1 for no limit.
+    /// @return 0, or -1 if the call failed. A timeout or signal is not a failure.
+    int GpsUringIngest::enter(unsigned min_complete, int timeout_ms)
+    {
+        struct __kernel_timespec timeout;
+        timeout.tv_sec = timeout_ms / 1000;
+        timeout.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+
+        struct io_uring_getevents_arg arg;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = timeout_ms >= 0 ? (uint64_t)(uintptr_t)&timeout : 0;
+
+        unsigned flags = IORING_ENTER_EXT_ARG | (min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+        int result = io_uring_enter(m_ring_fd, m_to_submit, min_complete, flags, &arg, sizeof(arg));
+        if (result < 0)
+        {
+            return errno == ETIME || errno == EINTR || errno == EBUSY ? 0 : -1;
+        }
+
+        m_to_submit -= (unsigned)result < m_to_submit ? (unsigned)result : m_to_submit;
+        return 0;
+    }
+
+    /// @brief Handle every completion in the queue: parse filled buffers, hand them back, and re-arm or close ports.
+    void GpsUringIngest::reap()
+    {
+        unsigned head = *m_cq_head;
+        unsigned tail = load_acquire(m_cq_tail);
+        for (; head != tail; ++head)
+        {
+            const struct io_uring_cqe &cqe = m_cqes[head & *m_cq_mask];
+            if (cqe.user_data == ignored_user_data || cqe.user_data >= m_ports.size())
+            {
+                continue;
+            }
+
+            size_type index = (size_type)cqe.user_data;
+            Port &port = m_ports[index];
+            bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+            if (cqe.flags & IORING_CQE_F_BUFFER)
+            {
+                unsigned short id = (unsigned short)(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                const char *data = m_buffers + (size_t)id * m_buffer_size;
+                size_type size = cqe.res > 0 ? (size_type)cqe.res : 0;
+                size_type offset = 0;
+                while (port.fd >= 0 && offset < size)
+                {
+                    offset += port.gps.process_until_complete(data + offset, size - offset);
+                    if (port.gps.complete() && port.gps.good() && port.gps.message_type() == MessageType::GGA)
+                    {
+                        m_batch.push_back({index, port.gps.position_data()});
+                        ++port.fixes;
+                    }
+                }
+                port.bytes += port.fd >= 0 ? size : 0;
+                recycle_buffer(id);
+            }
+
+            if (!more)
+            {
+                port.armed = false;
+            }
+
+            if (port.fd < 0)
+            {
+                continue;
+            }
+
+            // End of file, hang up or failure close the port. Running out of buffers only needs a new read, since
+            // buffers are handed back as they are parsed.
+            if (cqe.res == 0 || (cqe.res < 0 && cqe.res != -ENOBUFS && cqe.res != -EAGAIN && cqe.res != -EINTR))
+            {
+                close_port(index);
+            }
+            else if (!port.armed)
+            {
+                queue_read(index);
+            }
+        }
+        store_release(m_cq_head, head);
+    }
+
+    /// @brief Hand a buffer back to the kernel.
+    void GpsUringIngest::recycle_buffer(unsigned short id)
+    {
+        // Index from the ring base: in C++ the header's flexible array member bufs does not start at offset 0. The
+        // tail overlays resv of the first entry.
+        struct io_uring_buf *ring = (struct io_uring_buf *)m_buffer_ring;
+        struct io_uring_buf &buffer = ring[m_buffer_tail & (m_buffer_count - 1)];
+        buffer.addr = (uint64_t)(uintptr_t)(m_buffers + (size_t)id * m_buffer_size);
+        buffer.len = (uint32_t)m_buffer_size;
+        buffer.bid = id;
+        ++m_buffer_tail;
+        store_release(&ring[0].resv, m_buffer_tail);
+    }
+
+    /// @brief Cancel the reads of a port and close its fd. Completions still in flight are ignored.
+    void GpsUringIngest::close_port(size_type index)
+    {
+        Port &port = m_ports[index];
+        if (port.fd < 0)
+        {
+            return;
+        }
+
+        if (port.armed)
+        {
+            queue_cancel(index);
+            enter(0, 0);
+        }
+        ::close(port.fd);
+        port.fd = -1;
+    }
+
+} // namespace gps
+} // namespace scottz0r
@@ -0,0 +1,151 @@
+/// @file io_uring ingest definitions.
+///
+/// This module reads serial ports, pipes and log files through io_uring, with the epoll loop of MicroGpsSerial.h as
+/// a fallback. Host only (Linux). liburing is not needed; the ring is driven through the raw system calls.
+///
+/// Reads select their buffers from a ring of provided buffers registered with the kernel. Ports that can be polled
+/// keep one multishot read outstanding, so the kernel completes a read whenever data arrives without a new submission.
+/// Log files are read with one outstanding read at a time. Completed buffers are parsed in place by the MicroGps of
+/// their port and handed back to the kernel. Without multishot reads (before Linux 6.7) every port uses single reads.
+/// If io_uring or provided buffer rings are not available, the same interface runs on GpsSerialIngest.
+#ifndef _SCOTTZ0R_GPS_URING_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_URING_INCLUDE_GUARD
+
+#include "MicroGpsSerial.h"
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace scottz0r
+{
+namespace gps
+{
+    /// Default number of provided buffers. Must be a power of two.
+    constexpr size_type uring_buffer_count = 64;
+
+    /// Default size of each provided buffer, in bytes.
+    constexpr size_type uring_buffer_size = 16384;
+
+    /// Number of submission queue entries.
+    constexpr size_type uring_queue_depth = 256;
+
+    /// @brief Event loop used by GpsUringIngest.
+    enum class GpsIngestBackend
+    {
+        Epoll,
+        Uring
+    };
+
+    /// @brief Event loop over serial ports and files, on io_uring when available.
+    class GpsUringIngest
+    {
+    public:
+        GpsUringIngest(GpsFixBatchHandler handler, void *context, bool allow_uring = true,
+                       size_type buffer_size = uring_buffer_size, size_type buffer_count = uring_buffer_count);
+
+        ~GpsUringIngest();
+
+        GpsUringIngest(const GpsUringIngest &) = delete;
+        GpsUringIngest &operator=(const GpsUringIngest &) = delete;
+
+        /// @brief Get the event loop in use.
+        inline GpsIngestBackend backend() const
+        {
+            return m_ring_fd >= 0 ? GpsIngestBackend::Uring : GpsIngestBackend::Epoll;
+        }
+
+        int add_port(const char *path, unsigned long baud = 0);
+
+        int add_fd(int fd);
+
+        bool remove_port(size_type port);
+
+        int poll(int timeout_ms);
+
+        void run(int timeout_ms = 100);
+
+        void stop();
+
+        size_type port_count() const;
+
+        bool is_open(size_type port) const;
+
+        uint64_t bytes_read(size_type port) const;
+
+        uint64_t fix_count(size_type port) const;
+
+    private:
+        /// @brief State of one port.
+        struct Port
+        {
+            int fd;
+            bool multishot;
+            bool armed;
+            uint64_t bytes;
+            uint64_t fixes;
+            MicroGps gps;
+        };
+
+        bool setup(size_type buffer_size, size_type buffer_count);
+
+        void teardown();
+
+        bool queue_read(size_type port);
+
+        bool queue_cancel(size_type port);
+
+        struct io_uring_sqe *next_sqe();
+
+        int enter(unsigned min_complete, int timeout_ms);
+
+        void reap();
+
+        void recycle_buffer(unsigned short id);
+
+        void close_port(size_type port);
+
+        GpsSerialIngest m_fallback;
+        GpsFixBatchHandler m_handler;
+        void *m_context;
+        std::vector<Port> m_ports;
+        std::vector<GpsPortFix> m_batch;
+        std::atomic<bool> m_stop;
+
+        // Ring state. m_ring_fd is -1 when running on the fallback.
+        int m_ring_fd;
+        bool m_has_multishot;
+        void *m_sq_ring;
+        size_t m_sq_ring_size;
+        void *m_cq_ring;
+        size_t m_cq_ring_size;
+        struct io_uring_sqe *m_sqes;
+        size_t m_sqes_size;
+        unsigned *m_sq_head;
+        unsigned *m_sq_tail;
+        unsigned *m_sq_mask;
+        unsigned *m_sq_array;
+        unsigned m_sq_entries;
+        unsigned *m_cq_head;
+        unsigned *m_cq_tail;
+        unsigned *m_cq_mask;
+        struct io_uring_cqe *m_cqes;
+        unsigned m_to_submit;
+
+        // Provided buffer ring.
+        void *m_buffer_ring;
+        size_t m_buffer_ring_size;
+        char *m_buffers;
+        size_t m_buffers_size;
+        size_type m_buffer_size;
+        size_type m_buffer_count;
+        unsigned short m_buffer_tail;
+    };
+
+} // namespace gps
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_URING_INCLUDE_GUARD
@@ -0,0 +1,251 @@
+#include "host/MicroGpsArchive.h"
+#include "MicroGpsFormat.h"
+#include "catch.hpp"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsArchive_tests
+{
+    using namespace scottz0r::gps;
+
+    /// Temporary file that is removed when the test ends.
+    class TempFile
+    {
+    public:
+        TempFile()
+        {
+            char path[] = "/tmp/MicroGpsArchive_XXXXXX";
+            int fd = mkstemp(path);
+            REQUIRE(fd >= 0);
+            ::close(fd);
+            m_path = path;
+        }
+
+        ~TempFile()
+        {
+            unlink(m_path.c_str());
+        }
+
+        const char *path() const
+        {
+            return m_path.c_str();
+        }
+
+    private:
+        std::string m_path;
+    };
+
+    static void append_sentence(std::string &log, const char *body)
+    {
+        char sentence[128];
+        size_type size = format_nmea_sentence(body, sentence, sizeof(sentence));
+        REQUIRE(size > 0);
+        log.append(sentence, size);
+    }
+
+    /// A receiver log of a vehicle driving at about 15 m/s, with GGA, RMC and GSA every second and GSV every 5 seconds.
+    static std::string make_log(unsigned seconds)
+    {
+        std::string log;
+        double latitude = 3854.8732;
+        double longitude = 9445.3680;
+        double altitude = 243.9;
+        unsigned noise = 12345;
+
+        for (unsigned i = 0; i < seconds; ++i)
+        {
+            unsigned t = 12 * 3600 + i;
+            unsigned hh = t / 3600;
+            unsigned mm = t / 60 % 60;
+            unsigned ss = t % 60;
+
+            // Small, repeatable jitter like a real receiver.
+            noise = noise * 1103515245 + 12345;
+            int jitter = (int)((noise >> 16) % 5) - 2;
+            latitude += 0.00481 + jitter * 0.00001;
+            longitude += 0.00302;
+            altitude += jitter * 0.1;
+
+            char body[100];
+            snprintf(body, sizeof(body), "GPGGA,%02u%02u%02u.00,%09.4f,N,%010.4f,W,1,%02u,0.9,%.1f,M,-30.1,M,,", hh, mm,
+                     ss, latitude, longitude, 9 + (i / 60) % 3, altitude);
+            append_sentence(log, body);
+
+            snprintf(body, sizeof(body), "GPRMC,%02u%02u%02u.00,A,%09.4f,N,%010.4f,W,%.1f,%.1f,191124,,,A", hh, mm, ss,
+                     latitude, longitude, 29.0 + jitter * 0.1, 32.0 + (i / 10) % 4);
+            append_sentence(log, body);
+
+            append_sentence(log, "GPGSA,A,3,04,05,09,12,24,25,29,,,,,,1.8,0.9,1.5");
+
+            if (i % 5 == 0)
+            {
+                snprintf(body, sizeof(body), "GPGSV,2,1,08,04,%02u,045,%02u,05,23,110,38,09,41,200,44,12,18,310,35",
+                         30 + (i / 60) % 10, 40 + jitter);
+                append_sentence(log, body);
+                append_sentence(log, "GPGSV,2,2,08,24,66,020,47,25,12,150,31,29,55,270,43,31,05,330,");
+            }
+        }
+
+        return log;
+    }
+
+    static std::vector<char> encode(const std::string &text)
+    {
+        std::vector<char> encoded;
+        GpsArchiveEncoder encoder;
+        encoder.encode(text.data(), (size_type)text.size(), encoded);
+        return encoded;
+    }
+
+    static std::string decode(const std::vector<char> &encoded)
+    {
+        std::string text;
+        GpsArchiveDecoder decoder;
+        REQUIRE(decoder.decode(encoded.data(), (size_type)encoded.size(), text));
+        return text;
+    }
+
+    TEST_CASE("GpsArchiveEncoder")
+    {
+        SECTION("It should compress a receiver log at least 10 times, byte exact")
+        {
+            std::string log = make_log(3600);
+            std::vector<char> encoded = encode(log);
+
+            REQUIRE(decode(encoded) == log);
+            REQUIRE(encoded.size() * 10 <= log.size());
+        }
+
+        SECTION("It should keep number formats exactly")
+        {
+            std::string log;
+            append_sentence(log, "GPGGA,000001.00,0100.0000,N,-0.50,E,,,007,1,1.,.5,-,-0.0");
+            append_sentence(log, "GPGGA,000002.00,0099.9990,N,-1.50,E,,,008,1,1.,.5,-,-0.0");
+            append_sentence(log, "GPGGA,000002.0,99.999,N,12.5,E,A,B,,1,1,5,-1,0");
+            append_sentence(log, "GPGGA,123456789012345.678,1234567890123456789,N,,E,,,,,,,,");
+
+            REQUIRE(decode(encode(log)) == log);
+        }
+
+        SECTION("It should store lines that are not good sentences verbatim")
+        {
+            std::string log;
+            append_sentence(log, "GPGGA,000001.00,0100.0000,N,00000.5000,E,1,08,0.9,10.0,M,,,");
+            log += "$GPGGA,000002.00,0100.0000,N,00000.5000,E,1,08,0.9,10.0,M,,,*00\r\n";
+            log += "$GPGGA,000002.00,0100.0000,N,00000.5000,E,1,08,0.9,10.0,M,,,*5e\r\n";
+            log += "$GPRMC,A,B\n";
+            log += "garbage without a sentence\r\n";
+            log += std::string("\xb5\x62\x01\x07\x00\n\r\n\n", 9);
+            log += "$PMTK001,220,3*30\n";
+            log += "$GPGGA,000003.00,0100.0";
+
+            REQUIRE(decode(encode(log)) == log);
+        }
+
+        SECTION("It should store sentences of more types than fit the type table verbatim")
+        {
+            std::string log;
+            char body[32];
+            for (unsigned i = 0; i < archive_max_types + 5; ++i)
+            {
+                snprintf(body, sizeof(body), "P%03u,%u,A", i, i * 7);
+                append_sentence(log, body);
+                append_sentence(log, "GPGSA,A,3,04,05,09,12,24,25,29,,,,,,1.8,0.9,1.5");
+            }
+
+            REQUIRE(decode(encode(log)) == log);
+        }
+
+        SECTION("It should reject truncated or corrupt input")
+        {
+            std::string log = make_log(10);
+            std::vector<char> encoded = encode(log);
+
+            std::string text;
+            GpsArchiveDecoder decoder;
+            REQUIRE_FALSE(decoder.decode(encoded.data(), 3, text));
+
+            const char bad_type[] = {(char)0x18};
+            decoder.reset();
+            REQUIRE_FALSE(decoder.decode(bad_type, sizeof(bad_type), text));
+
+            const char bad_header[] = {(char)0x02};
+            decoder.reset();
+            REQUIRE_FALSE(decoder.decode(bad_header, sizeof(bad_header), text));
+        }
+    }
+
+    TEST_CASE("GpsArchiveFile")
+    {
+        TempFile file;
+        const std::string log = make_log(600);
+
+        SECTION("It should write blocks and read any range back")
+        {
+            GpsArchiveWriter writer(4096);
+            REQUIRE(writer.open(file.path()));
+
+            // Write in odd sized pieces, so blocks do not line up with writes.
+            for (size_t offset = 0; offset < log.size(); offset += 1000)
+            {
+                size_t size = log.size() - offset < 1000 ? log.size() - offset : 1000;
+                REQUIRE(writer.write(log.data() + offset, (size_type)size));
+            }
+            REQUIRE(writer.raw_size() == log.size());
+            REQUIRE(writer.close());
+
+            GpsArchiveReader reader;
+            REQUIRE(reader.open(file.path()));
+            REQUIRE(reader.raw_size() == log.size());
+            REQUIRE(reader.block_count() > 10);
+
+            std::string text;
+            for (size_type index = 0; index < reader.block_count(); ++index)
+            {
+                GpsArchiveBlock block;
+                REQUIRE(reader.block(index, block));
+                REQUIRE(block.raw_size <= 4096);
+                REQUIRE(block.raw_offset == text.size());
+
+                // Blocks end at line ends.
+                REQUIRE(reader.read_block(index, text));
+                REQUIRE(text.back() == '\n');
+            }
+            REQUIRE(text == log);
+
+            uint64_t offset = log.size() / 2 + 17;
+            REQUIRE(reader.find_block(offset) < reader.block_count());
+            REQUIRE(reader.find_block(log.size()) == reader.block_count());
+
+            text.clear();
+            REQUIRE(reader.read(offset, 10000, text));
+            REQUIRE(text == log.substr((size_t)offset, 10000));
+
+            REQUIRE_FALSE(reader.read(log.size() - 10, 11, text));
+        }
+
+        SECTION("It should reject files that are not complete archives")
+        {
+            GpsArchiveWriter writer(4096);
+            REQUIRE(writer.open(file.path()));
+            REQUIRE(writer.write(log.data(), (size_type)log.size()));
+            REQUIRE(writer.close());
+            REQUIRE(truncate(file.path(), 2000) == 0);
+
+            GpsArchiveReader reader;
+            REQUIRE_FALSE(reader.open(file.path()));
+            REQUIRE_FALSE(reader.open("/nonexistent/archive"));
+
+            GpsArchiveWriter small(16);
+            REQUIRE_FALSE(small.open(file.path()));
+        }
+    }
+
+} // namespace MicroGpsArchive_tests
+} // namespace scottz0r
@@ -0,0 +1,118 @@
+#include "MicroGpsBatch.h"
+#include "catch.hpp"
+#include <stdint.h>
+#include <string>
+
+namespace scottz0r
+{
+namespace MicroGpsBatch_tests
+{
+    using namespace scottz0r::gps;
+
+    const std::string gga_0("$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*5B\r\n");
+    const std::string gga_1("$GPGGA,152541.096,,,,,0,00,,,M,,M,,*71\r\n");
+    const std::string rmc_0("$GPRMC,153621.000,A,3854.8732,N,09445.3680,W,12.34,054.70,191124,020.3,E,A*2D\r\n");
+
+    /// Returns true if the pointer is aligned to the batch alignment.
+    static bool is_aligned(const void *p)
+    {
+        return ((uintptr_t)p % batch_alignment) == 0;
+    }
+
+    TEST_CASE("GpsPositionBatch")
+    {
+        SECTION("It should store parsed positions in aligned columns")
+        {
+            const std::string log = gga_0 + rmc_0 + gga_1;
+
+            MicroGps gps;
+            GpsPositionBatch<16> batch;
+
+            REQUIRE(fill_batch(batch, gps, log.data(), (size_type)log.size()) == log.size());
+            REQUIRE(batch.size() == 2);
+
+            REQUIRE(batch.time_ms()[0] == 56181000);
+            REQUIRE(batch.time_ms()[1] == 55541096);
+            REQUIRE(batch.latitude()[0] == Approx(38.0f + (54.8732f / 60.0f)));
+            REQUIRE(batch.longitude()[0] == Approx(-1.0f * (94.0f + (45.3680f / 60.f))));
+            REQUIRE(batch.fix_quality()[0] == 1);
+            REQUIRE(batch.number_satellites()[0] == 4);
+            REQUIRE(batch.horizontal_dilution()[0] == Approx(2.07f));
+            REQUIRE(batch.altitude_msl()[0] == Approx(243.9f));
+            REQUIRE(batch.geoid_height()[0] == Approx(-30.1f));
+
+            REQUIRE(is_aligned(batch.time_ms()));
+            REQUIRE(is_aligned(batch.latitude()));
+            REQUIRE(is_aligned(batch.longitude()));
+            REQUIRE(is_aligned(batch.fix_quality()));
+            REQUIRE(is_aligned(batch.number_satellites()));
+            REQUIRE(is_aligned(batch.horizontal_dilution()));
+            REQUIRE(is_aligned(batch.altitude_msl()));
+            REQUIRE(is_aligned(batch.geoid_height()));
+        }
+
+        SECTION("It should mark empty fields in the validity bitmaps")
+        {
+            const std::string log = gga_0 + gga_1;
+
+            MicroGps gps;
+            GpsPositionBatch<16> batch;
+            fill_batch(batch, gps, log.data(), (size_type)log.size());
+
+            for (unsigned field = 0; field < batch_columns; ++field)
+            {
+                REQUIRE(batch.is_valid((PositionField)field, 0));
+            }
+
+            REQUIRE(batch.is_valid(PositionField::Time, 1));
+            REQUIRE_FALSE(batch.is_valid(PositionField::Latitude, 1));
+            REQUIRE_FALSE(batch.is_valid(PositionField::Longitude, 1));
+            REQUIRE(batch.is_valid(PositionField::FixQuality, 1));
+            REQUIRE(batch.is_valid(PositionField::Satellites, 1));
+            REQUIRE_FALSE(batch.is_valid(PositionField::Dilution, 1));
+            REQUIRE_FALSE(batch.is_valid(PositionField::Altitude, 1));
+            REQUIRE_FALSE(batch.is_valid(PositionField::GeoidHeight, 1));
+            REQUIRE(batch.validity(PositionField::Latitude)[0] == 0x01);
+            REQUIRE(batch.latitude()[1] == 0.0f);
+        }
+
+        SECTION("It should stop when full and resume after clear")
+        {
+            std::string log;
+            for (int i = 0; i < 5; ++i)
+            {
+                log += gga_0;
+            }
+
+            MicroGps gps;
+            GpsPositionBatch<3> batch;
+
+            size_type consumed = fill_batch(batch, gps, log.data(), (size_type)log.size());
+            REQUIRE(batch.full());
+            REQUIRE(batch.size() == 3);
+            REQUIRE(consumed == 3 * gga_0.size());
+            REQUIRE_FALSE(batch.append(gps.position_data()));
+
+            batch.clear();
+            REQUIRE(batch.size() == 0);
+            REQUIRE_FALSE(batch.is_valid(PositionField::Time, 0));
+
+            REQUIRE(fill_batch(batch, gps, log.data() + consumed, (size_type)log.size() - consumed) ==
+                    log.size() - consumed);
+            REQUIRE(batch.size() == 2);
+        }
+
+        SECTION("It should use the representation of the parser policy")
+        {
+            BasicMicroGps<MicroGpsMinimalPolicy> gps;
+            BasicGpsPositionBatch<8, FixedNumeric> batch;
+
+            fill_batch(batch, gps, gga_0.data(), (size_type)gga_0.size());
+            REQUIRE(batch.size() == 1);
+            REQUIRE(batch.latitude()[0] == 389145533);
+            REQUIRE(batch.altitude_msl()[0] == 243900);
+        }
+    }
+
+} // namespace MicroGpsBatch_tests
+} // namespace scottz0r
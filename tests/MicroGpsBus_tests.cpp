@@ -0,0 +1,201 @@
+#include "host/MicroGpsBus.h"
+#include "catch.hpp"
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsBus_tests
+{
+    using namespace scottz0r::gps;
+
+    /// Fix whose fields are all derived from n, so a torn copy is detected.
+    static GpsPosition make_fix(uint64_t n)
+    {
+        GpsPosition position = {};
+        position.time_ms = (uint32_t)n;
+        position.number_satellites = (unsigned char)n;
+        position.latitude = (float)(n % 90);
+        position.longitude = (float)(n % 180);
+        position.altitude_msl = (float)n;
+        return position;
+    }
+
+    static void require_fix(const GpsBusRecord &record)
+    {
+        REQUIRE(record.position.time_ms == (uint32_t)record.sequence);
+        REQUIRE(record.position.number_satellites == (unsigned char)record.sequence);
+        REQUIRE(record.position.latitude == (float)(record.sequence % 90));
+        REQUIRE(record.position.longitude == (float)(record.sequence % 180));
+        REQUIRE(record.position.altitude_msl == (float)record.sequence);
+    }
+
+    static std::string bus_name()
+    {
+        return "/MicroGpsBus_tests_" + std::to_string(getpid());
+    }
+
+    TEST_CASE("GpsFixBus")
+    {
+        std::string name = bus_name();
+        GpsFixBusWriter writer;
+        REQUIRE(writer.open(name.c_str(), 16));
+
+        GpsFixBusReader reader;
+        REQUIRE(reader.open(name.c_str()));
+
+        SECTION("It should deliver records in order to every reader")
+        {
+            GpsFixBusReader other;
+            REQUIRE(other.open(name.c_str()));
+
+            for (uint64_t n = 1; n <= 10; ++n)
+            {
+                REQUIRE(writer.publish(make_fix(n), (uint32_t)(n % 3)) == n);
+            }
+            REQUIRE(reader.published() == 10);
+
+            for (GpsFixBusReader *r : {&reader, &other})
+            {
+                GpsBusRecord record;
+                for (uint64_t n = 1; n <= 10; ++n)
+                {
+                    REQUIRE(r->read(record));
+                    REQUIRE(record.sequence == n);
+                    REQUIRE(record.source == n % 3);
+                    require_fix(record);
+                }
+                REQUIRE_FALSE(r->read(record));
+                REQUIRE(r->lost() == 0);
+            }
+        }
+
+        SECTION("It should start new readers at the next record and rewind to the oldest")
+        {
+            for (uint64_t n = 1; n <= 40; ++n)
+            {
+                writer.publish(make_fix(n));
+            }
+
+            GpsFixBusReader late;
+            REQUIRE(late.open(name.c_str()));
+            GpsBusRecord record;
+            REQUIRE_FALSE(late.read(record));
+
+            writer.publish(make_fix(41));
+            REQUIRE(late.read(record));
+            REQUIRE(record.sequence == 41);
+
+            // 16 slots, less the one the writer may be filling.
+            late.rewind();
+            REQUIRE(late.read(record));
+            REQUIRE(record.sequence == 41 - 14);
+            require_fix(record);
+        }
+
+        SECTION("It should detect overrun and resume at the oldest record")
+        {
+            GpsBusRecord record;
+            writer.publish(make_fix(1));
+            REQUIRE(reader.read(record));
+
+            for (uint64_t n = 2; n <= 100; ++n)
+            {
+                writer.publish(make_fix(n));
+            }
+
+            REQUIRE(reader.read(record));
+            REQUIRE(record.sequence == 100 - 14);
+            REQUIRE(reader.lost() == record.sequence - 2);
+            require_fix(record);
+
+            uint64_t count = 1;
+            while (reader.read(record))
+            {
+                require_fix(record);
+                ++count;
+            }
+            REQUIRE(record.sequence == 100);
+            REQUIRE(count == 15);
+        }
+
+        SECTION("It should never hand out a torn record to a concurrent reader")
+        {
+            constexpr uint64_t count = 200000;
+            std::thread publisher([&]() {
+                for (uint64_t n = 1; n <= count; ++n)
+                {
+                    writer.publish(make_fix(n));
+                }
+            });
+
+            GpsBusRecord record;
+            uint64_t last = 0;
+            uint64_t read = 0;
+            while (last < count)
+            {
+                if (reader.read(record))
+                {
+                    REQUIRE(record.sequence > last);
+                    require_fix(record);
+                    last = record.sequence;
+                    ++read;
+                }
+            }
+            publisher.join();
+            REQUIRE(read + reader.lost() == count);
+        }
+
+        SECTION("It should share records with another process")
+        {
+            pid_t child = fork();
+            REQUIRE(child >= 0);
+            if (child == 0)
+            {
+                for (uint64_t n = 1; n <= 8; ++n)
+                {
+                    writer.publish(make_fix(n), 7);
+                }
+                _exit(0);
+            }
+
+            int status = 0;
+            REQUIRE(waitpid(child, &status, 0) == child);
+            REQUIRE(WIFEXITED(status));
+
+            GpsBusRecord record;
+            for (uint64_t n = 1; n <= 8; ++n)
+            {
+                REQUIRE(reader.read(record));
+                REQUIRE(record.sequence == n);
+                REQUIRE(record.source == 7);
+                require_fix(record);
+            }
+        }
+
+        SECTION("It should reject missing buses")
+        {
+            GpsFixBusReader missing;
+            REQUIRE_FALSE(missing.open("/MicroGpsBus_tests_missing"));
+            GpsBusRecord record;
+            REQUIRE_FALSE(missing.read(record));
+
+            GpsFixBusWriter invalid;
+            REQUIRE_FALSE(invalid.open((name + "_invalid").c_str(), 12));
+            REQUIRE_FALSE(invalid.is_open());
+            REQUIRE(invalid.publish(make_fix(1)) == 0);
+        }
+
+        SECTION("It should remove the name when the writer closes")
+        {
+            writer.close();
+            GpsFixBusReader after;
+            REQUIRE_FALSE(after.open(name.c_str()));
+        }
+    }
+
+} // namespace MicroGpsBus_tests
+} // namespace scottz0r
@@ -0,0 +1,115 @@
+#include "MicroGpsConfig.h"
+#include "MicroUbx.h"
+#include "catch.hpp"
+#include <string>
+
+namespace scottz0r
+{
+namespace MicroGpsConfig_tests
+{
+    using namespace std::string_literals;
+    using namespace scottz0r::gps;
+    using MessageType = MicroGps::MessageType;
+
+    TEST_CASE("encode_pmtk_output")
+    {
+        SECTION("it should enable the decoded messages")
+        {
+            MicroGps gps;
+            char buffer[64];
+
+            size_type size = encode_pmtk_output(gps.decoded_messages(), 1, buffer, sizeof(buffer));
+
+            REQUIRE(buffer == "$PMTK314,0,1,0,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0*29\r\n"s);
+            REQUIRE(size == 51);
+        }
+
+        SECTION("it should enable GSV with a satellite table")
+        {
+            GpsSatelliteTable table;
+            MicroGps gps;
+            gps.set_satellite_table(&table);
+            char buffer[64];
+
+            REQUIRE(encode_pmtk_output(gps.decoded_messages(), 1, buffer, sizeof(buffer)) == 51);
+            REQUIRE(buffer == "$PMTK314,0,1,0,1,1,1,0,0,0,0,0,0,0,0,0,0,0,0,0*28\r\n"s);
+        }
+
+        SECTION("it should error bad input")
+        {
+            char buffer[64];
+            REQUIRE(encode_pmtk_output(0, 6, buffer, sizeof(buffer)) == 0);
+            REQUIRE(encode_pmtk_output(0, 1, buffer, 16) == 0);
+        }
+    }
+
+    TEST_CASE("encode_pmtk_fix_interval")
+    {
+        char buffer[32];
+
+        REQUIRE(encode_pmtk_fix_interval(1000, buffer, sizeof(buffer)) == 18);
+        REQUIRE(buffer == "$PMTK220,1000*1F\r\n"s);
+
+        REQUIRE(encode_pmtk_fix_interval(100, buffer, sizeof(buffer)) == 17);
+        REQUIRE(buffer == "$PMTK220,100*2F\r\n"s);
+
+        REQUIRE(encode_pmtk_fix_interval(50, buffer, sizeof(buffer)) == 0);
+    }
+
+    TEST_CASE("encode_ubx_cfg")
+    {
+        SECTION("it should encode CFG-MSG")
+        {
+            char buffer[16];
+            REQUIRE(encode_ubx_cfg_msg(0xF0, 0x00, 0, buffer, sizeof(buffer)) == 11);
+            REQUIRE(std::string(buffer, 11) == "\xB5\x62\x06\x01\x03\x00\xF0\x00\x00\xFA\x0F"s);
+        }
+
+        SECTION("it should encode CFG-RATE")
+        {
+            char buffer[16];
+            REQUIRE(encode_ubx_cfg_rate(1000, 1, 1, buffer, sizeof(buffer)) == 14);
+            REQUIRE(std::string(buffer, 14) == "\xB5\x62\x06\x08\x06\x00\xE8\x03\x01\x00\x01\x00\x01\x39"s);
+        }
+
+        SECTION("it should produce frames MicroUbx accepts")
+        {
+            char buffer[16];
+            size_type size = encode_ubx_frame(0x05, 0x01, "\x06\x01", 2, buffer, sizeof(buffer));
+            REQUIRE(size == 10);
+
+            MicroUbx ubx;
+            REQUIRE(ubx.process_until_complete(buffer, size) == size);
+            REQUIRE(ubx.good());
+            REQUIRE(ubx.message_type() == MicroUbx::MessageType::AckAck);
+            REQUIRE(ubx.ack_data().command == 0x0601);
+            REQUIRE(ubx.ack_data().status == AckStatus::Succeeded);
+        }
+
+        SECTION("it should set NMEA output rates")
+        {
+            char buffer[66];
+            unsigned messages = MicroGps::message_bit(MessageType::GGA) | MicroGps::message_bit(MessageType::RMC);
+
+            REQUIRE(encode_ubx_nmea_output(messages, 1, buffer, sizeof(buffer)) == 66);
+
+            // Rate byte of each CFG-MSG: GGA, GLL, GSA, GSV, RMC, VTG.
+            REQUIRE(buffer[0 * 11 + 8] == 1);
+            REQUIRE(buffer[1 * 11 + 8] == 0);
+            REQUIRE(buffer[2 * 11 + 8] == 0);
+            REQUIRE(buffer[3 * 11 + 8] == 0);
+            REQUIRE(buffer[4 * 11 + 8] == 1);
+            REQUIRE(buffer[5 * 11 + 8] == 0);
+
+            REQUIRE(encode_ubx_nmea_output(messages, 1, buffer, 65) == 0);
+        }
+
+        SECTION("it should error small buffer")
+        {
+            char buffer[8];
+            REQUIRE(encode_ubx_cfg_msg(0xF0, 0x00, 0, buffer, sizeof(buffer)) == 0);
+        }
+    }
+
+} // namespace MicroGpsConfig_tests
+} // namespace scottz0r
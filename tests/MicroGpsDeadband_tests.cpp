@@ -0,0 +1,102 @@
+#include "MicroGpsDeadband.h"
+#include "catch.hpp"
+
+namespace scottz0r
+{
+namespace MicroGpsDeadband_tests
+{
+    using namespace scottz0r::gps;
+
+    constexpr unsigned char all_fields = 0xFF;
+
+    static GpsPosition make_fix(float latitude, float longitude, unsigned char satellites = 8)
+    {
+        GpsPosition position = {};
+        position.fix_quality = 1;
+        position.number_satellites = satellites;
+        position.fields = all_fields;
+        position.latitude = latitude;
+        position.longitude = longitude;
+        return position;
+    }
+
+    TEST_CASE("GpsDeadbandFilter")
+    {
+        SECTION("It should drop a stationary receiver until the heartbeat")
+        {
+            GpsDeadbandFilter filter(5, 10000);
+            REQUIRE(filter.update(make_fix(38.9f, -94.7f), 0));
+
+            // About 1 m of jitter around the first fix.
+            unsigned forwarded = 0;
+            for (unsigned long now = 1000; now < 10000; now += 1000)
+            {
+                float jitter = (now / 1000 % 2 ? 1 : -1) * 0.00001f;
+                forwarded += filter.update(make_fix(38.9f + jitter, -94.7f - jitter), now);
+            }
+            REQUIRE(forwarded == 0);
+            REQUIRE(filter.suppressed() == 9);
+
+            REQUIRE(filter.update(make_fix(38.9f, -94.7f), 10000));
+            REQUIRE_FALSE(filter.update(make_fix(38.9f, -94.7f), 11000));
+        }
+
+        SECTION("It should forward movement beyond the threshold from the last forwarded fix")
+        {
+            GpsDeadbandFilter filter(5, 0);
+            REQUIRE(filter.update(make_fix(0, 0), 0));
+
+            // 2 m steps north: every third step is more than 5 m from the last forwarded fix.
+            unsigned forwarded = 0;
+            for (int step = 1; step <= 30; ++step)
+            {
+                if (filter.update(make_fix(step * 2 / meters_per_degree, 0), step))
+                {
+                    ++forwarded;
+                    REQUIRE(filter.last().latitude == step * 2 / meters_per_degree);
+                }
+            }
+            REQUIRE(forwarded == 10);
+
+            // Movement east is scaled by the latitude.
+            GpsDeadbandFilter north(5, 0);
+            REQUIRE(north.update(make_fix(60, 10), 0));
+            REQUIRE_FALSE(north.update(make_fix(60, 10 + 8 / meters_per_degree), 1));
+            REQUIRE(north.update(make_fix(60, 10 + 12 / meters_per_degree), 2));
+        }
+
+        SECTION("It should forward changes of quality, satellites and coordinates")
+        {
+            GpsDeadbandFilter filter;
+            REQUIRE(filter.update(make_fix(10, 20), 0));
+            REQUIRE_FALSE(filter.update(make_fix(10, 20), 1));
+            REQUIRE(filter.update(make_fix(10, 20, 9), 2));
+            REQUIRE_FALSE(filter.update(make_fix(10, 20, 9), 3));
+
+            GpsPosition degraded = make_fix(10, 20, 9);
+            degraded.fix_quality = 2;
+            REQUIRE(filter.update(degraded, 4));
+
+            GpsPosition lost = degraded;
+            lost.fields &= ~position_field_bit(PositionField::Latitude);
+            REQUIRE(filter.update(lost, 5));
+            REQUIRE_FALSE(filter.update(lost, 6));
+            REQUIRE(filter.update(degraded, 7));
+        }
+
+        SECTION("It should handle a wrapping clock and reset")
+        {
+            GpsDeadbandFilter filter(5, 1000);
+            unsigned long start = (unsigned long)-500;
+            REQUIRE(filter.update(make_fix(1, 1), start));
+            REQUIRE_FALSE(filter.update(make_fix(1, 1), start + 999));
+            REQUIRE(filter.update(make_fix(1, 1), start + 1000));
+
+            filter.reset();
+            REQUIRE(filter.suppressed() == 0);
+            REQUIRE(filter.update(make_fix(1, 1), 0));
+        }
+    }
+
+} // namespace MicroGpsDeadband_tests
+} // namespace scottz0r
@@ -0,0 +1,174 @@
+#include "MicroGpsDemux.h"
+#include "catch.hpp"
+#include <string>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsDemux_tests
+{
+    using namespace scottz0r::gps;
+    using FrameType = GpsFrameDemux::FrameType;
+
+    const std::string gga("$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*5B\r\n");
+
+    /// Build a RTCM3 frame around a payload, with a correct CRC-24Q.
+    static std::string make_rtcm(const std::string &payload)
+    {
+        std::string frame;
+        frame.push_back((char)0xD3);
+        frame.push_back((char)((payload.size() >> 8) & 0x03));
+        frame.push_back((char)(payload.size() & 0xFF));
+        frame += payload;
+
+        uint32_t crc = _detail::crc24q(frame.data(), (size_type)frame.size());
+        frame.push_back((char)(crc >> 16));
+        frame.push_back((char)(crc >> 8));
+        frame.push_back((char)crc);
+        return frame;
+    }
+
+    /// UBX NAV-DOP frame with zero dilutions.
+    static std::string make_ubx()
+    {
+        std::string body("\x01\x04\x12", 3);
+        body.push_back('\0');
+        body += std::string(18, '\0');
+
+        unsigned ck_a = 0;
+        unsigned ck_b = 0;
+        for (const auto &c : body)
+        {
+            ck_a = (ck_a + (unsigned char)c) & 0xFF;
+            ck_b = (ck_b + ck_a) & 0xFF;
+        }
+
+        return std::string("\xB5\x62") + body + (char)ck_a + (char)ck_b;
+    }
+
+    /// Collects forwarded frames.
+    static void collect(const char *data, size_type size, void *context)
+    {
+        static_cast<std::vector<std::string> *>(context)->emplace_back(data, size);
+    }
+
+    TEST_CASE("GpsFrameDemux")
+    {
+        SECTION("It should route interleaved frames")
+        {
+            // RTCM payload containing NMEA-like text must not reach the NMEA parser.
+            const std::string rtcm = make_rtcm("$GPGGA,\n\xB5\x62 binary\xD3");
+            const std::string ubx = make_ubx();
+            const std::string stream = "junk" + rtcm + gga + ubx + rtcm + gga;
+
+            MicroGps gps;
+            MicroUbx ubx_parser;
+            GpsFrameDemux demux(&gps, &ubx_parser);
+
+            std::vector<std::string> forwarded;
+            char buffer[1029];
+            demux.set_rtcm_handler(collect, &forwarded, buffer, sizeof(buffer));
+
+            std::vector<FrameType> frames;
+            for (const auto &c : stream)
+            {
+                if (demux.process(c))
+                {
+                    REQUIRE(demux.good());
+                    frames.push_back(demux.frame_type());
+                }
+            }
+
+            REQUIRE(frames.size() == 5);
+            REQUIRE(frames[0] == FrameType::Rtcm3);
+            REQUIRE(frames[1] == FrameType::Nmea);
+            REQUIRE(frames[2] == FrameType::Ubx);
+            REQUIRE(frames[3] == FrameType::Rtcm3);
+            REQUIRE(frames[4] == FrameType::Nmea);
+
+            REQUIRE(forwarded.size() == 2);
+            REQUIRE(forwarded[0] == rtcm);
+            REQUIRE(forwarded[1] == rtcm);
+
+            REQUIRE(gps.good());
+            REQUIRE(gps.position_data().number_satellites == 4);
+            REQUIRE(ubx_parser.message_type() == MicroUbx::MessageType::NavDop);
+        }
+
+        SECTION("It should forward whole RTCM frames in place")
+        {
+            const std::string rtcm = make_rtcm(std::string(300, '$'));
+            const std::string stream = rtcm + gga;
+
+            MicroGps gps;
+            GpsFrameDemux demux(&gps, nullptr);
+
+            std::vector<std::string> forwarded;
+            demux.set_rtcm_handler(collect, &forwarded, nullptr, 0);
+
+            size_type offset = demux.process_until_complete(stream.data(), (size_type)stream.size());
+            REQUIRE(offset == rtcm.size());
+            REQUIRE(demux.frame_type() == FrameType::Rtcm3);
+            REQUIRE(demux.good());
+            REQUIRE(forwarded.size() == 1);
+            REQUIRE(forwarded[0] == rtcm);
+
+            offset += demux.process_until_complete(stream.data() + offset, (size_type)stream.size() - offset);
+            REQUIRE(offset == stream.size());
+            REQUIRE(demux.frame_type() == FrameType::Nmea);
+            REQUIRE(gps.good());
+        }
+
+        SECTION("It should not forward RTCM frames with a bad CRC")
+        {
+            std::string rtcm = make_rtcm("payload");
+            rtcm.back() = (char)(rtcm.back() ^ 0x01);
+
+            GpsFrameDemux demux(nullptr, nullptr);
+            std::vector<std::string> forwarded;
+            char buffer[64];
+            demux.set_rtcm_handler(collect, &forwarded, buffer, sizeof(buffer));
+
+            bool result = false;
+            for (const auto &c : rtcm)
+            {
+                result = demux.process(c);
+            }
+
+            REQUIRE(result);
+            REQUIRE(demux.bad());
+            REQUIRE(forwarded.empty());
+        }
+
+        SECTION("It should end NMEA sentences interrupted by binary frames")
+        {
+            const std::string stream = gga.substr(0, 30) + make_ubx() + gga;
+
+            MicroGps gps;
+            MicroUbx ubx_parser;
+            GpsFrameDemux demux(&gps, &ubx_parser);
+
+            std::vector<FrameType> frames;
+            for (const auto &c : stream)
+            {
+                if (demux.process(c))
+                {
+                    frames.push_back(demux.frame_type());
+                }
+            }
+
+            REQUIRE(frames.size() == 2);
+            REQUIRE(frames[0] == FrameType::Ubx);
+            REQUIRE(frames[1] == FrameType::Nmea);
+            REQUIRE(gps.good());
+        }
+    }
+
+    TEST_CASE("_detail::crc24q")
+    {
+        REQUIRE(_detail::crc24q("123456789", 9) == 0xCDE703);
+        REQUIRE(_detail::crc24q("", 0) == 0);
+    }
+
+} // namespace MicroGpsDemux_tests
+} // namespace scottz0r
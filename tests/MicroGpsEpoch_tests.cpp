@@ -0,0 +1,196 @@
+#include "MicroGpsEpoch.h"
+#include "catch.hpp"
+#include <string>
+
+namespace scottz0r
+{
+namespace MicroGpsEpoch_tests
+{
+    using namespace scottz0r::gps;
+    using MessageType = MicroGps::MessageType;
+
+    const std::string gga_0("$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*5B\r\n");
+    const std::string rmc_0("$GPRMC,153621.000,A,3854.8732,N,09445.3680,W,12.34,054.70,191124,020.3,E,A*2D\r\n");
+    const std::string gga_1("$GPGGA,152541.096,,,,,0,00,,,M,,M,,*71\r\n");
+
+    /// Feed a whole sentence to the parser and return the result of the last character.
+    static bool feed(MicroGps &gps, const std::string &msg)
+    {
+        bool result = false;
+        for (const auto &c : msg)
+        {
+            result = gps.process(c);
+        }
+        return result;
+    }
+
+    TEST_CASE("GpsEpochAssembler")
+    {
+        SECTION("It should emit once when all required sentences are merged")
+        {
+            MicroGps gps;
+            GpsEpochAssembler epochs;
+
+            REQUIRE(feed(gps, rmc_0));
+            REQUIRE_FALSE(epochs.update(gps, 0));
+            REQUIRE(epochs.pending());
+
+            REQUIRE(feed(gps, gga_0));
+            REQUIRE(epochs.update(gps, 10));
+            REQUIRE_FALSE(epochs.pending());
+
+            const auto &epoch = epochs.epoch();
+            REQUIRE(epoch.time_ms == 56181000);
+            REQUIRE(epoch.sentences ==
+                    (MicroGps::message_bit(MessageType::GGA) | MicroGps::message_bit(MessageType::RMC)));
+            REQUIRE(epoch.position.number_satellites == 4);
+            REQUIRE(epoch.navigation.speed_knots == 1234);
+
+            // A repeated sentence for the emitted epoch must not emit again.
+            REQUIRE(feed(gps, gga_0));
+            REQUIRE_FALSE(epochs.update(gps, 20));
+            REQUIRE_FALSE(epochs.pending());
+            REQUIRE_FALSE(epochs.poll(5000));
+        }
+
+        SECTION("It should emit on a timestamp boundary")
+        {
+            MicroGps gps;
+            GpsEpochAssembler epochs;
+
+            REQUIRE(feed(gps, gga_0));
+            REQUIRE_FALSE(epochs.update(gps, 0));
+
+            REQUIRE(feed(gps, gga_1));
+            REQUIRE(epochs.update(gps, 10));
+            REQUIRE(epochs.epoch().time_ms == 56181000);
+            REQUIRE(epochs.epoch().sentences == MicroGps::message_bit(MessageType::GGA));
+
+            // The new sentence starts the next epoch.
+            REQUIRE(epochs.pending());
+        }
+
+        SECTION("It should emit incomplete epochs on timeout")
+        {
+            MicroGps gps;
+            GpsEpochAssembler epochs(MicroGps::message_bit(MessageType::GGA) |
+                                         MicroGps::message_bit(MessageType::RMC),
+                                     500);
+
+            REQUIRE(feed(gps, rmc_0));
+            REQUIRE_FALSE(epochs.update(gps, 1000));
+
+            REQUIRE_FALSE(epochs.poll(1499));
+            REQUIRE(epochs.poll(1500));
+            REQUIRE(epochs.epoch().sentences == MicroGps::message_bit(MessageType::RMC));
+            REQUIRE_FALSE(epochs.poll(3000));
+        }
+
+        SECTION("It should hold a complete epoch found on a boundary until the next call")
+        {
+            MicroGps gps;
+            GpsEpochAssembler epochs(MicroGps::message_bit(MessageType::GGA));
+
+            REQUIRE(feed(gps, rmc_0));
+            REQUIRE_FALSE(epochs.update(gps, 0));
+
+            REQUIRE(feed(gps, gga_1));
+            REQUIRE(epochs.update(gps, 10));
+            REQUIRE(epochs.epoch().time_ms == 56181000);
+
+            REQUIRE(epochs.poll(11));
+            REQUIRE(epochs.epoch().time_ms == 55541096);
+        }
+
+        SECTION("It should merge GSA into the open epoch")
+        {
+            const std::string gsa("$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n");
+
+            MicroGps gps;
+            GpsEpochAssembler epochs(MicroGps::message_bit(MessageType::GGA) |
+                                     MicroGps::message_bit(MessageType::RMC) |
+                                     MicroGps::message_bit(MessageType::GSA));
+
+            // No open epoch, so the GSA is a straggler.
+            REQUIRE(feed(gps, gsa));
+            REQUIRE_FALSE(epochs.update(gps, 0));
+            REQUIRE_FALSE(epochs.pending());
+
+            REQUIRE(feed(gps, rmc_0));
+            REQUIRE_FALSE(epochs.update(gps, 0));
+            REQUIRE(feed(gps, gga_0));
+            REQUIRE_FALSE(epochs.update(gps, 0));
+            REQUIRE(feed(gps, gsa));
+            REQUIRE(epochs.update(gps, 0));
+
+            REQUIRE(epochs.epoch().time_ms == 56181000);
+            REQUIRE(epochs.epoch().solution.pdop == 250);
+            REQUIRE(is_prn_active(epochs.epoch().solution, 24));
+        }
+
+        SECTION("It should separate fixes within the same second")
+        {
+            const std::string gga_a("$GPGGA,153621.100,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*5A\r\n");
+            const std::string gga_b("$GPGGA,153621.200,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*59\r\n");
+
+            MicroGps gps;
+            GpsEpochAssembler epochs(MicroGps::message_bit(MessageType::GGA));
+
+            REQUIRE(feed(gps, gga_a));
+            REQUIRE(epochs.update(gps, 0));
+            REQUIRE(epochs.epoch().time_ms == 56181100);
+
+            REQUIRE(feed(gps, gga_b));
+            REQUIRE(epochs.update(gps, 100));
+            REQUIRE(epochs.epoch().time_ms == 56181200);
+        }
+
+        SECTION("It should keep emitting epochs of sentences without a time")
+        {
+            const std::string gga_untimed("$GPGGA,,,,,,0,00,99.99,,,,,,*48\r\n");
+            const std::string rmc_untimed("$GPRMC,,V,,,,,,,,,,N*53\r\n");
+
+            MicroGps gps;
+            GpsEpochAssembler epochs;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                REQUIRE(feed(gps, gga_untimed));
+                REQUIRE_FALSE(gps.has_time());
+                REQUIRE_FALSE(epochs.update(gps, i * 1000));
+                REQUIRE(feed(gps, rmc_untimed));
+                REQUIRE(epochs.update(gps, i * 1000));
+                REQUIRE(epochs.epoch().time_ms == 0);
+            }
+
+            // A message type that repeats ends an untimed epoch, and a timed sentence ends it too.
+            GpsEpochAssembler gga_rmc;
+            REQUIRE(feed(gps, gga_untimed));
+            REQUIRE_FALSE(gga_rmc.update(gps, 0));
+            REQUIRE(feed(gps, gga_untimed));
+            REQUIRE(gga_rmc.update(gps, 0));
+            REQUIRE(gga_rmc.epoch().sentences == MicroGps::message_bit(MessageType::GGA));
+            REQUIRE(feed(gps, gga_0));
+            REQUIRE(gps.has_time());
+            REQUIRE(gga_rmc.update(gps, 0));
+            REQUIRE(gga_rmc.epoch().time_ms == 0);
+            REQUIRE(feed(gps, rmc_0));
+            REQUIRE(gga_rmc.update(gps, 0));
+            REQUIRE(gga_rmc.epoch().time_ms == 56181000);
+        }
+
+        SECTION("It should ignore bad sentences")
+        {
+            const std::string bad("$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*00\r\n");
+
+            MicroGps gps;
+            GpsEpochAssembler epochs;
+
+            REQUIRE(feed(gps, bad));
+            REQUIRE_FALSE(epochs.update(gps, 0));
+            REQUIRE_FALSE(epochs.pending());
+        }
+    }
+
+} // namespace MicroGpsEpoch_tests
+} // namespace scottz0r
@@ -0,0 +1,165 @@
+#include "host/MicroGpsFleet.h"
+#include "catch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsFleet_tests
+{
+    using namespace scottz0r::gps;
+
+    /// Fix whose fields are all derived from the receiver and update number, so a torn copy is detected.
+    static GpsPosition make_fix(uint32_t id, uint32_t update)
+    {
+        GpsPosition position = {};
+        position.time_ms = update;
+        position.number_satellites = (unsigned char)id;
+        position.latitude = (float)(id % 90);
+        position.longitude = (float)(update % 180);
+        position.altitude_msl = (float)(id + update);
+        return position;
+    }
+
+    static bool is_fix(const GpsPosition &position, uint32_t id)
+    {
+        uint32_t update = position.time_ms;
+        return position.number_satellites == (unsigned char)id && position.latitude == (float)(id % 90) &&
+               position.longitude == (float)(update % 180) && position.altitude_msl == (float)(id + update);
+    }
+
+    TEST_CASE("GpsFleetTable")
+    {
+        SECTION("It should keep the last position of each receiver")
+        {
+            GpsFleetTable table(100);
+            REQUIRE(table.max_receivers() == 100);
+
+            GpsPosition position;
+            REQUIRE_FALSE(table.find(7, position));
+
+            for (uint32_t update = 1; update <= 5; ++update)
+            {
+                for (uint32_t id = 0; id < 100; ++id)
+                {
+                    REQUIRE(table.update(id * 1000, make_fix(id * 1000, update)));
+                }
+            }
+            REQUIRE(table.size() == 100);
+
+            for (uint32_t id = 0; id < 100; ++id)
+            {
+                REQUIRE(table.find(id * 1000, position));
+                REQUIRE(position.time_ms == 5);
+                REQUIRE(is_fix(position, id * 1000));
+            }
+            REQUIRE_FALSE(table.find(7, position));
+        }
+
+        SECTION("It should reject new receivers when full")
+        {
+            GpsFleetTable table(3);
+            REQUIRE(table.update(1, make_fix(1, 1)));
+            REQUIRE(table.update(2, make_fix(2, 1)));
+            REQUIRE(table.update(3, make_fix(3, 1)));
+            REQUIRE_FALSE(table.update(4, make_fix(4, 1)));
+            REQUIRE(table.update(3, make_fix(3, 2)));
+            REQUIRE_FALSE(table.update(fleet_empty_id, make_fix(5, 1)));
+            REQUIRE(table.size() == 3);
+        }
+
+        SECTION("It should snapshot every receiver with its update count")
+        {
+            GpsFleetTable table(10);
+            for (uint32_t id = 1; id <= 10; ++id)
+            {
+                for (uint32_t update = 1; update <= id; ++update)
+                {
+                    table.update(id, make_fix(id, update));
+                }
+            }
+
+            std::vector<GpsFleetPosition> positions;
+            REQUIRE(table.snapshot(positions) == 10);
+            std::sort(positions.begin(), positions.end(),
+                      [](const GpsFleetPosition &a, const GpsFleetPosition &b) { return a.id < b.id; });
+            for (uint32_t id = 1; id <= 10; ++id)
+            {
+                REQUIRE(positions[id - 1].id == id);
+                REQUIRE(positions[id - 1].updates == id);
+                REQUIRE(positions[id - 1].position.time_ms == id);
+                REQUIRE(is_fix(positions[id - 1].position, id));
+            }
+        }
+
+        SECTION("It should never hand out a torn position while receivers update")
+        {
+            constexpr uint32_t receivers = 64;
+            constexpr uint32_t updates = 20000;
+            GpsFleetTable table(receivers);
+            std::atomic<bool> done(false);
+            unsigned long reads = 0;
+            unsigned long torn = 0;
+
+            // Two writers share every receiver, so writers also contend on entries.
+            std::vector<std::thread> writers;
+            for (int writer = 0; writer < 2; ++writer)
+            {
+                writers.emplace_back([&table]() {
+                    for (uint32_t update = 1; update <= updates; ++update)
+                    {
+                        for (uint32_t id = 0; id < receivers; ++id)
+                        {
+                            table.update(id, make_fix(id, update));
+                        }
+                    }
+                });
+            }
+
+            std::thread reader([&]() {
+                // One more pass after the writers finish, so every receiver is read at least once.
+                std::vector<GpsFleetPosition> positions;
+                for (bool finished = false; !finished;)
+                {
+                    finished = done.load();
+                    for (uint32_t id = 0; id < receivers; ++id)
+                    {
+                        GpsPosition position;
+                        if (table.find(id, position))
+                        {
+                            torn += is_fix(position, id) ? 0 : 1;
+                            ++reads;
+                        }
+                    }
+                    table.snapshot(positions);
+                    for (const auto &item : positions)
+                    {
+                        torn += is_fix(item.position, item.id) ? 0 : 1;
+                        ++reads;
+                    }
+                }
+            });
+
+            for (auto &writer : writers)
+            {
+                writer.join();
+            }
+            done = true;
+            reader.join();
+
+            REQUIRE(reads > 0);
+            REQUIRE(torn == 0);
+            REQUIRE(table.size() == receivers);
+            std::vector<GpsFleetPosition> positions;
+            REQUIRE(table.snapshot(positions) == receivers);
+            for (const auto &item : positions)
+            {
+                REQUIRE(item.updates == 2 * updates);
+            }
+        }
+    }
+
+} // namespace MicroGpsFleet_tests
+} // namespace scottz0r
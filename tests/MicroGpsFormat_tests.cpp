@@ -108,5 +108,38 @@ namespace MicroGpsFormat_tests
         }
     }
 
+    TEST_CASE("nmea_checksum")
+    {
+        const std::string body("PMTK220,1000");
+        REQUIRE(nmea_checksum(body.data(), (size_type)body.size()) == 0x1F);
+        REQUIRE(nmea_checksum("", 0) == 0);
+    }
+
+    TEST_CASE("format_nmea_sentence")
+    {
+        SECTION("it should wrap the body")
+        {
+            char buffer[32];
+            size_type size = format_nmea_sentence("PMTK220,1000", buffer, sizeof(buffer));
+
+            REQUIRE(size == 18);
+            REQUIRE(buffer == "$PMTK220,1000*1F\r\n"s);
+        }
+
+        SECTION("it error small buffer")
+        {
+            char buffer[19];
+            REQUIRE(format_nmea_sentence("PMTK220,1000", buffer, sizeof(buffer) - 1) == 0);
+            REQUIRE(format_nmea_sentence("PMTK220,1000", buffer, sizeof(buffer)) == 18);
+        }
+
+        SECTION("it should error null input")
+        {
+            char buffer[32];
+            REQUIRE(format_nmea_sentence(nullptr, buffer, sizeof(buffer)) == 0);
+            REQUIRE(format_nmea_sentence("A", nullptr, 32) == 0);
+        }
+    }
+
 } // namespace MicroGpsFormat_tests
 } // namespace scottz0r
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "host/MicroGpsGenerator.h"
+#include "MicroGps.h"
+#include "catch.hpp"
+#include <string>
+
+namespace scottz0r
+{
+namespace MicroGpsGenerator_tests
+{
+    using namespace scottz0r::gps;
+
+    TEST_CASE("GpsTrafficGenerator")
+    {
+        SECTION("It should generate good GGA and RMC sentences every epoch")
+        {
+            GpsTrafficGenerator generator(7);
+            std::string traffic;
+            generator.generate(500, traffic);
+            REQUIRE(generator.epochs() == 500);
+
+            MicroGps gps;
+            unsigned gga = 0;
+            unsigned rmc = 0;
+            uint32_t expected_ms = 12 * 3600000;
+            for (char c : traffic)
+            {
+                if (gps.process(c))
+                {
+                    REQUIRE(gps.good());
+                    if (gps.message_type() == MessageType::GGA)
+                    {
+                        REQUIRE(gps.position_data().time_ms == expected_ms);
+                        REQUIRE(gps.position_data().latitude > 38.0f);
+                        REQUIRE(gps.position_data().latitude < 40.0f);
+                        REQUIRE(gps.position_data().longitude < -93.0f);
+                        expected_ms += 1000;
+                        ++gga;
+                    }
+                    else if (gps.message_type() == MessageType::RMC)
+                    {
+                        ++rmc;
+                    }
+                }
+            }
+            REQUIRE(gga == 500);
+            REQUIRE(rmc == 500);
+        }
+
+        SECTION("It should repeat traffic for equal seeds")
+        {
+            std::string first;
+            std::string second;
+            std::string other;
+            GpsTrafficGenerator(3).generate(50, first);
+            GpsTrafficGenerator(3).generate(50, second);
+            GpsTrafficGenerator(4).generate(50, other);
+
+            REQUIRE(first == second);
+            REQUIRE(first != other);
+        }
+
+        SECTION("It should not advance if the buffer is too small")
+        {
+            GpsTrafficGenerator generator;
+            char small[32];
+            REQUIRE(generator.next_epoch(small, sizeof(small)) == 0);
+            REQUIRE(generator.epochs() == 0);
+            REQUIRE(generator.time_ms() == 12 * 3600000);
+
+            char epoch[generator_epoch_max_size];
+            REQUIRE(generator.next_epoch(epoch, sizeof(epoch)) > 0);
+            REQUIRE(generator.time_ms() == 12 * 3600000 + 1000);
+        }
+    }
+
+} // namespace MicroGpsGenerator_tests
+} // namespace scottz0r
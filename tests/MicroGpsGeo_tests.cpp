@@ -0,0 +1,72 @@
+#include "MicroGpsGeo.h"
+#include "catch.hpp"
+#include <math.h>
+
+namespace scottz0r
+{
+namespace MicroGpsGeo_tests
+{
+    using namespace scottz0r::gps;
+
+    /// Reference great circle distance in meters, in double precision.
+    static double haversine(double lat1, double lon1, double lat2, double lon2)
+    {
+        double d_lat = (lat2 - lat1) * radians_per_degree;
+        double d_lon = (lon2 - lon1) * radians_per_degree;
+        double a = sin(d_lat / 2) * sin(d_lat / 2) +
+                   cos(lat1 * radians_per_degree) * cos(lat2 * radians_per_degree) * sin(d_lon / 2) * sin(d_lon / 2);
+        return 2 * earth_radius_m * asin(sqrt(a));
+    }
+
+    TEST_CASE("GpsLocalFrame")
+    {
+        SECTION("It should match great circle distances over short ranges")
+        {
+            const float latitudes[] = {0, 38.91f, -45.5f, 70.2f};
+            for (float latitude : latitudes)
+            {
+                GpsLocalFrame frame;
+                frame.reset(latitude, -94.75f);
+                for (int step = -20; step <= 20; step += 5)
+                {
+                    float lat = latitude + step * 0.0009f;
+                    float lon = -94.75f + step * 0.0013f;
+                    double expected = haversine(latitude, -94.75f, lat, lon);
+                    REQUIRE(fabs(frame.distance(lat, lon) - expected) <= 0.5 + expected * 1e-3);
+                }
+            }
+        }
+
+        SECTION("It should give signed east and north offsets")
+        {
+            GpsLocalFrame frame;
+            frame.reset(60, 10);
+            REQUIRE(frame.north(60.001f) > 110);
+            REQUIRE(frame.north(59.999f) < -110);
+            REQUIRE(frame.east(10.002f) == Approx(111.2).epsilon(0.01));
+            REQUIRE(frame.east(9.998f) == Approx(-111.2).epsilon(0.01));
+        }
+
+        SECTION("It should wrap across the antimeridian")
+        {
+            GpsLocalFrame frame;
+            frame.reset(0, 179.9995f);
+            REQUIRE(frame.east(-179.9995f) == Approx(111.2).epsilon(0.01));
+            REQUIRE(frame.distance(0, -179.9995f) < 112);
+        }
+
+        SECTION("It should keep the cached scale for small latitude moves")
+        {
+            GpsLocalFrame frame;
+            frame.reset(45, 0);
+            float east = frame.east(0.01f);
+            frame.reset(45.005f, 0);
+            REQUIRE(frame.east(0.01f) == east);
+            REQUIRE(frame.latitude() == 45.005f);
+            frame.reset(46, 0);
+            REQUIRE(frame.east(0.01f) < east);
+        }
+    }
+
+} // namespace MicroGpsGeo_tests
+} // namespace scottz0r
@@ -0,0 +1,342 @@
+#include "MicroGpsGeodesic.h"
+#include "catch.hpp"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsGeodesic_tests
+{
+    using namespace scottz0r::gps;
+
+    /// Reference great circle distance in meters, in double precision.
+    static double haversine(double lat1, double lon1, double lat2, double lon2)
+    {
+        double d_lat = (lat2 - lat1) * radians_per_degree;
+        double d_lon = (lon2 - lon1) * radians_per_degree;
+        double a = sin(d_lat / 2) * sin(d_lat / 2) +
+                   cos(lat1 * radians_per_degree) * cos(lat2 * radians_per_degree) * sin(d_lon / 2) * sin(d_lon / 2);
+        return 2 * earth_radius_m * asin(sqrt(a < 1 ? a : 1));
+    }
+
+    /// Reference initial bearing in degrees, in double precision.
+    static double bearing(double lat1, double lon1, double lat2, double lon2)
+    {
+        double phi1 = lat1 * radians_per_degree;
+        double phi2 = lat2 * radians_per_degree;
+        double d_lon = (lon2 - lon1) * radians_per_degree;
+        double y = sin(d_lon) * cos(phi2);
+        double x = cos(phi1) * sin(phi2) - sin(phi1) * cos(phi2) * cos(d_lon);
+        double degrees = atan2(y, x) / radians_per_degree;
+        return degrees < 0 ? degrees + 360 : degrees;
+    }
+
+    /// Earth centered, Earth fixed coordinates on WGS84, in double precision.
+    static void ecef(double lat, double lon, double height, double xyz[3])
+    {
+        double phi = lat * radians_per_degree;
+        double lambda = lon * radians_per_degree;
+        double radius = wgs84_a / sqrt(1 - wgs84_e2 * sin(phi) * sin(phi));
+        xyz[0] = (radius + height) * cos(phi) * cos(lambda);
+        xyz[1] = (radius + height) * cos(phi) * sin(lambda);
+        xyz[2] = (radius * (1 - wgs84_e2) + height) * sin(phi);
+    }
+
+    /// Reference east/north/up offsets, in double precision.
+    static void enu(double lat0, double lon0, double height0, double lat, double lon, double height, double out[3])
+    {
+        double origin[3], point[3];
+        ecef(lat0, lon0, height0, origin);
+        ecef(lat, lon, height, point);
+        double dx = point[0] - origin[0];
+        double dy = point[1] - origin[1];
+        double dz = point[2] - origin[2];
+
+        double phi = lat0 * radians_per_degree;
+        double lambda = lon0 * radians_per_degree;
+        out[0] = -sin(lambda) * dx + cos(lambda) * dy;
+        out[1] = -sin(phi) * cos(lambda) * dx - sin(phi) * sin(lambda) * dy + cos(phi) * dz;
+        out[2] = cos(phi) * cos(lambda) * dx + cos(phi) * sin(lambda) * dy + sin(phi) * dz;
+    }
+
+    /// Difference of two bearings in degrees, in [0, 180].
+    static double bearing_difference(double a, double b)
+    {
+        double difference = fabs(a - b);
+        return difference > 180 ? 360 - difference : difference;
+    }
+
+    /// Uniform random numbers in [low, high) from a fixed seed.
+    class Random
+    {
+    public:
+        explicit Random(uint32_t seed) : m_state(seed)
+        {
+        }
+
+        float uniform(float low, float high)
+        {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return low + (high - low) * (float)(m_state >> 8) / 16777216.0f;
+        }
+
+    private:
+        uint32_t m_state;
+    };
+
+    /// Random pairs of points: the whole globe for the first half, and pairs up to about 1 km apart for the second.
+    struct Pairs
+    {
+        explicit Pairs(size_type count)
+            : latitude1(count), longitude1(count), latitude2(count), longitude2(count), result(count)
+        {
+            Random random(2024);
+            for (size_type i = 0; i < count; ++i)
+            {
+                latitude1[i] = random.uniform(-90, 90);
+                longitude1[i] = random.uniform(-180, 180);
+                if (i < count / 2)
+                {
+                    latitude2[i] = random.uniform(-90, 90);
+                    longitude2[i] = random.uniform(-180, 180);
+                }
+                else
+                {
+                    latitude2[i] = latitude1[i] + random.uniform(-0.01f, 0.01f);
+                    longitude2[i] = longitude1[i] + random.uniform(-0.01f, 0.01f);
+                }
+            }
+        }
+
+        std::vector<float> latitude1;
+        std::vector<float> longitude1;
+        std::vector<float> latitude2;
+        std::vector<float> longitude2;
+        std::vector<float> result;
+    };
+
+    TEST_CASE("haversine_distance")
+    {
+        SECTION("It should match double precision within the documented bound")
+        {
+            Pairs pairs(20000);
+            haversine_distance(pairs.latitude1.data(), pairs.longitude1.data(), pairs.latitude2.data(),
+                               pairs.longitude2.data(), pairs.result.data(), pairs.result.size());
+
+            for (size_type i = 0; i < pairs.result.size(); ++i)
+            {
+                double expected =
+                    haversine(pairs.latitude1[i], pairs.longitude1[i], pairs.latitude2[i], pairs.longitude2[i]);
+                REQUIRE(fabs(pairs.result[i] - expected) <= 1e-6 * expected + 1e-6);
+            }
+        }
+
+        SECTION("It should handle the antimeridian, the poles and identical points")
+        {
+            const float latitude1[] = {10, 10, 90, 0, 45};
+            const float longitude1[] = {179.999f, -179.999f, 0, 0, -94.7f};
+            const float latitude2[] = {10, 10, -90, 0, 45};
+            const float longitude2[] = {-179.999f, 179.999f, 0, 180, -94.7f};
+            float distance[5];
+            haversine_distance(latitude1, longitude1, latitude2, longitude2, distance, 5);
+
+            double across = haversine(10, 179.999f, 10, 180.001f);
+            double half_circumference = 180 * radians_per_degree * earth_radius_m;
+            REQUIRE(fabs(distance[0] - across) <= 1e-6 * across);
+            REQUIRE(fabs(distance[1] - across) <= 1e-6 * across);
+            REQUIRE(fabs(distance[2] - half_circumference) <= 1e-6 * half_circumference);
+            REQUIRE(fabs(distance[3] - half_circumference) <= 1e-6 * half_circumference);
+            REQUIRE(distance[4] == 0);
+        }
+
+        SECTION("It should give the legs of a track from offset columns")
+        {
+            const float latitude[] = {38.9f, 38.901f, 38.902f, 38.902f};
+            const float longitude[] = {-94.7f, -94.7f, -94.699f, -94.698f};
+            float legs[3];
+            haversine_distance(latitude, longitude, latitude + 1, longitude + 1, legs, 3);
+            for (size_type i = 0; i < 3; ++i)
+            {
+                double expected = haversine(latitude[i], longitude[i], latitude[i + 1], longitude[i + 1]);
+                REQUIRE(fabs(legs[i] - expected) <= 1e-6 * expected);
+            }
+        }
+    }
+
+    TEST_CASE("initial_bearing")
+    {
+        SECTION("It should match double precision within the documented bound")
+        {
+            Pairs pairs(20000);
+            initial_bearing(pairs.latitude1.data(), pairs.longitude1.data(), pairs.latitude2.data(),
+                            pairs.longitude2.data(), pairs.result.data(), pairs.result.size());
+
+            for (size_type i = 0; i < pairs.result.size(); ++i)
+            {
+                REQUIRE(pairs.result[i] >= 0);
+                REQUIRE(pairs.result[i] < 360);
+
+                // Bearings are undefined at the poles and the antipode, and ill conditioned near them.
+                double distance =
+                    haversine(pairs.latitude1[i], pairs.longitude1[i], pairs.latitude2[i], pairs.longitude2[i]);
+                if (distance > 1.9e7 || fabs(pairs.latitude1[i]) > 89.99f || fabs(pairs.latitude2[i]) > 89.99f)
+                {
+                    continue;
+                }
+                double expected =
+                    bearing(pairs.latitude1[i], pairs.longitude1[i], pairs.latitude2[i], pairs.longitude2[i]);
+                REQUIRE(bearing_difference(pairs.result[i], expected) <= 1e-4);
+            }
+        }
+
+        SECTION("It should give compass directions")
+        {
+            const float latitude1[] = {0, 0, 0, 0, 10, 38.9f};
+            const float longitude1[] = {0, 0, 0, 0, 179.999f, -94.7f};
+            const float latitude2[] = {1, 0, -1, 0, 10, 38.9f};
+            const float longitude2[] = {0, 1, 0, -1, -179.999f, -94.7f};
+            float result[6];
+            initial_bearing(latitude1, longitude1, latitude2, longitude2, result, 6);
+
+            REQUIRE(result[0] == Approx(0).margin(1e-4));
+            REQUIRE(result[1] == Approx(90).margin(1e-4));
+            REQUIRE(result[2] == Approx(180).margin(1e-4));
+            REQUIRE(result[3] == Approx(270).margin(1e-4));
+            REQUIRE(result[4] == Approx(90).margin(1e-2));
+            REQUIRE(result[5] == 0);
+        }
+    }
+
+    TEST_CASE("GpsEnuFrame")
+    {
+        SECTION("It should match double precision ECEF within the documented bound")
+        {
+            const double references[][3] = {{38.9, -94.7, 300}, {0, 0, 0}, {-33.9, 151.2, 50}, {89.5, 179.9, 0}};
+            Random random(7);
+            constexpr size_type count = 5000;
+            std::vector<float> latitude(count), longitude(count), height(count);
+            std::vector<float> east(count), north(count), up(count);
+            for (size_type i = 0; i < count; ++i)
+            {
+                latitude[i] = random.uniform(-90, 90);
+                longitude[i] = random.uniform(-180, 180);
+                height[i] = random.uniform(-100, 10000);
+            }
+
+            for (const auto &reference : references)
+            {
+                GpsEnuFrame frame(reference[0], reference[1], reference[2]);
+                frame.project(latitude.data(), longitude.data(), height.data(), east.data(), north.data(), up.data(),
+                              count);
+                for (size_type i = 0; i < count; ++i)
+                {
+                    double expected[3];
+                    enu(reference[0], reference[1], reference[2], latitude[i], longitude[i], height[i], expected);
+
+                    // The kernel is within a millimeter; the rest is rounding the output to float.
+                    double tolerance = 1e-3 + 6e-8 * (fabs(expected[0]) + fabs(expected[1]) + fabs(expected[2]));
+                    REQUIRE(fabs(east[i] - expected[0]) <= tolerance);
+                    REQUIRE(fabs(north[i] - expected[1]) <= tolerance);
+                    REQUIRE(fabs(up[i] - expected[2]) <= tolerance);
+                }
+            }
+        }
+
+        SECTION("It should project nearby points to local meters without heights")
+        {
+            GpsEnuFrame frame(38.9, -94.7);
+            const float latitude[] = {38.9f, 38.91f, 38.9f, 38.89f};
+            const float longitude[] = {-94.7f, -94.7f, -94.69f, -94.71f};
+            float east[4], north[4], up[4];
+            frame.project(latitude, longitude, nullptr, east, north, up, 4);
+
+            for (size_type i = 0; i < 4; ++i)
+            {
+                double expected[3];
+                enu(38.9, -94.7, 0, latitude[i], longitude[i], 0, expected);
+                REQUIRE(fabs(east[i] - expected[0]) <= 1e-3);
+                REQUIRE(fabs(north[i] - expected[1]) <= 1e-3);
+                REQUIRE(fabs(up[i] - expected[2]) <= 1e-3);
+            }
+            REQUIRE(north[1] > 1000);
+            REQUIRE(east[2] > 800);
+            REQUIRE(up[1] < 0);
+        }
+
+        SECTION("It should handle a reference on the antimeridian")
+        {
+            GpsEnuFrame frame(10, 180);
+            const float latitude[] = {10, 10};
+            const float longitude[] = {-179.99f, 179.99f};
+            float east[2], north[2], up[2];
+            frame.project(latitude, longitude, nullptr, east, north, up, 2);
+            REQUIRE(east[0] == Approx(1095.5).margin(1));
+            REQUIRE(east[1] == Approx(-1095.5).margin(1));
+        }
+    }
+
+    /// @brief Time a kernel over repeated runs, in nanoseconds per point.
+    template <typename Kernel> static double time_kernel(size_type count, Kernel kernel)
+    {
+        constexpr int repeats = 20;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r)
+        {
+            kernel();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return seconds * 1e9 / ((double)repeats * count);
+    }
+
+    // Hidden; run with: MicroGpsTests "[.benchmark]". Build with CMAKE_BUILD_TYPE=Release for meaningful numbers.
+    TEST_CASE("Geodesic kernels throughput", "[.benchmark]")
+    {
+        constexpr size_type count = 100000;
+        Pairs pairs(count);
+        std::vector<float> east(count), north(count), up(count);
+        float *result = pairs.result.data();
+        const float *lat1 = pairs.latitude1.data();
+        const float *lon1 = pairs.longitude1.data();
+        const float *lat2 = pairs.latitude2.data();
+        const float *lon2 = pairs.longitude2.data();
+
+        double scalar = time_kernel(count, [&] {
+            for (size_type i = 0; i < count; ++i)
+            {
+                result[i] = (float)haversine(lat1[i], lon1[i], lat2[i], lon2[i]);
+            }
+        });
+        double batch = time_kernel(count, [&] { haversine_distance(lat1, lon1, lat2, lon2, result, count); });
+        printf("haversine %8.2f ns scalar %8.2f ns batch %6.1fx\n", scalar, batch, scalar / batch);
+
+        scalar = time_kernel(count, [&] {
+            for (size_type i = 0; i < count; ++i)
+            {
+                result[i] = (float)bearing(lat1[i], lon1[i], lat2[i], lon2[i]);
+            }
+        });
+        batch = time_kernel(count, [&] { initial_bearing(lat1, lon1, lat2, lon2, result, count); });
+        printf("bearing   %8.2f ns scalar %8.2f ns batch %6.1fx\n", scalar, batch, scalar / batch);
+
+        scalar = time_kernel(count, [&] {
+            for (size_type i = 0; i < count; ++i)
+            {
+                double out[3];
+                enu(38.9, -94.7, 0, lat2[i], lon2[i], 0, out);
+                east[i] = (float)out[0];
+                north[i] = (float)out[1];
+                up[i] = (float)out[2];
+            }
+        });
+        GpsEnuFrame frame(38.9, -94.7);
+        batch = time_kernel(
+            count, [&] { frame.project(lat2, lon2, nullptr, east.data(), north.data(), up.data(), count); });
+        printf("enu       %8.2f ns scalar %8.2f ns batch %6.1fx\n", scalar, batch, scalar / batch);
+    }
+
+} // namespace MicroGpsGeodesic_tests
+} // namespace scottz0r
@@ -0,0 +1,213 @@
+#include "host/MicroGpsMerge.h"
+#include "catch.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsMerge_tests
+{
+    using namespace scottz0r::gps;
+
+    constexpr uint32_t day_ms = 86400000;
+
+    /// Source backed by a vector of fixes.
+    struct VectorSource
+    {
+        std::vector<GpsPosition> fixes;
+        size_t next = 0;
+    };
+
+    static bool pull(GpsPosition &position, void *context)
+    {
+        VectorSource *source = static_cast<VectorSource *>(context);
+        if (source->next == source->fixes.size())
+        {
+            return false;
+        }
+        position = source->fixes[source->next++];
+        return true;
+    }
+
+    static GpsPosition make_fix(uint32_t time_ms, float latitude = 0)
+    {
+        GpsPosition position = {};
+        position.time_ms = time_ms % day_ms;
+        position.fields = position_field_bit(PositionField::Time) | position_field_bit(PositionField::Latitude);
+        position.latitude = latitude;
+        return position;
+    }
+
+    static std::vector<GpsMergeItem> merge_all(GpsMerge &merge)
+    {
+        std::vector<GpsMergeItem> items;
+        GpsMergeItem item;
+        while (merge.next(item))
+        {
+            items.push_back(item);
+        }
+        return items;
+    }
+
+    static void require_ordered(const std::vector<GpsMergeItem> &items)
+    {
+        for (size_t i = 1; i < items.size(); ++i)
+        {
+            bool ordered = items[i - 1].time_ms < items[i].time_ms ||
+                           (items[i - 1].time_ms == items[i].time_ms && items[i - 1].receiver <= items[i].receiver);
+            REQUIRE(ordered);
+        }
+    }
+
+    TEST_CASE("GpsMerge")
+    {
+        SECTION("It should merge receivers in time order across midnight")
+        {
+            // Receivers with different rates, starting an hour before midnight. The latitude carries the
+            // extended time, so the output can be checked against it.
+            std::vector<VectorSource> sources(5);
+            std::vector<uint64_t> expected;
+            for (size_type r = 0; r < sources.size(); ++r)
+            {
+                uint64_t time = day_ms - 3600000 + r * 137;
+                for (size_type i = 0; i < 2000; ++i)
+                {
+                    sources[r].fixes.push_back(make_fix((uint32_t)(time % day_ms), (float)(r * 10000 + i)));
+                    expected.push_back(time);
+                    time += 1000 + r * 250;
+                }
+            }
+
+            GpsMerge merge;
+            for (auto &source : sources)
+            {
+                REQUIRE(merge.add_source(pull, &source));
+            }
+            REQUIRE(merge.source_count() == 5);
+
+            std::vector<GpsMergeItem> items = merge_all(merge);
+            REQUIRE(items.size() == expected.size());
+            require_ordered(items);
+
+            std::sort(expected.begin(), expected.end());
+            for (size_t i = 0; i < items.size(); ++i)
+            {
+                REQUIRE(items[i].time_ms == expected[i]);
+            }
+            REQUIRE(items.back().time_ms > day_ms);
+            REQUIRE(merge.late_count() == 0);
+        }
+
+        SECTION("It should restore order within the reorder window")
+        {
+            // Swap every other pair of fixes, and move a fix back across midnight.
+            VectorSource first;
+            for (uint32_t i = 0; i < 100; ++i)
+            {
+                first.fixes.push_back(make_fix(day_ms - 50000 + i * 1000));
+            }
+            for (size_t i = 0; i + 1 < first.fixes.size(); i += 4)
+            {
+                std::swap(first.fixes[i], first.fixes[i + 1]);
+            }
+            std::swap(first.fixes[50], first.fixes[51]);
+
+            VectorSource second;
+            for (uint32_t i = 0; i < 100; ++i)
+            {
+                second.fixes.push_back(make_fix(day_ms - 50000 + i * 1000 + 500));
+            }
+
+            GpsMerge merge(4);
+            merge.add_source(pull, &first);
+            merge.add_source(pull, &second);
+
+            std::vector<GpsMergeItem> items = merge_all(merge);
+            REQUIRE(items.size() == 200);
+            require_ordered(items);
+            REQUIRE(items.front().time_ms == day_ms - 50000);
+            REQUIRE(items.back().time_ms == day_ms + 49500);
+            REQUIRE(merge.late_count() == 0);
+        }
+
+        SECTION("It should drop fixes later than the reorder window")
+        {
+            VectorSource source;
+            for (uint32_t i = 0; i < 10; ++i)
+            {
+                source.fixes.push_back(make_fix(i * 1000));
+            }
+            std::swap(source.fixes[2], source.fixes[8]);
+
+            GpsMerge merge(2);
+            merge.add_source(pull, &source);
+
+            std::vector<GpsMergeItem> items = merge_all(merge);
+            require_ordered(items);
+            REQUIRE(items.size() + merge.late_count() == 10);
+            REQUIRE(merge.late_count() > 0);
+        }
+
+        SECTION("It should order equal times by receiver")
+        {
+            VectorSource sources[3];
+            for (auto &source : sources)
+            {
+                source.fixes = {make_fix(1000), make_fix(2000)};
+            }
+
+            GpsMerge merge;
+            merge.add_source(pull, &sources[2]);
+            merge.add_source(pull, &sources[0]);
+            merge.add_source(pull, &sources[1]);
+
+            std::vector<GpsMergeItem> items = merge_all(merge);
+            REQUIRE(items.size() == 6);
+            for (size_t i = 0; i < 6; ++i)
+            {
+                REQUIRE(items[i].receiver == i % 3);
+            }
+        }
+
+        SECTION("It should place a source that starts on a later day")
+        {
+            VectorSource before;
+            before.fixes = {make_fix(day_ms - 2000), make_fix(day_ms - 1000)};
+            VectorSource after;
+            after.fixes = {make_fix(500), make_fix(1500)};
+
+            GpsMerge merge;
+            merge.add_source(pull, &after, 1);
+            merge.add_source(pull, &before);
+
+            std::vector<GpsMergeItem> items = merge_all(merge);
+            REQUIRE(items.size() == 4);
+            REQUIRE(items[0].receiver == 1);
+            REQUIRE(items[1].receiver == 1);
+            REQUIRE(items[2].time_ms == day_ms + 500);
+        }
+
+        SECTION("It should skip fixes without a time and handle empty sources")
+        {
+            VectorSource empty;
+            VectorSource source;
+            source.fixes = {make_fix(1000), GpsPosition(), make_fix(2000)};
+
+            GpsMerge merge;
+            GpsMergeItem item;
+            REQUIRE(merge.add_source(pull, &empty));
+            REQUIRE(merge.add_source(pull, &source));
+            REQUIRE(merge.next(item));
+            REQUIRE(item.receiver == 1);
+            REQUIRE_FALSE(merge.add_source(pull, &empty));
+            REQUIRE(merge.next(item));
+            REQUIRE(item.time_ms == 2000);
+            REQUIRE_FALSE(merge.next(item));
+
+            GpsMerge none;
+            REQUIRE_FALSE(none.next(item));
+        }
+    }
+
+} // namespace MicroGpsMerge_tests
+} // namespace scottz0r
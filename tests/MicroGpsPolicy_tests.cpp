@@ -0,0 +1,141 @@
+#include "MicroGps.h"
+#include "catch.hpp"
+#include <string>
+
+namespace scottz0r
+{
+namespace MicroGpsPolicy_tests
+{
+    using namespace scottz0r::gps;
+
+    using MinimalGps = BasicMicroGps<MicroGpsMinimalPolicy>;
+    using FullGps = BasicMicroGps<MicroGpsFullPolicy>;
+
+    /// Default tier with the checksum ignored.
+    struct NoChecksumPolicy : MicroGpsPolicy
+    {
+        static constexpr bool enforce_checksum = false;
+    };
+
+    // Footprint of each tier on the test host. Disabled records and counters must take no space.
+    static_assert(sizeof(MinimalGps) <= 64, "Minimal tier (fixed point GGA, 16 byte buffer) exceeds 64 bytes");
+    static_assert(sizeof(MicroGps) <= 160, "Default tier (float, all messages) exceeds 160 bytes");
+    static_assert(sizeof(FullGps) <= 232, "Full tier (double, all messages, stats) exceeds 232 bytes");
+    static_assert(sizeof(MinimalGps) < sizeof(MicroGps) && sizeof(MicroGps) < sizeof(FullGps),
+                  "Tiers must be ordered by footprint");
+    static_assert(sizeof(BasicMicroGps<NoChecksumPolicy>) == sizeof(MicroGps),
+                  "Checksum enforcement must not change the footprint");
+
+    const std::string gga_0("$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*5B\r\n");
+    const std::string rmc_0("$GPRMC,153621.000,A,3854.8732,N,09445.3680,W,12.34,054.70,191124,020.3,E,A*2D\r\n");
+
+    /// Feed a whole sentence to the parser and return the result of the last character.
+    template <typename _Gps> static bool feed(_Gps &gps, const std::string &msg)
+    {
+        bool result = false;
+        for (const auto &c : msg)
+        {
+            result = gps.process(c);
+        }
+        return result;
+    }
+
+    TEST_CASE("BasicMicroGps")
+    {
+        SECTION("It should decode fixed point values in the minimal tier")
+        {
+            MinimalGps gps;
+
+            REQUIRE(feed(gps, gga_0));
+            REQUIRE(gps.good());
+            REQUIRE(gps.message_type() == MessageType::GGA);
+
+            const FixedGpsPosition &posn = gps.position_data();
+            REQUIRE(posn.time_ms == 56181000);
+            REQUIRE(posn.latitude == 389145533);
+            REQUIRE(posn.longitude == -947561333);
+            REQUIRE(posn.fix_quality == 1);
+            REQUIRE(posn.number_satellites == 4);
+            REQUIRE(posn.horizontal_dilution == 2070);
+            REQUIRE(posn.altitude_msl == 243900);
+            REQUIRE(posn.geoid_height == -30100);
+        }
+
+        SECTION("It should skip message types the policy does not enable")
+        {
+            MinimalGps gps;
+            GpsSatelliteTable table;
+            gps.set_satellite_table(&table);
+
+            REQUIRE_FALSE(feed(gps, rmc_0));
+            REQUIRE(gps.message_type() == MessageType::Unknown);
+            REQUIRE(gps.decoded_messages() == message_bit(MessageType::GGA));
+            REQUIRE(gps.navigation_data().date == 0);
+
+            REQUIRE_FALSE(feed(gps, "$GPGSV,1,1,01,10,63,137,17*4F\r\n"));
+            REQUIRE(table.satellites().count == 0);
+        }
+
+        SECTION("It should decode double precision values in the full tier")
+        {
+            FullGps gps;
+
+            REQUIRE(feed(gps, gga_0));
+            REQUIRE(gps.good());
+
+            const auto &posn = gps.position_data();
+            REQUIRE(posn.latitude == Approx(38.0 + 54.8732 / 60.0).epsilon(1e-12));
+            REQUIRE(posn.longitude == Approx(-(94.0 + 45.3680 / 60.0)).epsilon(1e-12));
+            REQUIRE(posn.altitude_msl == Approx(243.9).epsilon(1e-12));
+
+            REQUIRE(feed(gps, rmc_0));
+            REQUIRE(gps.navigation_data().latitude == Approx(38.0 + 54.8732 / 60.0).epsilon(1e-12));
+        }
+
+        SECTION("It should count sentences and errors when stats are enabled")
+        {
+            FullGps gps;
+
+            REQUIRE(feed(gps, gga_0));
+            REQUIRE(feed(gps, "$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*5C\r\n"));
+            REQUIRE(gps.bad());
+            REQUIRE_FALSE(feed(gps, "$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,\r\n"));
+            REQUIRE_FALSE(feed(gps, "$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,,,,"
+                                    "*5B\r\n"));
+            REQUIRE_FALSE(feed(gps, "$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n"));
+
+            const GpsStats &stats = gps.stats();
+            REQUIRE(stats.sentences == 2);
+            REQUIRE(stats.checksum_errors == 2);
+            REQUIRE(stats.format_errors == 1);
+            REQUIRE(stats.unknown == 1);
+
+            gps.reset_stats();
+            REQUIRE(gps.stats().sentences == 0);
+        }
+
+        SECTION("It should report zero stats when stats are disabled")
+        {
+            MicroGps gps;
+
+            REQUIRE(feed(gps, gga_0));
+            REQUIRE(gps.stats().sentences == 0);
+        }
+
+        SECTION("It should accept missing and mismatched checksums when enforcement is off")
+        {
+            BasicMicroGps<NoChecksumPolicy> gps;
+
+            REQUIRE(feed(gps, "$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,\r\n"));
+            REQUIRE(gps.good());
+            REQUIRE(gps.position_data().number_satellites == 4);
+            REQUIRE(gps.position_data().geoid_height == Approx(-30.1f));
+
+            REQUIRE(feed(gps, "$GPRMC,153621.000,A,3854.8732,N,09445.3680,W,12.34,054.70,191124,020.3,E,A*00\r\n"));
+            REQUIRE(gps.good());
+            REQUIRE(gps.navigation_data().speed_knots == 1234);
+        }
+    }
+
+} // namespace MicroGpsPolicy_tests
+} // namespace scottz0r
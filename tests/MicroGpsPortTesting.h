@@ -0,0 +1,70 @@
+/// @file Helpers shared by the serial port ingest tests.
+#ifndef _SCOTTZ0R_GPS_PORT_TESTING_INCLUDE_GUARD
+#define _SCOTTZ0R_GPS_PORT_TESTING_INCLUDE_GUARD
+
+#include "host/MicroGpsSerial.h"
+#include "catch.hpp"
+#include <fcntl.h>
+#include <pty.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsPort_testing
+{
+    using namespace scottz0r::gps;
+
+    /// Pseudo terminal standing in for a receiver. The test writes to the master; the ingest opens the slave.
+    struct PseudoTerminal
+    {
+        int master = -1;
+        int slave = -1;
+        std::string path;
+
+        PseudoTerminal()
+        {
+            char name[64];
+            REQUIRE(openpty(&master, &slave, name, nullptr, nullptr) == 0);
+            path = name;
+            fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+        }
+
+        ~PseudoTerminal()
+        {
+            close_master();
+            if (slave >= 0)
+            {
+                ::close(slave);
+            }
+        }
+
+        void close_master()
+        {
+            if (master >= 0)
+            {
+                ::close(master);
+                master = -1;
+            }
+        }
+    };
+
+    /// Every fix delivered to collect(), and the number of batches.
+    struct Batches
+    {
+        std::vector<GpsPortFix> fixes;
+        unsigned calls = 0;
+    };
+
+    inline void collect(const GpsPortFix *fixes, size_type count, void *context)
+    {
+        Batches *batches = static_cast<Batches *>(context);
+        batches->fixes.insert(batches->fixes.end(), fixes, fixes + count);
+        ++batches->calls;
+    }
+
+} // namespace MicroGpsPort_testing
+} // namespace scottz0r
+
+#endif // _SCOTTZ0R_GPS_PORT_TESTING_INCLUDE_GUARD
@@ -0,0 +1,90 @@
+#include "MicroGpsRange.h"
+#include "catch.hpp"
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsRange_tests
+{
+    using namespace scottz0r::gps;
+
+    const std::string gga_0("$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*5B\r\n");
+    const std::string gga_1("$GPGGA,152541.096,,,,,0,00,,,M,,M,,*71\r\n");
+    const std::string gga_bad("$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*00\r\n");
+    const std::string rmc_0("$GPRMC,153621.000,A,3854.8732,N,09445.3680,W,12.34,054.70,191124,020.3,E,A*2D\r\n");
+
+    TEST_CASE("parse")
+    {
+        SECTION("It should yield only good GGA records in order")
+        {
+            const std::string log = "garbage" + rmc_0 + gga_0 + gga_bad + rmc_0 + gga_1 + "$GPGGA,1536";
+
+            std::vector<uint32_t> times;
+            for (const GpsPosition &p : parse(log.data(), (size_type)log.size()))
+            {
+                times.push_back(p.time_ms);
+            }
+
+            REQUIRE(times.size() == 2);
+            REQUIRE(times[0] == 56181000);
+            REQUIRE(times[1] == 55541096);
+        }
+
+        SECTION("It should yield a sentence that ends at the end of the data")
+        {
+            auto range = parse(gga_0.data(), (size_type)gga_0.size());
+            auto it = range.begin();
+
+            REQUIRE(it != range.end());
+            REQUIRE(it->number_satellites == 4);
+            ++it;
+            REQUIRE(it == range.end());
+        }
+
+        SECTION("It should be empty without good GGA sentences")
+        {
+            auto empty = parse(nullptr, 0);
+            REQUIRE(empty.begin() == empty.end());
+
+            const std::string log = rmc_0 + gga_bad;
+            auto range = parse(log.data(), (size_type)log.size());
+            REQUIRE(range.begin() == range.end());
+        }
+
+        SECTION("It should support multiple passes and standard algorithms")
+        {
+            const std::string log = gga_0 + gga_1 + gga_0;
+            auto range = parse(log.data(), (size_type)log.size());
+
+            auto first = range.begin();
+            auto copy = first;
+            ++first;
+            REQUIRE(copy->time_ms == 56181000);
+            REQUIRE(first->time_ms == 55541096);
+            REQUIRE(copy++ != first);
+            REQUIRE(copy == first);
+
+            REQUIRE(std::distance(range.begin(), range.end()) == 3);
+            REQUIRE(std::count_if(range.begin(), range.end(), [](const GpsPosition &p) { return p.fix_quality > 0; }) ==
+                    2);
+
+            static_assert(std::is_same<std::iterator_traits<GpsPositionRange::iterator>::iterator_category,
+                                       std::forward_iterator_tag>::value,
+                          "Range iterators must be forward iterators");
+        }
+
+        SECTION("It should decode records with the given policy")
+        {
+            for (const FixedGpsPosition &p : parse<MicroGpsMinimalPolicy>(gga_0.data(), (size_type)gga_0.size()))
+            {
+                REQUIRE(p.latitude == 389145533);
+            }
+        }
+    }
+
+} // namespace MicroGpsRange_tests
+} // namespace scottz0r
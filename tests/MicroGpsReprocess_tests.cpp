@@ -0,0 +1,271 @@
+#include "host/MicroGpsReprocess.h"
+#include "MicroGpsFormat.h"
+#include "catch.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsReprocess_tests
+{
+    using namespace scottz0r::gps;
+
+    /// Temporary directory that is removed, with the files written through it, when the test ends.
+    class TempDirectory
+    {
+    public:
+        TempDirectory()
+        {
+            char path[] = "/tmp/MicroGpsReprocess_XXXXXX";
+            REQUIRE(mkdtemp(path) != nullptr);
+            m_path = path;
+        }
+
+        ~TempDirectory()
+        {
+            for (auto it = m_files.rbegin(); it != m_files.rend(); ++it)
+            {
+                if (unlink(it->c_str()) != 0)
+                {
+                    rmdir(it->c_str());
+                }
+            }
+            rmdir(m_path.c_str());
+        }
+
+        const std::string &path() const
+        {
+            return m_path;
+        }
+
+        void make_directory(const std::string &name)
+        {
+            std::string path = m_path + "/" + name;
+            REQUIRE(mkdir(path.c_str(), 0700) == 0);
+            m_files.push_back(path);
+        }
+
+        void link(const std::string &target, const std::string &name)
+        {
+            std::string path = m_path + "/" + name;
+            REQUIRE(symlink(target.c_str(), path.c_str()) == 0);
+            m_files.push_back(path);
+        }
+
+        std::string write(const std::string &name, const std::string &text)
+        {
+            std::string path = m_path + "/" + name;
+            FILE *file = fopen(path.c_str(), "wb");
+            REQUIRE(file != nullptr);
+            REQUIRE(fwrite(text.data(), 1, text.size(), file) == text.size());
+            fclose(file);
+            m_files.push_back(path);
+            return path;
+        }
+
+    private:
+        std::string m_path;
+        std::vector<std::string> m_files;
+    };
+
+    /// A log with a GGA and a GSA sentence per second. Every 7th GGA has a bad checksum.
+    static std::string make_log(unsigned seconds, unsigned start = 0)
+    {
+        std::string log;
+        for (unsigned i = 0; i < seconds; ++i)
+        {
+            unsigned t = start + i;
+            char body[100];
+            snprintf(body, sizeof(body), "GPGGA,%02u%02u%02u.00,3854.%04u,N,09445.3680,W,1,08,0.9,243.9,M,-30.1,M,,",
+                     t / 3600 % 24, t / 60 % 60, t % 60, t % 10000);
+
+            char sentence[128];
+            size_type size = format_nmea_sentence(body, sentence, sizeof(sentence));
+            if (i % 7 == 6)
+            {
+                sentence[size - 3] = sentence[size - 3] == '0' ? '1' : '0';
+            }
+            log.append(sentence, size);
+            log += "$GPGSA,A,3,04,05,09,12,24,25,29,,,,,,1.8,0.9,1.5*3F\r\n";
+        }
+        return log;
+    }
+
+    static std::vector<GpsPosition> parse_all(const std::string &text)
+    {
+        std::vector<GpsPosition> fixes;
+        GpsStats stats = {};
+        _detail::parse_chunk(text.data(), text.size(), 0, text.size(), fixes, stats);
+        return fixes;
+    }
+
+    struct Collected
+    {
+        std::vector<GpsFileResult> results;
+    };
+
+    static void collect(const GpsFileResult &result, void *context)
+    {
+        static_cast<Collected *>(context)->results.push_back(result);
+    }
+
+    TEST_CASE("parse_chunk")
+    {
+        const std::string log = make_log(50);
+        const std::vector<GpsPosition> expected = parse_all(log);
+        REQUIRE(expected.size() == 43);
+
+        SECTION("It should parse every sentence exactly once for any chunking")
+        {
+            for (uint64_t chunk_size = 1; chunk_size < 300; chunk_size += 13)
+            {
+                std::vector<GpsPosition> fixes;
+                GpsStats stats = {};
+                for (uint64_t begin = 0; begin < log.size(); begin += chunk_size)
+                {
+                    _detail::parse_chunk(log.data(), log.size(), begin, begin + chunk_size, fixes, stats);
+                }
+
+                REQUIRE(fixes.size() == expected.size());
+                for (size_type i = 0; i < fixes.size(); ++i)
+                {
+                    REQUIRE(fixes[i].time_ms == expected[i].time_ms);
+                    REQUIRE(fixes[i].latitude == expected[i].latitude);
+                }
+                REQUIRE(stats.sentences == 50);
+                REQUIRE(stats.checksum_errors == 7);
+                REQUIRE(stats.unknown == 50);
+            }
+        }
+    }
+
+    TEST_CASE("GpsReprocessor")
+    {
+        TempDirectory directory;
+
+        SECTION("It should report every file in path order")
+        {
+            directory.make_directory("b");
+            std::vector<std::string> paths;
+            std::vector<std::string> logs;
+
+            // Names are written out of order; results must come back sorted.
+            const char *names[] = {"c.nmea", "b/2.nmea", "a.nmea", "b/1.nmea", "empty.nmea", "large.nmea"};
+            for (size_type i = 0; i < 6; ++i)
+            {
+                std::string log = i == 4 ? std::string() : make_log(i == 5 ? 2000 : 20 + i * 10, i * 1000);
+                paths.push_back(directory.write(names[i], log));
+                logs.push_back(log);
+            }
+
+            Collected collected;
+            GpsReprocessStats stats;
+            GpsReprocessor reprocessor(4, 1000);
+            REQUIRE(reprocessor.threads() == 4);
+            REQUIRE(reprocessor.run(directory.path().c_str(), collect, &collected, stats));
+
+            const size_type order[] = {2, 3, 1, 0, 4, 5};
+            REQUIRE(collected.results.size() == 6);
+            uint64_t bytes = 0;
+            uint64_t fixes = 0;
+            for (size_type i = 0; i < 6; ++i)
+            {
+                const GpsFileResult &result = collected.results[i];
+                const std::string &log = logs[order[i]];
+                std::vector<GpsPosition> expected = parse_all(log);
+
+                REQUIRE(result.path == paths[order[i]]);
+                REQUIRE(result.ok);
+                REQUIRE(result.size == log.size());
+                REQUIRE(result.fixes.size() == expected.size());
+                for (size_type j = 0; j < expected.size(); ++j)
+                {
+                    REQUIRE(result.fixes[j].time_ms == expected[j].time_ms);
+                }
+                REQUIRE(result.stats.sentences == expected.size() + result.stats.checksum_errors);
+                REQUIRE(result.stats.unknown == result.stats.sentences);
+
+                bytes += log.size();
+                fixes += expected.size();
+            }
+
+            REQUIRE(stats.files == 6);
+            REQUIRE(stats.bytes == bytes);
+            REQUIRE(stats.fixes == fixes);
+            REQUIRE(stats.seconds > 0);
+            REQUIRE(stats.fixes_per_second() > 0);
+        }
+
+        SECTION("It should list linked files but not follow linked directories")
+        {
+            directory.make_directory("b");
+            directory.write("a.nmea", make_log(10));
+            directory.write("b/1.nmea", make_log(10));
+            directory.link("..", "b/loop");
+            directory.link("a.nmea", "c.nmea");
+
+            Collected collected;
+            GpsReprocessStats stats;
+            GpsReprocessor reprocessor(2);
+            REQUIRE(reprocessor.run(directory.path().c_str(), collect, &collected, stats));
+            REQUIRE(collected.results.size() == 3);
+            REQUIRE(collected.results[0].path == directory.path() + "/a.nmea");
+            REQUIRE(collected.results[1].path == directory.path() + "/b/1.nmea");
+            REQUIRE(collected.results[2].path == directory.path() + "/c.nmea");
+            REQUIRE(collected.results[2].fixes.size() == collected.results[0].fixes.size());
+        }
+
+        SECTION("It should parse lines longer than the mapping slack across chunks")
+        {
+            std::string log = make_log(100) + std::string(20000, 'x') + "\r\n" + make_log(100, 1000);
+            directory.write("long.nmea", log);
+            const std::vector<GpsPosition> expected = parse_all(log);
+
+            Collected collected;
+            GpsReprocessStats stats;
+            GpsReprocessor reprocessor(4, 1000);
+            REQUIRE(reprocessor.run(directory.path().c_str(), collect, &collected, stats));
+            REQUIRE(collected.results.size() == 1);
+            REQUIRE(collected.results[0].fixes.size() == expected.size());
+            for (size_type i = 0; i < expected.size(); ++i)
+            {
+                REQUIRE(collected.results[0].fixes[i].time_ms == expected[i].time_ms);
+            }
+        }
+
+        SECTION("It should give the same results with one thread")
+        {
+            std::string log = make_log(500);
+            directory.write("one.nmea", log);
+
+            Collected collected;
+            GpsReprocessStats stats;
+            GpsReprocessor reprocessor(1, 4096);
+            REQUIRE(reprocessor.run(directory.path().c_str(), collect, &collected, stats));
+            REQUIRE(collected.results.size() == 1);
+            REQUIRE(collected.results[0].fixes.size() == parse_all(log).size());
+        }
+
+        SECTION("It should report files that cannot be read")
+        {
+            std::vector<std::string> paths = {directory.write("good.nmea", make_log(10)),
+                                              directory.path() + "/missing"};
+
+            Collected collected;
+            GpsReprocessStats stats;
+            GpsReprocessor reprocessor(2);
+            REQUIRE_FALSE(reprocessor.run(paths, collect, &collected, stats));
+            REQUIRE(collected.results.size() == 2);
+            REQUIRE(collected.results[0].ok);
+            REQUIRE_FALSE(collected.results[1].ok);
+
+            REQUIRE_FALSE(reprocessor.run("/nonexistent/logs", collect, &collected, stats));
+        }
+    }
+
+} // namespace MicroGpsReprocess_tests
+} // namespace scottz0r
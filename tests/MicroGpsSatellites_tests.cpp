@@ -0,0 +1,158 @@
+#include "MicroGps.h"
+#include "catch.hpp"
+#include <string>
+
+namespace scottz0r
+{
+namespace MicroGpsSatellites_tests
+{
+    using namespace scottz0r::gps;
+    using MessageType = MicroGps::MessageType;
+
+    const std::string gsv_1("$GPGSV,3,1,10,03,03,111,00,04,15,270,00,06,01,010,00,13,06,292,00*75\r\n");
+    const std::string gsv_2("$GPGSV,3,2,10,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00*75\r\n");
+    const std::string gsv_3("$GPGSV,3,3,10,22,42,067,42,24,14,311,43*7E\r\n");
+
+    /// Feed a whole sentence to the parser and return the result of the last character.
+    static bool feed(MicroGps &gps, const std::string &msg)
+    {
+        bool result = false;
+        for (const auto &c : msg)
+        {
+            result = gps.process(c);
+        }
+        return result;
+    }
+
+    TEST_CASE("GpsSatelliteTable")
+    {
+        SECTION("It should publish a cycle only after the last part")
+        {
+            GpsSatelliteTable table;
+            MicroGps gps;
+            gps.set_satellite_table(&table);
+
+            REQUIRE(feed(gps, gsv_1));
+            REQUIRE(gps.good());
+            REQUIRE(gps.message_type() == MessageType::GSV);
+            REQUIRE(table.satellites().count == 0);
+
+            REQUIRE(feed(gps, gsv_2));
+            REQUIRE(table.satellites().count == 0);
+
+            REQUIRE(feed(gps, gsv_3));
+            REQUIRE(gps.good());
+
+            const auto &sats = table.satellites();
+            REQUIRE(sats.count == 10);
+            REQUIRE(sats.talker[0] == Talker::GPS);
+            REQUIRE(sats.prn[0] == 3);
+            REQUIRE(sats.elevation[0] == 3);
+            REQUIRE(sats.azimuth[0] == 111);
+            REQUIRE(sats.snr[0] == 0);
+            REQUIRE(sats.prn[5] == 16);
+            REQUIRE(sats.elevation[5] == 57);
+            REQUIRE(sats.azimuth[5] == 208);
+            REQUIRE(sats.snr[5] == 39);
+            REQUIRE(sats.prn[9] == 24);
+            REQUIRE(sats.azimuth[9] == 311);
+            REQUIRE(sats.snr[9] == 43);
+        }
+
+        SECTION("It should keep rows of other talkers")
+        {
+            const std::string glgsv("$GLGSV,1,1,02,65,10,045,30,72,80,180,*63\r\n");
+
+            GpsSatelliteTable table;
+            MicroGps gps;
+            gps.set_satellite_table(&table);
+
+            feed(gps, gsv_1);
+            feed(gps, gsv_2);
+            feed(gps, gsv_3);
+            REQUIRE(feed(gps, glgsv));
+            REQUIRE(gps.good());
+
+            const auto &sats = table.satellites();
+            REQUIRE(sats.count == 12);
+            REQUIRE(sats.talker[10] == Talker::GLONASS);
+            REQUIRE(sats.prn[10] == 65);
+            REQUIRE(sats.snr[10] == 30);
+            REQUIRE(sats.prn[11] == 72);
+            REQUIRE(sats.elevation[11] == 80);
+            REQUIRE(sats.snr[11] == 0);
+
+            // A new GPS cycle replaces only the GPS rows.
+            feed(gps, gsv_1);
+            feed(gps, gsv_2);
+            feed(gps, gsv_3);
+            REQUIRE(table.satellites().count == 12);
+            REQUIRE(table.satellites().talker[0] == Talker::GLONASS);
+            REQUIRE(table.satellites().talker[2] == Talker::GPS);
+        }
+
+        SECTION("It should ignore a trailing signal ID")
+        {
+            const std::string msg("$GPGSV,1,1,01,05,10,045,30,1*53\r\n");
+
+            GpsSatelliteTable table;
+            MicroGps gps;
+            gps.set_satellite_table(&table);
+
+            REQUIRE(feed(gps, msg));
+            REQUIRE(gps.good());
+            REQUIRE(table.satellites().count == 1);
+            REQUIRE(table.satellites().prn[0] == 5);
+        }
+
+        SECTION("It should drop cycles with a bad part")
+        {
+            const std::string bad_2("$GPGSV,3,2,10,14,25,170,00,16,57,208,39,18,67,296,40,19,40,246,00*00\r\n");
+
+            GpsSatelliteTable table;
+            MicroGps gps;
+            gps.set_satellite_table(&table);
+
+            feed(gps, gsv_1);
+            feed(gps, bad_2);
+            REQUIRE(gps.bad());
+            feed(gps, gsv_3);
+            REQUIRE(table.satellites().count == 0);
+        }
+
+        SECTION("It should drop cycles with a missing part")
+        {
+            GpsSatelliteTable table;
+            MicroGps gps;
+            gps.set_satellite_table(&table);
+
+            feed(gps, gsv_1);
+            feed(gps, gsv_3);
+            REQUIRE(table.satellites().count == 0);
+
+            // Truncated part, never terminated.
+            feed(gps, gsv_1);
+            feed(gps, gsv_2.substr(0, 20));
+            feed(gps, gsv_3);
+            REQUIRE(table.satellites().count == 0);
+        }
+
+        SECTION("It should drop the sentence being collected when the table is detached")
+        {
+            GpsSatelliteTable table;
+            MicroGps gps;
+            gps.set_satellite_table(&table);
+
+            feed(gps, gsv_1.substr(0, 30));
+            gps.set_satellite_table(nullptr);
+            REQUIRE_FALSE(feed(gps, gsv_1.substr(30)));
+            REQUIRE(gps.bad());
+
+            // Later GSV sentences are skipped like unknown ones.
+            REQUIRE_FALSE(feed(gps, gsv_1));
+            REQUIRE(table.satellites().count == 0);
+        }
+    }
+
+} // namespace MicroGpsSatellites_tests
+} // namespace scottz0r
@@ -0,0 +1,148 @@
+#include "host/MicroGpsSerial.h"
+#include "host/MicroGpsGenerator.h"
+#include "MicroGpsPortTesting.h"
+#include "catch.hpp"
+#include <fcntl.h>
+#include <string>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsSerial_tests
+{
+    using namespace scottz0r::gps;
+    using namespace scottz0r::MicroGpsPort_testing;
+
+    TEST_CASE("configure_serial_port")
+    {
+        SECTION("It should make a terminal raw and non-blocking")
+        {
+            PseudoTerminal terminal;
+            REQUIRE(configure_serial_port(terminal.slave, 115200));
+
+            struct termios options;
+            REQUIRE(tcgetattr(terminal.slave, &options) == 0);
+            REQUIRE_FALSE(options.c_lflag & ICANON);
+            REQUIRE_FALSE(options.c_lflag & ECHO);
+            REQUIRE_FALSE(options.c_iflag & ICRNL);
+            REQUIRE(cfgetispeed(&options) == B115200);
+            REQUIRE(fcntl(terminal.slave, F_GETFL) & O_NONBLOCK);
+        }
+
+        SECTION("It should reject files that are not terminals and unknown rates")
+        {
+            int fds[2];
+            REQUIRE(pipe(fds) == 0);
+            REQUIRE_FALSE(configure_serial_port(fds[0], 0));
+            ::close(fds[0]);
+            ::close(fds[1]);
+
+            PseudoTerminal terminal;
+            REQUIRE_FALSE(configure_serial_port(terminal.slave, 12345));
+        }
+    }
+
+    TEST_CASE("GpsSerialIngest")
+    {
+        Batches batches;
+        GpsSerialIngest ingest(collect, &batches, 4096);
+
+        SECTION("It should parse many ports from one loop")
+        {
+            constexpr size_type ports = 8;
+            constexpr size_type epochs = 200;
+
+            std::vector<PseudoTerminal> terminals(ports);
+            std::vector<std::string> traffic(ports);
+            std::vector<size_t> written(ports, 0);
+            for (size_type i = 0; i < ports; ++i)
+            {
+                REQUIRE(ingest.add_port(terminals[i].path.c_str(), 115200) == (int)i);
+                GpsTrafficGenerator(i + 1).generate(epochs, traffic[i]);
+            }
+            REQUIRE(ingest.port_count() == ports);
+
+            // Feed the ports in uneven pieces, as far as the terminal buffers take them, and run the loop.
+            unsigned iterations = 0;
+            while (batches.fixes.size() < ports * epochs && iterations < 100000)
+            {
+                for (size_type i = 0; i < ports; ++i)
+                {
+                    size_t piece = 100 + i * 37;
+                    if (written[i] < traffic[i].size())
+                    {
+                        size_t size = traffic[i].size() - written[i] < piece ? traffic[i].size() - written[i] : piece;
+                        ssize_t result = write(terminals[i].master, traffic[i].data() + written[i], size);
+                        if (result > 0)
+                        {
+                            written[i] += (size_t)result;
+                        }
+                    }
+                }
+
+                REQUIRE(ingest.poll(10) >= 0);
+                ++iterations;
+            }
+
+            REQUIRE(batches.fixes.size() == ports * epochs);
+            REQUIRE(batches.calls <= iterations);
+
+            // Fixes of each port arrive in order.
+            std::vector<uint32_t> next_ms(ports, 12 * 3600000);
+            for (const auto &fix : batches.fixes)
+            {
+                REQUIRE(fix.position.time_ms == next_ms[fix.port]);
+                next_ms[fix.port] += 1000;
+            }
+
+            for (size_type i = 0; i < ports; ++i)
+            {
+                REQUIRE(ingest.bytes_read(i) == traffic[i].size());
+                REQUIRE(ingest.fix_count(i) == epochs);
+            }
+        }
+
+        SECTION("It should close a port that hangs up")
+        {
+            PseudoTerminal terminal;
+            int port = ingest.add_port(terminal.path.c_str());
+            REQUIRE(port == 0);
+            ::close(terminal.slave);
+            terminal.slave = -1;
+
+            terminal.close_master();
+            for (int i = 0; i < 10 && ingest.is_open(0); ++i)
+            {
+                ingest.poll(10);
+            }
+            REQUIRE_FALSE(ingest.is_open(0));
+            REQUIRE_FALSE(ingest.remove_port(0));
+        }
+
+        SECTION("It should read other fds and remove ports")
+        {
+            int fds[2];
+            REQUIRE(pipe(fds) == 0);
+            REQUIRE(ingest.add_fd(fds[0]) == 0);
+
+            std::string traffic;
+            GpsTrafficGenerator().generate(3, traffic);
+            REQUIRE(write(fds[1], traffic.data(), traffic.size()) == (ssize_t)traffic.size());
+
+            REQUIRE(ingest.poll(100) == 3);
+            REQUIRE(batches.calls == 1);
+            REQUIRE(batches.fixes.size() == 3);
+
+            REQUIRE(ingest.remove_port(0));
+            REQUIRE_FALSE(ingest.is_open(0));
+            REQUIRE(ingest.poll(0) == 0);
+            ::close(fds[1]);
+
+            REQUIRE(ingest.add_port("/nonexistent/tty") == -1);
+        }
+    }
+
+} // namespace MicroGpsSerial_tests
+} // namespace scottz0r
@@ -0,0 +1,232 @@
+#include "MicroGpsSimplify.h"
+#include "catch.hpp"
+#include <math.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsSimplify_tests
+{
+    using namespace scottz0r::gps;
+
+    constexpr double origin_latitude = 38.9;
+    constexpr double origin_longitude = -94.7;
+
+    /// Fix at an east/north offset in meters from the origin. time_ms is the index of the fix.
+    static GpsPosition make_fix(uint32_t index, double east, double north)
+    {
+        GpsPosition position = {};
+        position.time_ms = index;
+        position.fields = 0xFF;
+        position.latitude = (float)(origin_latitude + north / meters_per_degree);
+        position.longitude =
+            (float)(origin_longitude + east / (meters_per_degree * cos(origin_latitude * radians_per_degree)));
+        return position;
+    }
+
+    /// East and north of a fix in meters from the origin, in double precision.
+    static void to_meters(const GpsPosition &position, double &east, double &north)
+    {
+        north = (position.latitude - origin_latitude) * meters_per_degree;
+        east = (position.longitude - origin_longitude) * meters_per_degree * cos(origin_latitude * radians_per_degree);
+    }
+
+    /// Distance of p from the segment a-b, in meters.
+    static double segment_distance(const GpsPosition &p, const GpsPosition &a, const GpsPosition &b)
+    {
+        double px, py, ax, ay, bx, by;
+        to_meters(p, px, py);
+        to_meters(a, ax, ay);
+        to_meters(b, bx, by);
+
+        double dx = bx - ax;
+        double dy = by - ay;
+        double length = dx * dx + dy * dy;
+        double t = length > 0 ? ((px - ax) * dx + (py - ay) * dy) / length : 0;
+        t = t < 0 ? 0 : (t > 1 ? 1 : t);
+        return hypot(px - (ax + t * dx), py - (ay + t * dy));
+    }
+
+    static std::vector<GpsPosition> simplify(GpsTrackSimplifier &simplifier, const std::vector<GpsPosition> &track)
+    {
+        std::vector<GpsPosition> vertices;
+        for (const auto &fix : track)
+        {
+            if (simplifier.update(fix))
+            {
+                vertices.push_back(simplifier.vertex());
+            }
+        }
+        if (simplifier.flush())
+        {
+            vertices.push_back(simplifier.vertex());
+        }
+        return vertices;
+    }
+
+    /// Every fix must be a vertex or within the tolerance (plus float rounding of the coordinates) of the segment
+    /// between the vertices around it.
+    static void require_within(const std::vector<GpsPosition> &track, const std::vector<GpsPosition> &vertices,
+                               double tolerance)
+    {
+        REQUIRE(vertices.front().time_ms == track.front().time_ms);
+        REQUIRE(vertices.back().time_ms == track.back().time_ms);
+
+        size_t v = 0;
+        for (const auto &fix : track)
+        {
+            if (fix.time_ms == vertices[v].time_ms)
+            {
+                ++v;
+                continue;
+            }
+            REQUIRE(v > 0);
+            REQUIRE(v < vertices.size());
+            REQUIRE(segment_distance(fix, vertices[v - 1], vertices[v]) <= tolerance + 0.5);
+        }
+        REQUIRE(v == vertices.size());
+    }
+
+    TEST_CASE("GpsTrackSimplifier")
+    {
+        SECTION("It should reduce a noisy straight line to its ends")
+        {
+            std::vector<GpsPosition> track;
+            for (uint32_t i = 0; i < 500; ++i)
+            {
+                track.push_back(make_fix(i, i * 3.0, i * 4.0 + ((i * 7919) % 5) * 0.5 - 1));
+            }
+
+            GpsTrackSimplifier simplifier(5);
+            std::vector<GpsPosition> vertices = simplify(simplifier, track);
+            REQUIRE(vertices.size() == 2);
+            require_within(track, vertices, 5);
+        }
+
+        SECTION("It should keep the corners of a turning track")
+        {
+            // Square with 200 m sides, one fix every 5 m.
+            std::vector<GpsPosition> track;
+            const double corners[5][2] = {{0, 0}, {200, 0}, {200, 200}, {0, 200}, {0, 0}};
+            for (uint32_t side = 0; side < 4; ++side)
+            {
+                for (uint32_t step = 0; step < 40; ++step)
+                {
+                    double t = step / 40.0;
+                    double east = corners[side][0] + t * (corners[side + 1][0] - corners[side][0]);
+                    double north = corners[side][1] + t * (corners[side + 1][1] - corners[side][1]);
+                    track.push_back(make_fix((uint32_t)track.size(), east, north));
+                }
+            }
+            track.push_back(make_fix((uint32_t)track.size(), 0, 0));
+
+            GpsTrackSimplifier simplifier(2);
+            std::vector<GpsPosition> vertices = simplify(simplifier, track);
+            REQUIRE(vertices.size() == 5);
+            for (size_t i = 0; i < vertices.size(); ++i)
+            {
+                REQUIRE(vertices[i].time_ms == i * 40);
+            }
+            require_within(track, vertices, 2);
+        }
+
+        SECTION("It should stay within the tolerance on a random walk")
+        {
+            uint32_t state = 12345;
+            double east = 0, north = 0, heading = 0;
+            std::vector<GpsPosition> track;
+            for (uint32_t i = 0; i < 5000; ++i)
+            {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                heading += ((double)(state % 1000) / 1000 - 0.5) * 0.6;
+                east += 10 * sin(heading);
+                north += 10 * cos(heading);
+                track.push_back(make_fix(i, east, north));
+            }
+
+            for (float tolerance : {1.0f, 5.0f, 20.0f})
+            {
+                GpsTrackSimplifier simplifier(tolerance);
+                std::vector<GpsPosition> vertices = simplify(simplifier, track);
+                require_within(track, vertices, tolerance);
+                REQUIRE(vertices.size() < track.size() / 2);
+            }
+        }
+
+        SECTION("It should not end a segment short of a skipped fix")
+        {
+            // The last fix is in the cone, but 4.7 m closer to the anchor than the second one.
+            std::vector<GpsPosition> track = {make_fix(0, 0, 0), make_fix(1, 100, 4.9), make_fix(2, 95.3, 0)};
+
+            GpsTrackSimplifier simplifier(5);
+            std::vector<GpsPosition> vertices = simplify(simplifier, track);
+            REQUIRE(vertices.size() == 3);
+            require_within(track, vertices, 5);
+        }
+
+        SECTION("It should stay within the tolerance on a slow jittering track")
+        {
+            // 0.3 m per fix with up to 4 m of jitter on each axis, so fixes often step back toward the anchor.
+            uint32_t state = 2024;
+            std::vector<GpsPosition> track;
+            for (uint32_t i = 0; i < 20000; ++i)
+            {
+                double jitter[2];
+                for (double &value : jitter)
+                {
+                    state ^= state << 13;
+                    state ^= state >> 17;
+                    state ^= state << 5;
+                    value = ((double)(state % 1000) / 500 - 1) * 4;
+                }
+                track.push_back(make_fix(i, i * 0.3 + jitter[0], 50 * sin(i * 0.0005) + jitter[1]));
+            }
+
+            GpsTrackSimplifier simplifier(5);
+            require_within(track, simplify(simplifier, track), 5);
+        }
+
+        SECTION("It should close a segment after the window")
+        {
+            std::vector<GpsPosition> track;
+            for (uint32_t i = 0; i <= 100; ++i)
+            {
+                track.push_back(make_fix(i, 0, i * 10.0));
+            }
+
+            GpsTrackSimplifier simplifier(5, 25);
+            std::vector<GpsPosition> vertices = simplify(simplifier, track);
+            REQUIRE(vertices.size() == 5);
+            for (size_t i = 0; i < vertices.size(); ++i)
+            {
+                REQUIRE(vertices[i].time_ms == i * 25);
+            }
+        }
+
+        SECTION("It should skip fixes without coordinates and restart after flush")
+        {
+            GpsTrackSimplifier simplifier;
+            GpsPosition empty = {};
+            REQUIRE_FALSE(simplifier.update(empty));
+            REQUIRE_FALSE(simplifier.flush());
+
+            REQUIRE(simplifier.update(make_fix(0, 0, 0)));
+            REQUIRE_FALSE(simplifier.flush());
+
+            REQUIRE(simplifier.update(make_fix(1, 0, 0)));
+            REQUIRE_FALSE(simplifier.update(make_fix(2, 0, 10)));
+            REQUIRE_FALSE(simplifier.update(empty));
+            REQUIRE(simplifier.flush());
+            REQUIRE(simplifier.vertex().time_ms == 2);
+
+            simplifier.update(make_fix(3, 0, 0));
+            simplifier.update(make_fix(4, 0, 10));
+            simplifier.reset();
+            REQUIRE_FALSE(simplifier.flush());
+        }
+    }
+
+} // namespace MicroGpsSimplify_tests
+} // namespace scottz0r
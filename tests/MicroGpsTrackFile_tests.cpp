@@ -0,0 +1,245 @@
+#include "host/MicroGpsTrackFile.h"
+#include "catch.hpp"
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsTrackFile_tests
+{
+    using namespace scottz0r::gps;
+
+    /// Temporary file that is removed when the test ends.
+    class TempFile
+    {
+    public:
+        TempFile()
+        {
+            char path[] = "/tmp/MicroGpsTrackFile_XXXXXX";
+            int fd = mkstemp(path);
+            REQUIRE(fd >= 0);
+            ::close(fd);
+            m_path = path;
+        }
+
+        ~TempFile()
+        {
+            unlink(m_path.c_str());
+        }
+
+        const char *path() const
+        {
+            return m_path.c_str();
+        }
+
+    private:
+        std::string m_path;
+    };
+
+    struct Fix
+    {
+        FixedGpsPosition position;
+        uint64_t utc_ms;
+    };
+
+    static void collect(const FixedGpsPosition &position, uint64_t utc_ms, void *context)
+    {
+        static_cast<std::vector<Fix> *>(context)->push_back({position, utc_ms});
+    }
+
+    /// A 1 Hz track starting 30 minutes before midnight of 2024-11-19.
+    static std::vector<Fix> make_track(size_type count)
+    {
+        const unsigned short date = pack_date(2024, 11, 19);
+        const uint64_t start = utc_epoch_ms(date, 0) + 86400000ULL - 1800000;
+
+        std::vector<Fix> track;
+        for (size_type i = 0; i < count; ++i)
+        {
+            FixedGpsPosition position = {};
+            uint64_t utc_ms = start + i * 1000ULL;
+            position.time_ms = (uint32_t)(utc_ms % 86400000ULL);
+            uint32_t seconds = position.time_ms / 1000;
+            position.timestamp = (seconds / 3600) * 10000 + (seconds / 60 % 60) * 100 + seconds % 60;
+            position.fields = 0xFF;
+            position.fix_quality = 1;
+            position.number_satellites = 9;
+            position.latitude = 389145533 + (int32_t)i * 137;
+            position.longitude = -947561333 - (int32_t)i * 211;
+            position.altitude_msl = 243900;
+            track.push_back({position, utc_ms});
+        }
+        return track;
+    }
+
+    static void write_track(const char *path, const std::vector<Fix> &track, size_type block_size, size_type stride)
+    {
+        GpsTrackFileWriter writer(block_size, stride);
+        REQUIRE(writer.open(path));
+        for (const auto &fix : track)
+        {
+            // The date changes at midnight, like the RMC date would.
+            unsigned short date = fix.utc_ms >= utc_epoch_ms(pack_date(2024, 11, 20), 0) ? pack_date(2024, 11, 20)
+                                                                                          : pack_date(2024, 11, 19);
+            REQUIRE(writer.append(fix.position, date));
+        }
+        REQUIRE(writer.close());
+    }
+
+    TEST_CASE("GpsTrackFile")
+    {
+        TempFile file;
+        const std::vector<Fix> track = make_track(3600);
+
+        SECTION("It should read back every fix across blocks and midnight")
+        {
+            write_track(file.path(), track, 512, 4);
+
+            GpsTrackFileReader reader;
+            REQUIRE(reader.open(file.path()));
+            REQUIRE(reader.block_count() > 8);
+
+            std::vector<Fix> fixes;
+            REQUIRE(reader.query(0, UINT64_MAX, collect, &fixes) == track.size());
+            REQUIRE(fixes.size() == track.size());
+            for (size_type i = 0; i < track.size(); ++i)
+            {
+                REQUIRE(fixes[i].utc_ms == track[i].utc_ms);
+                REQUIRE(fixes[i].position.timestamp == track[i].position.timestamp);
+                REQUIRE(fixes[i].position.latitude == track[i].position.latitude);
+                REQUIRE(fixes[i].position.longitude == track[i].position.longitude);
+            }
+        }
+
+        SECTION("It should summarize each block in its header")
+        {
+            write_track(file.path(), track, 512, 4);
+
+            GpsTrackFileReader reader;
+            REQUIRE(reader.open(file.path()));
+
+            size_type total = 0;
+            for (size_type block = 0; block < reader.block_count(); ++block)
+            {
+                GpsTrackBlockHeader header;
+                REQUIRE(reader.block_header(block, header));
+                REQUIRE(header.first_ms <= header.last_ms);
+                REQUIRE(header.payload_size <= 512 - 40);
+
+                size_type first = total;
+                total += header.count;
+                REQUIRE(header.first_ms == track[first].utc_ms);
+                REQUIRE(header.last_ms == track[total - 1].utc_ms);
+
+                // Latitude increases and longitude decreases along the track.
+                REQUIRE(header.min_latitude == track[first].position.latitude);
+                REQUIRE(header.max_latitude == track[total - 1].position.latitude);
+                REQUIRE(header.min_longitude == track[total - 1].position.longitude);
+                REQUIRE(header.max_longitude == track[first].position.longitude);
+            }
+            REQUIRE(total == track.size());
+
+            GpsTrackBlockHeader header;
+            REQUIRE_FALSE(reader.block_header(reader.block_count(), header));
+        }
+
+        SECTION("It should query a time range through the sparse index")
+        {
+            write_track(file.path(), track, 512, 4);
+
+            GpsTrackFileReader reader;
+            REQUIRE(reader.open(file.path()));
+
+            uint64_t begin = track[1795].utc_ms;
+            uint64_t end = track[1810].utc_ms;
+
+            size_type block = reader.find_block(begin);
+            GpsTrackBlockHeader header;
+            REQUIRE(reader.block_header(block, header));
+            REQUIRE(header.first_ms <= begin);
+            REQUIRE(header.last_ms >= begin);
+
+            std::vector<Fix> fixes;
+            REQUIRE(reader.query(begin, end, collect, &fixes) == 15);
+            REQUIRE(fixes.front().utc_ms == begin);
+            REQUIRE(fixes.back().utc_ms == track[1809].utc_ms);
+
+            fixes.clear();
+            REQUIRE(reader.query(0, track[0].utc_ms, collect, &fixes) == 0);
+            REQUIRE(reader.find_block(track.back().utc_ms + 1) == reader.block_count());
+        }
+
+        SECTION("It should decode a single block")
+        {
+            write_track(file.path(), track, 4096, 16);
+
+            GpsTrackFileReader reader;
+            REQUIRE(reader.open(file.path()));
+
+            GpsTrackBlockHeader header;
+            REQUIRE(reader.block_header(1, header));
+
+            std::vector<Fix> fixes;
+            REQUIRE(reader.decode_block(1, collect, &fixes) == header.count);
+            REQUIRE(fixes.front().utc_ms == header.first_ms);
+        }
+
+        SECTION("It should continue tracks without a date across midnight")
+        {
+            GpsTrackFileWriter writer(512, 4);
+            REQUIRE(writer.open(file.path()));
+            for (const auto &fix : track)
+            {
+                REQUIRE(writer.append(fix.position, 0));
+            }
+            REQUIRE(writer.close());
+
+            GpsTrackFileReader reader;
+            REQUIRE(reader.open(file.path()));
+
+            std::vector<Fix> fixes;
+            REQUIRE(reader.query(0, UINT64_MAX, collect, &fixes) == track.size());
+            const uint64_t first_day = utc_epoch_ms(pack_date(2024, 11, 19), 0);
+            for (size_type i = 0; i < track.size(); ++i)
+            {
+                REQUIRE(fixes[i].utc_ms == track[i].utc_ms - first_day);
+            }
+        }
+
+        SECTION("It should reject fixes out of order or without a time")
+        {
+            GpsTrackFileWriter writer;
+            REQUIRE_FALSE(writer.append(track[0].position, 0));
+            REQUIRE(writer.open(file.path()));
+            REQUIRE(writer.append(track[1].position, pack_date(2024, 11, 19)));
+            REQUIRE_FALSE(writer.append(track[0].position, pack_date(2024, 11, 19)));
+            REQUIRE_FALSE(writer.append(track[0].position, 0));
+
+            FixedGpsPosition no_time = track[2].position;
+            no_time.fields = 0;
+            REQUIRE_FALSE(writer.append(no_time, pack_date(2024, 11, 19)));
+            REQUIRE(writer.close());
+
+            GpsTrackFileReader reader;
+            REQUIRE(reader.open(file.path()));
+            REQUIRE(reader.block_count() == 1);
+        }
+
+        SECTION("It should reject files that are not complete track files")
+        {
+            write_track(file.path(), track, 512, 4);
+            REQUIRE(truncate(file.path(), 1000) == 0);
+
+            GpsTrackFileReader reader;
+            REQUIRE_FALSE(reader.open(file.path()));
+            REQUIRE_FALSE(reader.open("/nonexistent/track"));
+
+            GpsTrackFileWriter writer(16);
+            REQUIRE_FALSE(writer.open(file.path()));
+        }
+    }
+
+} // namespace MicroGpsTrackFile_tests
+} // namespace scottz0r
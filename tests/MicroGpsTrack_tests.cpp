@@ -0,0 +1,252 @@
+#include "MicroGpsTrack.h"
+#include "catch.hpp"
+#include <string>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsTrack_tests
+{
+    using namespace scottz0r::gps;
+
+    constexpr unsigned char all_fields = 0xFF;
+
+    /// Build a fixed point record with a timestamp consistent with time_ms, like the parser produces.
+    static FixedGpsPosition make_position(uint32_t time_ms, int32_t latitude, int32_t longitude)
+    {
+        FixedGpsPosition position = {};
+        uint32_t seconds = time_ms / 1000;
+        position.timestamp = (seconds / 3600) * 10000 + (seconds / 60 % 60) * 100 + seconds % 60;
+        position.time_ms = time_ms;
+        position.talker = Talker::GNSS;
+        position.fix_quality = 1;
+        position.number_satellites = 9;
+        position.fields = all_fields;
+        position.latitude = latitude;
+        position.longitude = longitude;
+        position.horizontal_dilution = 1200;
+        position.altitude_msl = 243900;
+        position.geoid_height = -30100;
+        return position;
+    }
+
+    static void require_equal(const FixedGpsPosition &lhs, const FixedGpsPosition &rhs)
+    {
+        REQUIRE(lhs.timestamp == rhs.timestamp);
+        REQUIRE(lhs.time_ms == rhs.time_ms);
+        REQUIRE(lhs.talker == rhs.talker);
+        REQUIRE(lhs.fix_quality == rhs.fix_quality);
+        REQUIRE(lhs.number_satellites == rhs.number_satellites);
+        REQUIRE(lhs.fields == rhs.fields);
+        REQUIRE(lhs.latitude == rhs.latitude);
+        REQUIRE(lhs.longitude == rhs.longitude);
+        REQUIRE(lhs.horizontal_dilution == rhs.horizontal_dilution);
+        REQUIRE(lhs.altitude_msl == rhs.altitude_msl);
+        REQUIRE(lhs.geoid_height == rhs.geoid_height);
+    }
+
+    /// Encode a track, decode it and require an exact round trip. Returns the encoded size.
+    static size_type round_trip(const std::vector<FixedGpsPosition> &track)
+    {
+        std::vector<char> encoded(track.size() * track_record_max_size);
+
+        GpsTrackEncoder encoder;
+        size_type size = 0;
+        for (const auto &position : track)
+        {
+            size_type written = encoder.encode(position, encoded.data() + size, (size_type)encoded.size() - size);
+            REQUIRE(written > 0);
+            size += written;
+        }
+
+        GpsTrackDecoder decoder;
+        size_type offset = 0;
+        for (const auto &expected : track)
+        {
+            FixedGpsPosition decoded;
+            size_type consumed = decoder.decode(encoded.data() + offset, size - offset, decoded);
+            REQUIRE(consumed > 0);
+            require_equal(decoded, expected);
+            offset += consumed;
+        }
+        REQUIRE(offset == size);
+
+        return size;
+    }
+
+    TEST_CASE("GpsTrackEncoder")
+    {
+        SECTION("It should round trip a moving track exactly and compactly")
+        {
+            std::vector<FixedGpsPosition> track;
+            for (uint32_t i = 0; i < 600; ++i)
+            {
+                FixedGpsPosition position =
+                    make_position(56181000 + i * 1000, 389145533 + (int32_t)i * 137, -947561333 - (int32_t)i * 211);
+                position.number_satellites = (unsigned char)(8 + (i / 60) % 3);
+                position.altitude_msl += (int32_t)(i % 7) * 100;
+                track.push_back(position);
+            }
+
+            size_type size = round_trip(track);
+
+            // Raw NMEA is about 75 bytes per fix and a GpsPosition is 32.
+            REQUIRE(size / track.size() <= 12);
+        }
+
+        SECTION("It should round trip missing fields and keep predicting across gaps")
+        {
+            std::vector<FixedGpsPosition> track;
+            track.push_back(make_position(1000, 389145533, -947561333));
+
+            FixedGpsPosition no_fix = {};
+            no_fix.time_ms = 2000;
+            no_fix.timestamp = 2;
+            no_fix.fields = position_field_bit(PositionField::Time) | position_field_bit(PositionField::FixQuality) |
+                            position_field_bit(PositionField::Satellites);
+            track.push_back(no_fix);
+
+            track.push_back(make_position(3000, 389145540, -947561340));
+
+            round_trip(track);
+        }
+
+        SECTION("It should round trip extreme deltas across the antimeridian and midnight")
+        {
+            std::vector<FixedGpsPosition> track;
+            track.push_back(make_position(86399900, -899999999, 1799999999));
+            track.push_back(make_position(0, 899999999, -1799999999));
+            track.push_back(make_position(100, 0, 0));
+
+            FixedGpsPosition talker = make_position(200, 1, 1);
+            talker.talker = Talker::NavIC;
+            talker.fix_quality = 8;
+            talker.number_satellites = 99;
+            track.push_back(talker);
+
+            round_trip(track);
+        }
+
+        SECTION("It should not encode into a buffer that is too small")
+        {
+            GpsTrackEncoder encoder;
+            char small[4];
+            char large[track_record_max_size];
+
+            FixedGpsPosition position = make_position(56181000, 389145533, -947561333);
+            REQUIRE(encoder.encode(position, small, sizeof(small)) == 0);
+
+            // The failed record must not change the prediction state.
+            size_type size = encoder.encode(position, large, sizeof(large));
+            REQUIRE(size > sizeof(small));
+
+            GpsTrackDecoder decoder;
+            FixedGpsPosition decoded;
+            REQUIRE(decoder.decode(large, size, decoded) == size);
+            require_equal(decoded, position);
+
+            // A buffer that exactly fits a record is used without the unchecked fast path.
+            std::vector<char> exact(size);
+            GpsTrackEncoder exact_encoder;
+            REQUIRE(exact_encoder.encode(position, exact.data(), size) == size);
+        }
+    }
+
+    TEST_CASE("GpsTrackDecoder")
+    {
+        SECTION("It should reject truncated records")
+        {
+            GpsTrackEncoder encoder;
+            char encoded[track_record_max_size];
+            FixedGpsPosition position = make_position(56181000, 389145533, -947561333);
+            size_type size = encoder.encode(position, encoded, sizeof(encoded));
+
+            for (size_type i = 0; i < size; ++i)
+            {
+                GpsTrackDecoder decoder;
+                FixedGpsPosition decoded = {};
+                REQUIRE(decoder.decode(encoded, i, decoded) == 0);
+                REQUIRE(decoded.time_ms == 0);
+            }
+        }
+
+        SECTION("It should decode independently after matching resets")
+        {
+            GpsTrackEncoder encoder;
+            char first[track_record_max_size];
+            char second[track_record_max_size];
+
+            encoder.encode(make_position(1000, 10, 10), first, sizeof(first));
+            encoder.reset();
+            size_type size = encoder.encode(make_position(2000, 20, 20), second, sizeof(second));
+
+            GpsTrackDecoder decoder;
+            FixedGpsPosition decoded;
+            REQUIRE(decoder.decode(second, size, decoded) == size);
+            require_equal(decoded, make_position(2000, 20, 20));
+        }
+
+        SECTION("It should round trip floating point positions to fixed point resolution")
+        {
+            GpsPosition position = {};
+            position.time_ms = 56181000;
+            position.timestamp = 153621;
+            position.fields = all_fields;
+            position.latitude = 38.9145533f;
+            position.longitude = -94.7561333f;
+            position.horizontal_dilution = 2.07f;
+            position.altitude_msl = 243.9f;
+            position.geoid_height = -30.1f;
+
+            GpsTrackEncoder encoder;
+            GpsTrackDecoder decoder;
+            char encoded[track_record_max_size];
+            GpsPosition decoded;
+
+            size_type size = encoder.encode(position, encoded, sizeof(encoded));
+            REQUIRE(decoder.decode(encoded, size, decoded) == size);
+            REQUIRE(decoded.latitude == Approx(position.latitude));
+            REQUIRE(decoded.longitude == Approx(position.longitude));
+            REQUIRE(decoded.horizontal_dilution == Approx(2.07f));
+            REQUIRE(decoded.altitude_msl == Approx(243.9f));
+            REQUIRE(decoded.geoid_height == Approx(-30.1f));
+            REQUIRE(decoded.timestamp == 153621);
+        }
+    }
+
+    TEST_CASE("_detail::varint")
+    {
+        SECTION("It should round trip values at byte boundaries")
+        {
+            const uint32_t values[] = {0, 1, 127, 128, 16383, 16384, 0xFFFFFFFF};
+            const size_type sizes[] = {1, 1, 1, 2, 2, 3, 5};
+
+            for (size_type i = 0; i < 7; ++i)
+            {
+                char buffer[5];
+                uint32_t value = 0;
+                REQUIRE(_detail::varint_write(values[i], buffer) == sizes[i]);
+                REQUIRE(_detail::varint_read(buffer, buffer + sizes[i], value) == sizes[i]);
+                REQUIRE(value == values[i]);
+            }
+        }
+
+        SECTION("It should reject varints longer than 5 bytes")
+        {
+            const char buffer[] = {(char)0x80, (char)0x80, (char)0x80, (char)0x80, (char)0x80, 0x01};
+            uint32_t value;
+            REQUIRE(_detail::varint_read(buffer, buffer + sizeof(buffer), value) == 0);
+        }
+
+        SECTION("It should zigzag small magnitudes to small values")
+        {
+            REQUIRE(_detail::zigzag_encode(0) == 0);
+            REQUIRE(_detail::zigzag_encode(-1) == 1);
+            REQUIRE(_detail::zigzag_encode(1) == 2);
+            REQUIRE(_detail::zigzag_decode(_detail::zigzag_encode(-2147483647 - 1)) == -2147483647 - 1);
+            REQUIRE(_detail::zigzag_decode(_detail::zigzag_encode(2147483647)) == 2147483647);
+        }
+    }
+
+} // namespace MicroGpsTrack_tests
+} // namespace scottz0r
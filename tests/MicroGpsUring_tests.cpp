@@ -0,0 +1,232 @@
+#include "host/MicroGpsUring.h"
+#include "host/MicroGpsGenerator.h"
+#include "MicroGpsPortTesting.h"
+#include "catch.hpp"
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace scottz0r
+{
+namespace MicroGpsUring_tests
+{
+    using namespace scottz0r::gps;
+    using namespace scottz0r::MicroGpsPort_testing;
+
+    static void require_in_order(const std::vector<GpsPortFix> &fixes, size_type ports)
+    {
+        std::vector<uint32_t> next_ms(ports, 12 * 3600000);
+        for (const auto &fix : fixes)
+        {
+            REQUIRE(fix.position.time_ms == next_ms[fix.port]);
+            next_ms[fix.port] += 1000;
+        }
+    }
+
+    TEST_CASE("GpsUringIngest")
+    {
+        // Every case runs on both loops. io_uring may be unavailable (old kernel, seccomp); the loop must then fall
+        // back to epoll with the same results.
+        bool allow_uring = GENERATE(false, true);
+        Batches batches;
+        GpsUringIngest ingest(collect, &batches, allow_uring, 1024, 16);
+        if (!allow_uring)
+        {
+            REQUIRE(ingest.backend() == GpsIngestBackend::Epoll);
+        }
+
+        SECTION("It should parse pseudo terminals")
+        {
+            constexpr size_type ports = 4;
+            constexpr size_type epochs = 100;
+
+            std::vector<PseudoTerminal> terminals(ports);
+            std::vector<std::string> traffic(ports);
+            std::vector<size_t> written(ports, 0);
+            for (size_type i = 0; i < ports; ++i)
+            {
+                REQUIRE(ingest.add_port(terminals[i].path.c_str(), 115200) == (int)i);
+                GpsTrafficGenerator(i + 1).generate(epochs, traffic[i]);
+            }
+
+            unsigned iterations = 0;
+            while (batches.fixes.size() < ports * epochs && iterations < 100000)
+            {
+                for (size_type i = 0; i < ports; ++i)
+                {
+                    size_t size = traffic[i].size() - written[i] < 500 ? traffic[i].size() - written[i] : 500;
+                    ssize_t result = size ? write(terminals[i].master, traffic[i].data() + written[i], size) : 0;
+                    written[i] += result > 0 ? (size_t)result : 0;
+                }
+
+                REQUIRE(ingest.poll(10) >= 0);
+                ++iterations;
+            }
+
+            REQUIRE(batches.fixes.size() == ports * epochs);
+            require_in_order(batches.fixes, ports);
+            for (size_type i = 0; i < ports; ++i)
+            {
+                REQUIRE(ingest.bytes_read(i) == traffic[i].size());
+                REQUIRE(ingest.fix_count(i) == epochs);
+            }
+        }
+
+        SECTION("It should replay log files to the end")
+        {
+            char path[] = "/tmp/MicroGpsUring_XXXXXX";
+            int fd = mkstemp(path);
+            REQUIRE(fd >= 0);
+
+            std::string traffic;
+            GpsTrafficGenerator(9).generate(1000, traffic);
+            REQUIRE(write(fd, traffic.data(), traffic.size()) == (ssize_t)traffic.size());
+            ::close(fd);
+
+            int port = ingest.add_port(path);
+            unlink(path);
+            REQUIRE(port == 0);
+
+            for (int i = 0; i < 100000 && ingest.is_open(0); ++i)
+            {
+                REQUIRE(ingest.poll(10) >= 0);
+            }
+
+            REQUIRE_FALSE(ingest.is_open(0));
+            REQUIRE(batches.fixes.size() == 1000);
+            REQUIRE(ingest.bytes_read(0) == traffic.size());
+            require_in_order(batches.fixes, 1);
+        }
+
+        SECTION("It should close ports that hang up or are removed")
+        {
+            PseudoTerminal hangup;
+            PseudoTerminal removed;
+            REQUIRE(ingest.add_port(hangup.path.c_str()) == 0);
+            REQUIRE(ingest.add_port(removed.path.c_str()) == 1);
+            REQUIRE(ingest.port_count() == 2);
+
+            ::close(hangup.slave);
+            hangup.slave = -1;
+            ::close(hangup.master);
+            hangup.master = -1;
+            for (int i = 0; i < 100 && ingest.is_open(0); ++i)
+            {
+                ingest.poll(10);
+            }
+            REQUIRE_FALSE(ingest.is_open(0));
+            REQUIRE(ingest.is_open(1));
+
+            REQUIRE(ingest.remove_port(1));
+            REQUIRE_FALSE(ingest.remove_port(1));
+            REQUIRE(write(removed.master, "$GPGGA", 6) == 6);
+            REQUIRE(ingest.poll(10) == 0);
+            REQUIRE(ingest.bytes_read(1) == 0);
+
+            REQUIRE(ingest.add_port("/nonexistent/tty") == -1);
+        }
+    }
+
+    /// @brief Print the throughput of a benchmark run.
+    static void report(const char *name, GpsUringIngest &ingest, const Batches &batches, size_t bytes,
+                       std::chrono::steady_clock::time_point start)
+    {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-6s %-5s %8.1f MB/s %10.0f fixes/s\n", name,
+               ingest.backend() == GpsIngestBackend::Uring ? "uring" : "epoll", bytes / seconds / 1e6,
+               batches.fixes.size() / seconds);
+    }
+
+    // Hidden; run with: MicroGpsTests "[.benchmark]"
+    TEST_CASE("GpsUringIngest throughput", "[.benchmark]")
+    {
+        constexpr size_type files = 8;
+        constexpr size_type file_epochs = 50000;
+        constexpr size_type ports = 16;
+        constexpr size_type port_epochs = 2000;
+
+        std::vector<std::string> paths;
+        size_t file_bytes = 0;
+        for (size_type i = 0; i < files; ++i)
+        {
+            std::string traffic;
+            GpsTrafficGenerator(i + 1).generate(file_epochs, traffic);
+
+            char path[] = "/tmp/MicroGpsUring_XXXXXX";
+            int fd = mkstemp(path);
+            REQUIRE(fd >= 0);
+            REQUIRE(write(fd, traffic.data(), traffic.size()) == (ssize_t)traffic.size());
+            ::close(fd);
+            paths.push_back(path);
+            file_bytes += traffic.size();
+        }
+
+        std::vector<std::string> traffic(ports);
+        size_t port_bytes = 0;
+        for (size_type i = 0; i < ports; ++i)
+        {
+            GpsTrafficGenerator(i + 1).generate(port_epochs, traffic[i]);
+            port_bytes += traffic[i].size();
+        }
+
+        for (bool allow_uring : {false, true})
+        {
+            Batches batches;
+            GpsUringIngest ingest(collect, &batches, allow_uring);
+            auto start = std::chrono::steady_clock::now();
+            for (const auto &path : paths)
+            {
+                REQUIRE(ingest.add_port(path.c_str()) >= 0);
+            }
+
+            bool open = true;
+            while (open)
+            {
+                ingest.poll(10);
+                open = false;
+                for (size_type i = 0; i < files; ++i)
+                {
+                    open = open || ingest.is_open(i);
+                }
+            }
+            report("file", ingest, batches, file_bytes, start);
+            REQUIRE(batches.fixes.size() == files * file_epochs);
+        }
+
+        for (bool allow_uring : {false, true})
+        {
+            Batches batches;
+            GpsUringIngest ingest(collect, &batches, allow_uring);
+            std::vector<PseudoTerminal> terminals(ports);
+            std::vector<size_t> written(ports, 0);
+            for (size_type i = 0; i < ports; ++i)
+            {
+                REQUIRE(ingest.add_port(terminals[i].path.c_str(), 115200) >= 0);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            while (batches.fixes.size() < ports * port_epochs)
+            {
+                for (size_type i = 0; i < ports; ++i)
+                {
+                    size_t size = traffic[i].size() - written[i];
+                    ssize_t result = size ? write(terminals[i].master, traffic[i].data() + written[i], size) : 0;
+                    written[i] += result > 0 ? (size_t)result : 0;
+                }
+                REQUIRE(ingest.poll(10) >= 0);
+            }
+            report("pty", ingest, batches, port_bytes, start);
+        }
+
+        for (const auto &path : paths)
+        {
+            unlink(path.c_str());
+        }
+    }
+
+} // namespace MicroGpsUring_tests
+} // namespace scottz0r
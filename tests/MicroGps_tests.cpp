@@ -34,6 +34,7 @@ namespace MicroGps_tests
             const auto &posn = gps.position_data();
 
             REQUIRE(posn.timestamp == 153621);
+            REQUIRE(posn.time_ms == 56181000);
             REQUIRE(posn.latitude == Approx(38.0f + (54.8732f / 60.0f)));
             REQUIRE(posn.longitude == Approx(-1.0f * (94.0f + (45.3680f / 60.f))));
             REQUIRE(posn.fix_quality == 1);
@@ -65,6 +66,7 @@ namespace MicroGps_tests
             const auto &posn = gps.position_data();
 
             REQUIRE(posn.timestamp == 152541);
+            REQUIRE(posn.time_ms == 55541096);
             REQUIRE(posn.latitude == 0.0f);
             REQUIRE(posn.longitude == 0.0f);
             REQUIRE(posn.fix_quality == 0);
@@ -148,6 +150,386 @@ namespace MicroGps_tests
             REQUIRE(gps.good());
             REQUIRE_FALSE(gps.bad());
         }
+
+        SECTION("It should process GGA messages from any talker")
+        {
+            const std::string msg_0("$GNGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*45\r\n");
+            const std::string msg_1("$GLGGA,153621.000,3854.8732,N,09445.3680,W,2,11,0.90,243.9,M,-30.1,M,,*4C\r\n");
+
+            MicroGps gps;
+
+            bool result = false;
+            for (const auto &c : msg_0)
+            {
+                result = gps.process(c);
+            }
+
+            REQUIRE(result);
+            REQUIRE(gps.good());
+            REQUIRE(gps.message_type() == MessageType::GGA);
+            REQUIRE(gps.talker() == Talker::GNSS);
+            REQUIRE(gps.position_data().talker == Talker::GNSS);
+            REQUIRE(gps.position_data().number_satellites == 4);
+
+            for (const auto &c : msg_1)
+            {
+                result = gps.process(c);
+            }
+
+            REQUIRE(result);
+            REQUIRE(gps.good());
+            REQUIRE(gps.message_type() == MessageType::GGA);
+            REQUIRE(gps.talker() == Talker::GLONASS);
+            REQUIRE(gps.position_data().talker == Talker::GLONASS);
+            REQUIRE(gps.position_data().fix_quality == 2);
+            REQUIRE(gps.position_data().number_satellites == 11);
+        }
+
+        SECTION("It should process good RMC messages with data")
+        {
+            const std::string msg(
+                "$GPRMC,153621.000,A,3854.8732,N,09445.3680,W,12.34,054.70,191124,020.3,E,A*2D\r\n");
+
+            MicroGps gps;
+
+            for (std::size_t i = 0; i < msg.size() - 1; ++i)
+            {
+                REQUIRE_FALSE(gps.process(msg.at(i)));
+            }
+
+            REQUIRE(gps.process(msg.back()));
+            REQUIRE(gps.good());
+            REQUIRE(gps.message_type() == MessageType::RMC);
+            REQUIRE(gps.talker() == Talker::GPS);
+
+            const auto &nav = gps.navigation_data();
+
+            REQUIRE(nav.timestamp == 153621);
+            REQUIRE(nav.talker == Talker::GPS);
+            REQUIRE(nav.valid);
+            REQUIRE(nav.latitude == Approx(38.0f + (54.8732f / 60.0f)));
+            REQUIRE(nav.longitude == Approx(-1.0f * (94.0f + (45.3680f / 60.f))));
+            REQUIRE(nav.speed_knots == 1234);
+            REQUIRE(nav.course == 5470);
+            REQUIRE(nav.date == pack_date(2024, 11, 19));
+            REQUIRE(date_year(nav.date) == 2024);
+            REQUIRE(date_month(nav.date) == 11);
+            REQUIRE(date_day(nav.date) == 19);
+        }
+
+        SECTION("It should process good RMC messages without data")
+        {
+            const std::string msg("$GNRMC,152541.096,V,,,,,,,191124,,,N*54\r\n");
+
+            MicroGps gps;
+
+            bool result = false;
+            for (const auto &c : msg)
+            {
+                result = gps.process(c);
+            }
+
+            REQUIRE(result);
+            REQUIRE(gps.good());
+            REQUIRE(gps.message_type() == MessageType::RMC);
+            REQUIRE(gps.talker() == Talker::GNSS);
+
+            const auto &nav = gps.navigation_data();
+
+            REQUIRE(nav.timestamp == 152541);
+            REQUIRE(nav.time_ms == 55541096);
+            REQUIRE_FALSE(nav.valid);
+            REQUIRE(nav.latitude == 0.0f);
+            REQUIRE(nav.longitude == 0.0f);
+            REQUIRE(nav.speed_knots == 0);
+            REQUIRE(nav.course == 0);
+            REQUIRE(nav.date == pack_date(2024, 11, 19));
+        }
+
+        SECTION("It should process RMC messages from before NMEA 2.3")
+        {
+            const std::string msg("$GPRMC,153621.000,A,3854.8732,S,09445.3680,E,0.5,359.99,010100,,*23\r\n");
+
+            MicroGps gps;
+
+            bool result = false;
+            for (const auto &c : msg)
+            {
+                result = gps.process(c);
+            }
+
+            REQUIRE(result);
+            REQUIRE(gps.good());
+
+            const auto &nav = gps.navigation_data();
+
+            REQUIRE(nav.latitude < 0.0f);
+            REQUIRE(nav.longitude > 0.0f);
+            REQUIRE(nav.speed_knots == 50);
+            REQUIRE(nav.course == 35999);
+            REQUIRE(nav.date == pack_date(2000, 1, 1));
+        }
+
+        SECTION("It should process good GSA messages")
+        {
+            const std::string msg("$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,1.3,2.1*39\r\n");
+
+            MicroGps gps;
+
+            for (std::size_t i = 0; i < msg.size() - 1; ++i)
+            {
+                REQUIRE_FALSE(gps.process(msg.at(i)));
+            }
+
+            REQUIRE(gps.process(msg.back()));
+            REQUIRE(gps.good());
+            REQUIRE(gps.message_type() == MessageType::GSA);
+
+            const auto &solution = gps.solution_data();
+
+            REQUIRE(solution.mode == 'A');
+            REQUIRE(solution.fix_type == 3);
+            REQUIRE(solution.pdop == 250);
+            REQUIRE(solution.hdop == 130);
+            REQUIRE(solution.vdop == 210);
+            REQUIRE(active_count(solution) == 5);
+            REQUIRE(is_prn_active(solution, 4));
+            REQUIRE(is_prn_active(solution, 5));
+            REQUIRE(is_prn_active(solution, 9));
+            REQUIRE(is_prn_active(solution, 12));
+            REQUIRE(is_prn_active(solution, 24));
+            REQUIRE_FALSE(is_prn_active(solution, 6));
+            REQUIRE_FALSE(is_prn_active(solution, 0));
+        }
+
+        SECTION("It should merge consecutive GSA messages")
+        {
+            const std::string msg_0("$GNGSA,A,3,04,05,09,12,24,,,,,,,,1.56,0.92,1.26,1*00\r\n");
+            const std::string msg_1("$GNGSA,A,3,65,72,81,,,,,,,,,,1.56,0.92,1.26,2*01\r\n");
+            const std::string gga("$GPGGA,152541.096,,,,,0,00,,,M,,M,,*71\r\n");
+
+            MicroGps gps;
+
+            for (const auto &c : msg_0)
+            {
+                gps.process(c);
+            }
+            for (const auto &c : msg_1)
+            {
+                gps.process(c);
+            }
+
+            REQUIRE(gps.good());
+            REQUIRE(gps.solution_data().hdop == 92);
+            REQUIRE(active_count(gps.solution_data()) == 8);
+            REQUIRE(is_prn_active(gps.solution_data(), 4));
+            REQUIRE(is_prn_active(gps.solution_data(), 81));
+
+            // Another message in between starts a new solution.
+            for (const auto &c : gga)
+            {
+                gps.process(c);
+            }
+            for (const auto &c : msg_1)
+            {
+                gps.process(c);
+            }
+
+            REQUIRE(active_count(gps.solution_data()) == 3);
+            REQUIRE_FALSE(is_prn_active(gps.solution_data(), 4));
+        }
+
+        SECTION("It should start a new solution for each cycle of GSA messages")
+        {
+            const std::string gps_0("$GPGSA,A,3,04,05,09,12,24,,,,,,,,1.56,0.92,1.26*03\r\n");
+            const std::string glonass("$GLGSA,A,3,65,72,81,,,,,,,,,,1.56,0.92,1.26*1D\r\n");
+            const std::string gps_1("$GPGSA,A,3,04,05,,,,,,,,,,,1.56,0.92,1.26*0F\r\n");
+
+            MicroGps gps;
+
+            for (const auto &msg : {gps_0, glonass})
+            {
+                for (const auto &c : msg)
+                {
+                    gps.process(c);
+                }
+            }
+
+            REQUIRE(active_count(gps.solution_data()) == 8);
+
+            // GPS again, with no GGA or RMC in between, is the next epoch.
+            for (const auto &c : gps_1)
+            {
+                gps.process(c);
+            }
+
+            REQUIRE(gps.good());
+            REQUIRE(active_count(gps.solution_data()) == 2);
+            REQUIRE_FALSE(is_prn_active(gps.solution_data(), 65));
+        }
+
+        SECTION("It should learn the cycle of GN GSA messages")
+        {
+            const std::string msg_0("$GNGSA,A,3,04,05,09,12,24,,,,,,,,1.56,0.92,1.26,1*00\r\n");
+            const std::string msg_1("$GNGSA,A,3,65,72,81,,,,,,,,,,1.56,0.92,1.26,2*01\r\n");
+
+            MicroGps gps;
+
+            // The system ID follows the satellites, so the second cycle is merged with the first.
+            for (const auto &msg : {msg_0, msg_1, msg_0, msg_1})
+            {
+                for (const auto &c : msg)
+                {
+                    gps.process(c);
+                }
+            }
+
+            REQUIRE(active_count(gps.solution_data()) == 8);
+
+            // After that each cycle starts a new solution.
+            for (const auto &c : msg_0)
+            {
+                gps.process(c);
+            }
+
+            REQUIRE(gps.good());
+            REQUIRE(active_count(gps.solution_data()) == 5);
+            REQUIRE_FALSE(is_prn_active(gps.solution_data(), 65));
+
+            for (const auto &c : msg_1)
+            {
+                gps.process(c);
+            }
+
+            REQUIRE(active_count(gps.solution_data()) == 8);
+        }
+
+        SECTION("It should process GSA messages without a fix")
+        {
+            const std::string msg("$GPGSA,M,1,,,,,,,,,,,,,,,*12\r\n");
+
+            MicroGps gps;
+
+            bool result = false;
+            for (const auto &c : msg)
+            {
+                result = gps.process(c);
+            }
+
+            REQUIRE(result);
+            REQUIRE(gps.good());
+            REQUIRE(gps.solution_data().mode == 'M');
+            REQUIRE(gps.solution_data().fix_type == 1);
+            REQUIRE(gps.solution_data().pdop == 0);
+            REQUIRE(active_count(gps.solution_data()) == 0);
+        }
+
+        SECTION("It should process PMTK001 acknowledge messages")
+        {
+            const std::string msg("$PMTK001,220,2*31\r\n");
+
+            MicroGps gps;
+
+            bool result = false;
+            for (const auto &c : msg)
+            {
+                result = gps.process(c);
+            }
+
+            REQUIRE(result);
+            REQUIRE(gps.good());
+            REQUIRE(gps.message_type() == MessageType::PmtkAck);
+            REQUIRE(gps.talker() == Talker::Unknown);
+            REQUIRE(gps.ack_data().command == 220);
+            REQUIRE(gps.ack_data().status == AckStatus::Failed);
+        }
+
+        SECTION("It should skip GSV messages without a satellite table")
+        {
+            const std::string msg("$GPGSV,3,3,10,22,42,067,42,24,14,311,43*7E\r\n");
+
+            MicroGps gps;
+            for (const auto &c : msg)
+            {
+                REQUIRE_FALSE(gps.process(c));
+            }
+
+            REQUIRE(gps.message_type() == MessageType::Unknown);
+        }
+
+        SECTION("It should not match address fields with the wrong length")
+        {
+            const std::string msg("$PGGA,153621.000*00\r\n");
+
+            MicroGps gps;
+            for (const auto &c : msg)
+            {
+                REQUIRE_FALSE(gps.process(c));
+            }
+
+            REQUIRE(gps.message_type() == MessageType::Unknown);
+            REQUIRE(gps.talker() == Talker::Unknown);
+        }
+    }
+
+    TEST_CASE("MicroGps::process_until_complete")
+    {
+        const std::string gga("$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*5B\r\n");
+        const std::string rmc("$GPRMC,153621.000,A,3854.8732,N,09445.3680,W,12.34,054.70,191124,020.3,E,A*2D\r\n");
+        const std::string vtg("$GPVTG,054.7,T,034.4,M,005.5,N,010.2,K*48\r\n");
+
+        SECTION("It should return after each sentence and resume at the returned offset")
+        {
+            const std::string stream = "noise" + gga + vtg + rmc + "$GPGG";
+
+            MicroGps gps;
+            size_type offset = 0;
+
+            size_type consumed = gps.process_until_complete(stream.data(), (size_type)stream.size());
+            REQUIRE(consumed == 5 + gga.size());
+            REQUIRE(gps.complete());
+            REQUIRE(gps.good());
+            REQUIRE(gps.message_type() == MessageType::GGA);
+            REQUIRE(gps.position_data().number_satellites == 4);
+            offset += consumed;
+
+            // The unknown VTG sentence is skipped.
+            consumed = gps.process_until_complete(stream.data() + offset, (size_type)stream.size() - offset);
+            REQUIRE(consumed == vtg.size() + rmc.size());
+            REQUIRE(gps.complete());
+            REQUIRE(gps.message_type() == MessageType::RMC);
+            REQUIRE(gps.navigation_data().speed_knots == 1234);
+            offset += consumed;
+
+            // A partial sentence consumes everything without completing.
+            consumed = gps.process_until_complete(stream.data() + offset, (size_type)stream.size() - offset);
+            REQUIRE(consumed == 5);
+            REQUIRE_FALSE(gps.complete());
+        }
+
+        SECTION("It should continue a sentence split across calls")
+        {
+            MicroGps gps;
+
+            REQUIRE(gps.process_until_complete(gga.data(), 20) == 20);
+            REQUIRE_FALSE(gps.complete());
+
+            size_type consumed = gps.process_until_complete(gga.data() + 20, (size_type)gga.size() - 20);
+            REQUIRE(consumed == gga.size() - 20);
+            REQUIRE(gps.complete());
+            REQUIRE(gps.good());
+            REQUIRE(gps.position_data().time_ms == 56181000);
+        }
+
+        SECTION("It should report bad sentences as complete")
+        {
+            const std::string bad("$GPGGA,153621.000,3854.8732,N,09445.3680,W,1,04,2.07,243.9,M,-30.1,M,,*00\r\n");
+
+            MicroGps gps;
+            REQUIRE(gps.process_until_complete(bad.data(), (size_type)bad.size()) == bad.size());
+            REQUIRE(gps.complete());
+            REQUIRE(gps.bad());
+        }
     }
 
     TEST_CASE("_detail::GpsBuffer")
@@ -273,6 +655,28 @@ namespace MicroGps_tests
         }
     }
 
+    TEST_CASE("_detail::parse_talker")
+    {
+        SECTION("it should convert known talkers")
+        {
+            REQUIRE(_detail::parse_talker('G', 'P') == Talker::GPS);
+            REQUIRE(_detail::parse_talker('G', 'L') == Talker::GLONASS);
+            REQUIRE(_detail::parse_talker('G', 'A') == Talker::Galileo);
+            REQUIRE(_detail::parse_talker('G', 'B') == Talker::BeiDou);
+            REQUIRE(_detail::parse_talker('B', 'D') == Talker::BeiDou);
+            REQUIRE(_detail::parse_talker('G', 'Q') == Talker::QZSS);
+            REQUIRE(_detail::parse_talker('G', 'I') == Talker::NavIC);
+            REQUIRE(_detail::parse_talker('G', 'N') == Talker::GNSS);
+        }
+
+        SECTION("it should return unknown bad input")
+        {
+            REQUIRE(_detail::parse_talker('G', 'Z') == Talker::Unknown);
+            REQUIRE(_detail::parse_talker('P', 'M') == Talker::Unknown);
+            REQUIRE(_detail::parse_talker(0, 0) == Talker::Unknown);
+        }
+    }
+
     TEST_CASE("_detail::string_equals")
     {
         SECTION("equal strings")
@@ -336,6 +740,105 @@ namespace MicroGps_tests
         }
     }
 
+    TEST_CASE("_detail::string_to_fixed")
+    {
+        SECTION("It should scale by the requested decimals")
+        {
+            REQUIRE(_detail::string_to_fixed("10", 2) == 1000);
+            REQUIRE(_detail::string_to_fixed("054.70", 2) == 5470);
+            REQUIRE(_detail::string_to_fixed("0.5", 2) == 50);
+            REQUIRE(_detail::string_to_fixed("1.23456", 3) == 1234);
+            REQUIRE(_detail::string_to_fixed("1.9", 0) == 1);
+        }
+
+        SECTION("It should handle signs")
+        {
+            REQUIRE(_detail::string_to_fixed("-30.1", 1) == -301);
+            REQUIRE(_detail::string_to_fixed("+30.1", 1) == 301);
+        }
+
+        SECTION("It should convert stop non numeric")
+        {
+            REQUIRE(_detail::string_to_fixed("12.3ab", 2) == 1230);
+            REQUIRE(_detail::string_to_fixed("abc", 2) == 0);
+        }
+
+        SECTION("It return 0 null input")
+        {
+            REQUIRE(_detail::string_to_fixed(nullptr, 2) == 0);
+        }
+    }
+
+    TEST_CASE("_detail::parse_date")
+    {
+        SECTION("it should parse good input")
+        {
+            const char input[] = "191124";
+            REQUIRE(_detail::parse_date(input, sizeof(input)) == pack_date(2024, 11, 19));
+        }
+
+        SECTION("it should return 0 bad input")
+        {
+            const char empty[] = "";
+            const char junk[] = "19x124";
+            REQUIRE(_detail::parse_date(empty, sizeof(empty)) == 0);
+            REQUIRE(_detail::parse_date(junk, sizeof(junk)) == 0);
+        }
+    }
+
+    TEST_CASE("_detail::parse_time_ms")
+    {
+        SECTION("it should parse whole seconds")
+        {
+            const char input[] = "153621";
+            REQUIRE(_detail::parse_time_ms(input, sizeof(input)) == 56181000);
+        }
+
+        SECTION("it should parse fractional seconds")
+        {
+            const char one[] = "153621.1";
+            const char two[] = "153621.12";
+            const char three[] = "153621.123";
+            const char four[] = "235959.9999";
+            REQUIRE(_detail::parse_time_ms(one, sizeof(one)) == 56181100);
+            REQUIRE(_detail::parse_time_ms(two, sizeof(two)) == 56181120);
+            REQUIRE(_detail::parse_time_ms(three, sizeof(three)) == 56181123);
+            REQUIRE(_detail::parse_time_ms(four, sizeof(four)) == 86399999);
+        }
+
+        SECTION("it should return 0 bad input")
+        {
+            const char empty[] = "";
+            const char junk[] = "15x621.000";
+            REQUIRE(_detail::parse_time_ms(empty, sizeof(empty)) == 0);
+            REQUIRE(_detail::parse_time_ms(junk, sizeof(junk)) == 0);
+        }
+    }
+
+    TEST_CASE("utc_epoch_ms")
+    {
+        SECTION("it should convert dates and times")
+        {
+            REQUIRE(utc_epoch_ms(pack_date(2000, 1, 1), 0) == 946684800000ULL);
+            REQUIRE(utc_epoch_ms(pack_date(2024, 11, 19), 56181100) == 1732030581100ULL);
+            REQUIRE(utc_epoch_ms(pack_date(2127, 12, 31), 86399999) == 4985971199999ULL);
+        }
+
+        SECTION("it should handle leap days")
+        {
+            REQUIRE(utc_epoch_ms(pack_date(2024, 3, 1), 0) - utc_epoch_ms(pack_date(2024, 2, 28), 0) ==
+                    2 * 86400000ULL);
+            REQUIRE(utc_epoch_ms(pack_date(2100, 3, 1), 0) - utc_epoch_ms(pack_date(2100, 2, 28), 0) == 86400000ULL);
+            REQUIRE(utc_epoch_ms(pack_date(2101, 1, 1), 0) - utc_epoch_ms(pack_date(2100, 1, 1), 0) ==
+                    365 * 86400000ULL);
+        }
+
+        SECTION("it should return 0 without a date")
+        {
+            REQUIRE(utc_epoch_ms(0, 56181100) == 0);
+        }
+    }
+
     TEST_CASE("_detail::parse_latitude")
     {
         SECTION("it should parse good input")
@@ -0,0 +1,241 @@
+#include "MicroUbx.h"
+#include "catch.hpp"
+#include <string>
+
+namespace scottz0r
+{
+namespace MicroUbx_tests
+{
+    using namespace scottz0r::gps;
+    using MessageType = MicroUbx::MessageType;
+
+    /// Write a little endian integer into a payload.
+    static void put_le(std::string &payload, std::size_t offset, long long value, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            payload[offset + i] = (char)((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    /// Wrap a payload in a UBX frame with sync characters, header and checksum.
+    static std::string make_frame(unsigned char msg_class, unsigned char msg_id, const std::string &payload)
+    {
+        std::string body;
+        body.push_back((char)msg_class);
+        body.push_back((char)msg_id);
+        body.push_back((char)(payload.size() & 0xFF));
+        body.push_back((char)(payload.size() >> 8));
+        body += payload;
+
+        unsigned ck_a = 0;
+        unsigned ck_b = 0;
+        for (const auto &c : body)
+        {
+            ck_a = (ck_a + (unsigned char)c) & 0xFF;
+            ck_b = (ck_b + ck_a) & 0xFF;
+        }
+
+        std::string frame("\xB5\x62");
+        frame += body;
+        frame.push_back((char)ck_a);
+        frame.push_back((char)ck_b);
+        return frame;
+    }
+
+    /// NAV-PVT for 2024-11-19 15:36:21, 3D fix with 4 satellites unless other validity flags, fix type and fix
+    /// flags are given.
+    static std::string make_nav_pvt(int valid = 0x07, int fix_type = 3, int flags = 0x01)
+    {
+        std::string payload(92, '\0');
+        put_le(payload, 4, 2024, 2);
+        put_le(payload, 6, 11, 1);
+        put_le(payload, 7, 19, 1);
+        put_le(payload, 8, 15, 1);
+        put_le(payload, 9, 36, 1);
+        put_le(payload, 10, 21, 1);
+        put_le(payload, 11, valid, 1);
+        put_le(payload, 16, 250000000, 4);
+        put_le(payload, 20, fix_type, 1);
+        put_le(payload, 21, flags, 1);
+        put_le(payload, 23, 4, 1);
+        put_le(payload, 24, -944561333, 4);
+        put_le(payload, 28, 389145533, 4);
+        put_le(payload, 32, 213800, 4);
+        put_le(payload, 36, 243900, 4);
+        put_le(payload, 60, 6348, 4);
+        put_le(payload, 64, 5470000, 4);
+        return make_frame(0x01, 0x07, payload);
+    }
+
+    /// NAV-DOP with PDOP 2.50, VDOP 2.10 and HDOP 2.07.
+    static std::string make_nav_dop()
+    {
+        std::string payload(18, '\0');
+        put_le(payload, 6, 250, 2);
+        put_le(payload, 10, 210, 2);
+        put_le(payload, 12, 207, 2);
+        return make_frame(0x01, 0x04, payload);
+    }
+
+    TEST_CASE("MicroUbx")
+    {
+        SECTION("It should process good NAV-PVT messages")
+        {
+            const std::string msg = make_nav_pvt();
+            REQUIRE(msg.size() == 100);
+
+            MicroUbx ubx;
+
+            for (std::size_t i = 0; i < msg.size() - 1; ++i)
+            {
+                REQUIRE_FALSE(ubx.process(msg.at(i)));
+            }
+
+            REQUIRE(ubx.process(msg.back()));
+            REQUIRE(ubx.good());
+            REQUIRE(ubx.message_type() == MessageType::NavPvt);
+
+            const auto &posn = ubx.position_data();
+
+            REQUIRE(posn.timestamp == 153621);
+            REQUIRE(posn.time_ms == 56181250);
+            REQUIRE(posn.talker == Talker::GNSS);
+            REQUIRE(posn.fix_quality == 1);
+            REQUIRE(posn.number_satellites == 4);
+            REQUIRE(posn.latitude == Approx(38.9145533f));
+            REQUIRE(posn.longitude == Approx(-94.4561333f));
+            REQUIRE(posn.altitude_msl == Approx(243.9f));
+            REQUIRE(posn.geoid_height == Approx(-30.1f));
+            REQUIRE(has_field(posn, PositionField::Time));
+            REQUIRE(has_field(posn, PositionField::Latitude));
+            REQUIRE(has_field(posn, PositionField::Altitude));
+            REQUIRE_FALSE(has_field(posn, PositionField::Dilution));
+
+            const auto &nav = ubx.navigation_data();
+
+            REQUIRE(nav.valid);
+            REQUIRE(nav.date == pack_date(2024, 11, 19));
+            REQUIRE(nav.speed_knots == 1234);
+            REQUIRE(nav.course == 5470);
+
+            REQUIRE(ubx.solution_data().fix_type == 3);
+        }
+
+        SECTION("It should leave out the coordinates of NAV-PVT messages without a fix")
+        {
+            for (const std::string &msg : {make_nav_pvt(0x07, 0, 0x00), make_nav_pvt(0x07, 3, 0x00)})
+            {
+                MicroUbx ubx;
+                ubx.process_until_complete(msg.data(), msg.size());
+                REQUIRE(ubx.good());
+
+                const auto &posn = ubx.position_data();
+
+                REQUIRE(posn.fix_quality == 0);
+                REQUIRE(has_field(posn, PositionField::Time));
+                REQUIRE(has_field(posn, PositionField::FixQuality));
+                REQUIRE_FALSE(has_field(posn, PositionField::Latitude));
+                REQUIRE_FALSE(has_field(posn, PositionField::Longitude));
+                REQUIRE_FALSE(has_field(posn, PositionField::Altitude));
+                REQUIRE_FALSE(has_field(posn, PositionField::GeoidHeight));
+                REQUIRE_FALSE(ubx.navigation_data().valid);
+            }
+        }
+
+        SECTION("It should leave out the time of NAV-PVT messages without a valid time")
+        {
+            const std::string msg = make_nav_pvt(0x01);
+
+            MicroUbx ubx;
+            ubx.process_until_complete(msg.data(), msg.size());
+            REQUIRE(ubx.good());
+
+            REQUIRE_FALSE(has_field(ubx.position_data(), PositionField::Time));
+            REQUIRE(has_field(ubx.position_data(), PositionField::Latitude));
+            REQUIRE(ubx.navigation_data().date == pack_date(2024, 11, 19));
+        }
+
+        SECTION("It should process good NAV-DOP messages")
+        {
+            const std::string msg = make_nav_dop() + make_nav_pvt();
+
+            MicroUbx ubx;
+            size_type offset = ubx.process_until_complete(msg.data(), (size_type)msg.size());
+
+            REQUIRE(offset == 26);
+            REQUIRE(ubx.good());
+            REQUIRE(ubx.message_type() == MessageType::NavDop);
+            REQUIRE(ubx.solution_data().pdop == 250);
+            REQUIRE(ubx.solution_data().vdop == 210);
+            REQUIRE(ubx.solution_data().hdop == 207);
+            REQUIRE(ubx.position_data().horizontal_dilution == Approx(2.07f));
+
+            // Dilution should survive the next position.
+            offset += ubx.process_until_complete(msg.data() + offset, (size_type)msg.size() - offset);
+            REQUIRE(offset == msg.size());
+            REQUIRE(ubx.message_type() == MessageType::NavPvt);
+            REQUIRE(ubx.position_data().horizontal_dilution == Approx(2.07f));
+        }
+
+        SECTION("It should fail messages with a bad checksum")
+        {
+            std::string msg = make_nav_pvt();
+            msg.back() = (char)(msg.back() + 1);
+
+            MicroUbx ubx;
+            REQUIRE(ubx.process_until_complete(msg.data(), (size_type)msg.size()) == msg.size());
+            REQUIRE(ubx.bad());
+            REQUIRE(ubx.position_data().number_satellites == 0);
+        }
+
+        SECTION("It should fail supported messages with the wrong length")
+        {
+            const std::string msg = make_frame(0x01, 0x07, std::string(10, '\0'));
+
+            MicroUbx ubx;
+            bool result = false;
+            for (const auto &c : msg)
+            {
+                result = ubx.process(c);
+            }
+
+            REQUIRE(result);
+            REQUIRE(ubx.bad());
+        }
+
+        SECTION("It should skip unsupported messages and junk")
+        {
+            const std::string msg = std::string("\xB5\xB5junk\x62") + make_frame(0x0A, 0x04, std::string(40, 'x')) +
+                                    "\xB5" + make_nav_pvt();
+
+            MicroUbx ubx;
+            size_type offset = ubx.process_until_complete(msg.data(), (size_type)msg.size());
+
+            REQUIRE(offset == msg.size());
+            REQUIRE(ubx.good());
+            REQUIRE(ubx.message_type() == MessageType::NavPvt);
+        }
+
+        SECTION("It should return the input size when no message completes")
+        {
+            const std::string msg = make_nav_pvt();
+
+            MicroUbx ubx;
+            REQUIRE(ubx.process_until_complete(msg.data(), 50) == 50);
+            REQUIRE(ubx.process_until_complete(msg.data() + 50, (size_type)msg.size() - 50) == msg.size() - 50);
+            REQUIRE(ubx.good());
+        }
+    }
+
+    TEST_CASE("_detail::read_le")
+    {
+        const char bytes[] = {'\x01', '\x02', '\x03', '\xFF'};
+
+        REQUIRE(_detail::read_u16_le(bytes) == 0x0201);
+        REQUIRE(_detail::read_u32_le(bytes) == 0xFF030201u);
+        REQUIRE(_detail::read_i32_le(bytes) == -16580095);
+    }
+
+} // namespace MicroUbx_tests
+} // namespace scottz0r